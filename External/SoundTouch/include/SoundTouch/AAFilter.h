@@ -54,7 +54,14 @@ protected:
     /// num of filter taps
     uint length;
 
-    /// Calculate the FIR coefficients realizing the given cutoff-frequency
+    /// num of filter taps whose delay the filter keeps, see 'setDelayLength'
+    uint delayLength;
+
+    /// Returns the num of input samples skipped on both sides of the filter window
+    /// to keep the delay of 'delayLength' taps
+    uint getPadding() const;
+
+    /// Take the FIR coefficients realizing the given cutoff-frequency into use
     void calculateCoeffs();
 public:
     AAFilter(uint length);
@@ -71,9 +78,31 @@ public:
 
     uint getLength() const;
 
+    /// Keeps the delay of a filter of 'newDelayLength' taps when the filter is shorter
+    /// than that, by applying the filter to the middle of the longer window. Then
+    /// changing the filter length on the fly doesn't shift the output in time.
+    /// 0 = off, the delay follows the filter length.
+    void setDelayLength(uint newDelayLength);
+
+    uint getDelayLength() const;
+
+    /// Returns the delay of the filter output in samples
+    uint getDelay() const;
+
+    /// Returns the number of input samples needed for outputting 'numOutput'
+    /// samples with the given number of channels
+    uint getInputLength(uint numOutput, uint numChannels) const;
+
+    /// Returns the FIR coefficients realizing given cutoff-frequency and number of
+    /// taps from a process-wide filter cache, designing the filter only if not yet
+    /// cached. The returned coefficient set is immutable and stays valid until
+    /// program exit. Call this in advance with the cutoffs in use, to avoid
+    /// designing filters later in 'setCutoffFreq'.
+    static const class FIRCoefficients *getCoefficients(double cutoffFreq, uint length);
+
     /// Applies the filter to the given sequence of samples.
-    /// Note : The amount of outputted samples is by value of 'filter length'
-    /// smaller than the amount of input samples.
+    /// Note : The amount of outputted samples is by value of 'filter length', or
+    /// of 'delay length' if that is longer, smaller than the amount of input samples.
     uint evaluate(SAMPLETYPE *dest,
                   const SAMPLETYPE *src,
                   uint numSamples,
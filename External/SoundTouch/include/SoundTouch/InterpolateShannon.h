@@ -43,6 +43,9 @@
 namespace soundtouch
 {
 
+/// Kaiser-windowed sinc interpolation transposer. The 8 windowed sinc taps
+/// are read from a precomputed polyphase table that is indexed by a fixed-point
+/// read position, instead of evaluating the sinc function for each sample.
 class InterpolateShannon : public TransposerBase
 {
 protected:
@@ -56,19 +59,51 @@ protected:
                         const SAMPLETYPE *src,
                         int &srcSamples) override;
 
-    double fract;
+    /// Fractional read position and rate step in FRACT_BITS fixed-point format
+    uint iFract;
+    uint iRate;
+
+    /// Polyphase table of (PHASES + 1) rows with 8 taps each. The table is
+    /// shared by all instances and aligned to 16-byte boundary.
+    const float *coeffTable;
+
+    static const float *getCoeffTable();
 
 public:
     InterpolateShannon();
 
+    void setRate(double newRate) override;
+
     void resetRegisters() override;
 
     virtual int getLatency() const override
     {
         return 3;
     }
+
+    virtual int getHistoryLength() const override
+    {
+        return 8;
+    }
 };
 
+
+#ifdef SOUNDTOUCH_ALLOW_SSE
+    /// Class that implements SSE optimized Shannon interpolation. Evaluates four
+    /// output samples per loop round.
+    class InterpolateShannonSSE : public InterpolateShannon
+    {
+    protected:
+        int transposeMono(SAMPLETYPE *dest,
+                            const SAMPLETYPE *src,
+                            int &srcSamples) override;
+        int transposeStereo(SAMPLETYPE *dest,
+                            const SAMPLETYPE *src,
+                            int &srcSamples) override;
+    };
+
+#endif /// SOUNDTOUCH_ALLOW_SSE
+
 }
 
 #endif
@@ -39,6 +39,7 @@
 #define RateTransposer_H
 
 #include <stddef.h>
+#include <assert.h>
 #include "AAFilter.h"
 #include "FIFOSamplePipe.h"
 #include "FIFOSampleBuffer.h"
@@ -55,9 +56,34 @@ public:
         enum ALGORITHM {
         LINEAR = 0,
         CUBIC,
-        SHANNON
+        SHANNON,
+        POLYPHASE
     };
 
+    /// Fixed-point format of the fractional read position used by the table-driven
+    /// interpolators: FRACT_BITS fraction bits, of which the topmost PHASE_BITS select
+    /// the row of the precomputed polyphase coefficient table.
+    enum {
+        FRACT_BITS = 24,
+        PHASE_BITS = 10,
+        FRACT_MASK = (1 << FRACT_BITS) - 1,
+        PHASES = 1 << PHASE_BITS
+    };
+
+    /// Converts a fixed-point fraction to the nearest coefficient table row,
+    /// returning a value in range [0 .. PHASES]
+    static inline uint phaseIndex(uint fract)
+    {
+        return (fract + (1 << (FRACT_BITS - PHASE_BITS - 1))) >> (FRACT_BITS - PHASE_BITS);
+    }
+
+    /// Converts a floating-point rate to the fixed-point step of FRACT_BITS format
+    static inline uint fixedRate(double rate)
+    {
+        assert(rate > 0 && rate < 128.0);
+        return (uint)(rate * (double)(1 << FRACT_BITS) + 0.5);
+    }
+
 protected:
     virtual int transposeMono(SAMPLETYPE *dest,
                         const SAMPLETYPE *src,
@@ -69,6 +95,7 @@ protected:
                         const SAMPLETYPE *src,
                         int &srcSamples) = 0;
 
+    /// Default algorithm of new RateTransposer instances
     static ALGORITHM algorithm;
 
 public:
@@ -83,13 +110,36 @@ public:
     virtual void setChannels(int channels);
     virtual int getLatency() const = 0;
 
+    /// Returns the number of source samples that the interpolator keeps as history,
+    /// i.e. how many source samples it needs past the current read position before
+    /// it can produce an output sample
+    virtual int getHistoryLength() const = 0;
+
+    /// Returns the whole source sample position from which output sample 'n' gets
+    /// interpolated after 'resetRegisters', following the read position arithmetic
+    /// of the interpolator. The default follows the FRACT_BITS fixed-point format.
+    virtual int getSourcePosition(int n) const;
+
+    /// Returns true if the transposer band-limits the signal by itself, so that
+    /// no separate anti-alias filter is needed
+    virtual bool includesAAFilter() const
+    {
+        return false;
+    }
+
     virtual void resetRegisters() = 0;
 
-    // static factory function
+    // static factory functions, for the default or the given algorithm
     static TransposerBase *newInstance();
+    static TransposerBase *newInstance(ALGORITHM a);
 
-    // static function to set interpolation algorithm
+    // static function to set the default interpolation algorithm of new
+    // RateTransposer instances. Use RateTransposer::setAlgorithm to change
+    // the algorithm of an existing instance.
     static void setAlgorithm(ALGORITHM a);
+
+    // static function to get the default interpolation algorithm
+    static ALGORITHM getAlgorithm();
 };
 
 
@@ -102,6 +152,11 @@ protected:
     AAFilter *pAAFilter;
     TransposerBase *pTransposer;
 
+    /// Interpolation algorithm of this instance, and the transposers of the
+    /// algorithms used so far, so that switching back doesn't allocate
+    TransposerBase::ALGORITHM algorithm;
+    TransposerBase *pTransposers[TransposerBase::POLYPHASE + 1];
+
     /// Buffer for collecting samples to feed the anti-alias filter between
     /// two batches
     FIFOSampleBuffer inputBuffer;
@@ -112,6 +167,10 @@ protected:
     /// Output sample buffer
     FIFOSampleBuffer outputBuffer;
 
+    /// Buffer where the processed samples get written: 'outputBuffer', or in a
+    /// fused pipeline the input buffer of the next processing stage
+    FIFOSampleBuffer *pOutputTarget;
+
     bool bUseAAFilter;
 
 
@@ -129,6 +188,19 @@ public:
     /// Returns the output buffer object
     FIFOSamplePipe *getOutput() { return &outputBuffer; };
 
+    /// Returns the input buffer, for a previous stage that writes its output
+    /// directly into it
+    FIFOSampleBuffer *getInputBuffer() { return &inputBuffer; };
+
+    /// Makes the processed samples get written directly into the given buffer,
+    /// e.g. the input buffer of the next processing stage, instead of this
+    /// object's own output buffer. nullptr restores the own output buffer.
+    void setOutputTarget(FIFOSampleBuffer *target);
+
+    /// Processes the samples that a previous stage has written directly into
+    /// the input buffer
+    void processInput();
+
     /// Return anti-alias filter object
     AAFilter *getAAFilter();
 
@@ -142,6 +214,20 @@ public:
     /// rate, larger faster rates.
     virtual void setRate(double newRate);
 
+    /// Designs the anti-alias filter for the given rate in advance into the
+    /// process-wide filter cache, for the current algorithm and filter length,
+    /// so that a later 'setRate' call with the same rate doesn't need to
+    /// calculate filter coefficients.
+    void prepareRate(double newRate) const;
+
+    /// Changes the interpolation algorithm of this instance without clearing
+    /// the buffered samples. The first switch to an algorithm allocates its
+    /// transposer, later switches don't.
+    void setAlgorithm(TransposerBase::ALGORITHM a);
+
+    /// Returns the interpolation algorithm of this instance
+    TransposerBase::ALGORITHM getAlgorithm() const;
+
     /// Sets the number of channels, 1 = mono, 2 = stereo
     void setChannels(int channels);
 
@@ -157,6 +243,11 @@ public:
 
     /// Return approximate initial input-output latency
     int getLatency() const;
+
+    /// Returns the exact number of input samples that have to be entered after
+    /// 'clear' before 'numOutput' samples are available in the output, accounting
+    /// for the anti-alias filter length, the interpolator history and the rate.
+    int getInputLatency(int numOutput) const;
 };
 
 }
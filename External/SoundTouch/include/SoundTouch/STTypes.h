@@ -79,6 +79,13 @@ namespace soundtouch
         #define SOUNDTOUCH_INTEGER_SAMPLES      1
     #endif
 
+    #ifdef SOUNDTOUCH_INT16_VARIANT
+        // Compiling the 16bit integer variant of the library that is linked
+        // alongside the float build, see SoundTouchInt16.cpp
+        #undef  SOUNDTOUCH_FLOAT_SAMPLES
+        #define SOUNDTOUCH_INTEGER_SAMPLES      1
+    #endif
+
     #if !(SOUNDTOUCH_INTEGER_SAMPLES || SOUNDTOUCH_FLOAT_SAMPLES)
 
         /// Choose either 32bit floating point or 16bit integer sampletype
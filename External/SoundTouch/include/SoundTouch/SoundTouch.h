@@ -88,7 +88,10 @@ namespace soundtouch
 
 /// Enable/disable quick seeking algorithm in tempo changer routine
 /// (enabling quick seeking lowers CPU utilization but causes a minor sound
-///  quality compromising)
+///  quality compromising). Value 2 selects the hierarchical seek that first
+/// scans decimated signals, which costs less than the quick seek and matches
+/// nearly as well as the full seek. Value 3 selects the pitch guided seek for speech,
+/// that for voiced sound tests only positions aligned to the tracked pitch period.
 #define SETTING_USE_QUICKSEEK       2
 
 /// Time-stretch algorithm single processing sequence length in milliseconds. This determines
@@ -164,6 +167,54 @@ namespace soundtouch
 ///   tempo/pitch/rate/samplerate settings.
 #define SETTING_INITIAL_LATENCY             8
 
+/// Enable/disable speech processing profile in tempo changer routine (0 = disable,
+/// default). The speech profile derives the sequence, seek window and overlap lengths
+/// from the voice's fundamental frequency range and from the latency budget, see the
+/// settings below, instead of the tempo dependent automatic values tuned for music.
+#define SETTING_SPEECH_PROFILE              9
+
+/// Lowest fundamental frequency of the voice in Hz for the speech profile (default = 75)
+#define SETTING_SPEECH_MIN_F0               10
+
+/// Highest fundamental frequency of the voice in Hz for the speech profile (default = 400)
+#define SETTING_SPEECH_MAX_F0               11
+
+/// Target latency of the tempo changer routine in milliseconds for the speech profile
+/// (default = 40). The profile exceeds this if the budget can't hold two pitch periods
+/// of the lowest fundamental frequency.
+#define SETTING_SPEECH_LATENCY_MS           12
+
+/// Interpolation algorithm of the rate transposer of this instance: 0 = linear,
+/// 1 = cubic (default), 2 = shannon, 3 = polyphase. Changing the algorithm keeps
+/// the buffered samples, but the first change to each algorithm allocates memory.
+/// Builds with integer samples always use linear interpolation.
+#define SETTING_TRANSPOSER_ALGORITHM        13
+
+/// Enable/disable fused processing pipeline (0 = disable, default). When enabled, the
+/// first of the tempo changer and the rate transposer writes its output directly into
+/// the input buffer of the other, instead of copying it over between the stages. The
+/// processed samples are the same in both modes.
+#define SETTING_FUSED_PIPELINE              14
+
+/// Crossfade shape of the overlapping sequences in the tempo changer: 0 = linear
+/// (default), 1 = raised-cosine, which may sound smoother for speech. Both cost the
+/// same, the crossfade weights are precalculated.
+#define SETTING_OVERLAP_WINDOW              15
+
+/// Enable/disable parallel full seek in the tempo changer (0 = disable, default). When
+/// enabled, the full seek (see SETTING_USE_QUICKSEEK) of large seek windows is split over
+/// the threads of a process-wide worker pool. Meant for offline processing only: a seek
+/// takes a mutex and spin-waits for the pool threads, which may not meet real-time
+/// deadlines, so don't enable it on a real-time audio thread. Builds with integer
+/// samples always seek sequentially.
+#define SETTING_PARALLEL_SEEK               16
+
+/// Pitch transposer anti-alias filter length whose delay is kept when the filter is
+/// shorter (0 = disable, default). The shorter filter is applied to the middle of the
+/// window of this length, so with this set to the longest length in use, changing
+/// SETTING_AA_FILTER_LENGTH during processing doesn't shift the output in time.
+#define SETTING_AA_FILTER_DELAY_LENGTH      17
+
 
 class SoundTouch : public FIFOProcessor
 {
@@ -186,6 +237,9 @@ private:
     /// Flag: Has sample rate been set?
     bool  bSrateSet;
 
+    /// Flag: Do the processing stages share their buffers? See SETTING_FUSED_PIPELINE.
+    bool  bFusedPipeline;
+
     /// Accumulator for how many samples in total will be expected as output vs. samples put in,
     /// considering current processing settings.
     double samplesExpectedOut;
@@ -197,6 +251,16 @@ private:
     /// 'virtualPitch' parameters.
     void calcEffectiveRateAndTempo();
 
+    /// Connects the output of the first processing stage directly to the input of
+    /// the second one in the fused pipeline mode, or disconnects them.
+    void updateStageTargets();
+
+    /// Returns the input buffer of the first processing stage
+    class FIFOSampleBuffer *getInputBuffer();
+
+    /// Processes 'nSamples' new samples in the input buffer of the first stage
+    void processInput(uint nSamples);
+
 protected :
     /// Number of channels
     uint  channels;
@@ -246,6 +310,13 @@ public:
     void setPitchSemiTones(int newPitch);
     void setPitchSemiTones(double newPitch);
 
+    /// Precalculates the anti-alias filter for the given pitch change in semi-tones
+    /// into a process-wide filter cache that is shared by all SoundTouch instances,
+    /// for the current transposer algorithm and anti-alias filter length. Call this
+    /// outside the audio thread for each pitch setting that's going to be used, so
+    /// that changing the pitch during processing doesn't design filters.
+    void preparePitchSemiTones(double newPitch) const;
+
     /// Sets the number of channels, 1 = mono, 2 = stereo
     void setChannels(uint numChannels);
 
@@ -270,6 +341,20 @@ public:
     /// output duration  be 0.869565 * 1000000 = 869565 samples.
     double getInputOutputSampleRatio();
 
+    /// Returns the exact number of input samples that have to be entered after
+    /// 'clear' before the first processed sample becomes available, given the
+    /// current tempo/pitch/rate/samplerate settings. Unlike SETTING_INITIAL_LATENCY,
+    /// this accounts for the tempo changer sequence & seek windows, the anti-alias
+    /// filter length and the interpolator history in their actual processing order.
+    int getInputLatency() const;
+
+    /// Returns the real-time latency in output samples, i.e. how many samples a
+    /// caller that receives the output at the same pace as it enters the input has
+    /// to play out before the first processed sample. When the output is delayed by
+    /// this amount from the beginning of the stream, the output doesn't run dry
+    /// during streaming with unchanged settings.
+    int getOutputLatency() const;
+
     /// Flushes the last samples from the processing pipeline to the output.
     /// Clears also the internal processing buffers.
     //
@@ -289,6 +374,19 @@ public:
                                                     ///< contains data for both channels.
             ) override;
 
+    /// Returns a pointer for writing up to 'slackCapacity' samples directly into the
+    /// input of the processing pipeline, e.g. when the caller converts or generates
+    /// the samples anyway. Call 'putSamples(numSamples)' after writing them.
+    SAMPLETYPE *ptrEnd(uint slackCapacity);
+
+    /// Processes 'numSamples' samples that were written to the address returned by
+    /// 'ptrEnd'. Like the pointer variant, requires the sample rate to be set.
+    void putSamples(uint numSamples);
+
+    /// Returns a pointer to the beginning of the ready output samples, for reading
+    /// them in place. Remove the read samples with 'receiveSamples(maxSamples)'.
+    virtual SAMPLETYPE *ptrBegin() override;
+
     /// Output samples from beginning of the sample buffer. Copies requested samples to
     /// output buffer and removes them from the sample buffer. If there are less than
     /// 'numsample' samples in the buffer, returns all that available.
@@ -0,0 +1,109 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+/// Sample format independent interface to the SoundTouch processor. The library
+/// is built both with 32bit float and with 16bit integer samples, so that both
+/// variants link into the same binary, and the application can choose the
+/// faster one for the device at runtime.
+///
+/// The 16bit integer variant is compiled from the same sources into namespace
+/// 'soundtouch_int16', see SoundTouchInt16.cpp.
+///
+/// Author        : Copyright (c) Olli Parviainen
+/// Author e-mail : oparviai 'at' iki.fi
+/// SoundTouch WWW: http://www.surina.net/soundtouch
+///
+////////////////////////////////////////////////////////////////////////////////
+//
+// License :
+//
+//  SoundTouch audio processing library
+//  Copyright (c) Olli Parviainen
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Lesser General Public
+//  License as published by the Free Software Foundation; either
+//  version 2.1 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this library; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef SoundTouchEngine_H
+#define SoundTouchEngine_H
+
+// Notice: This header must not include "STTypes.h" or other library headers, as
+// the sample type of those gets fixed by the first inclusion in a source file.
+
+namespace soundtouch
+{
+
+/// SoundTouch processor of either sample format. Accepts and returns samples in
+/// both formats; samples in the engine's own format pass through without
+/// conversion.
+class SoundTouchEngine
+{
+public:
+    /// Sample format that the engine processes internally
+    enum SAMPLEFORMAT
+    {
+        FLOAT_SAMPLES = 0,
+        INT16_SAMPLES
+    };
+
+    virtual ~SoundTouchEngine() {}
+
+    /// Creates a new engine instance that processes samples in given format.
+    static SoundTouchEngine *newInstance(SAMPLEFORMAT format);
+
+    /// Measures with a short test run which of the sample formats processes pitch
+    /// shifting faster on this device, using float sample input & output. Takes
+    /// some tens of milliseconds, so call this once at startup outside the audio
+    /// thread.
+    static SAMPLEFORMAT selectFastestFormat(unsigned int sampleRate, unsigned int numChannels);
+
+    /// Returns the sample format that the engine processes internally. In builds
+    /// where the float variant is replaced by integer samples (e.g. soft-float
+    /// Android) both formats process integer samples.
+    virtual SAMPLEFORMAT getSampleFormat() const = 0;
+
+    /// See the corresponding SoundTouch functions.
+    virtual void setRate(double newRate) = 0;
+    virtual void setTempo(double newTempo) = 0;
+    virtual void setPitchSemiTones(double newPitch) = 0;
+    virtual void preparePitchSemiTones(double newPitch) = 0;
+    virtual void setChannels(unsigned int numChannels) = 0;
+    virtual void setSampleRate(unsigned int srate) = 0;
+    virtual bool setSetting(int settingId, int value) = 0;
+    virtual int getSetting(int settingId) const = 0;
+    virtual int getInputLatency() const = 0;
+    virtual int getOutputLatency() const = 0;
+
+    /// Adds samples into the input of the engine. Samples in the other format
+    /// than the engine's own are converted on the fly, with 16bit integer range
+    /// corresponding to float range -1.0 .. +1.0.
+    virtual void putSamples(const float *samples, unsigned int numSamples) = 0;
+    virtual void putSamples(const short *samples, unsigned int numSamples) = 0;
+
+    /// Outputs processed samples, converting them to the requested format if
+    /// necessary. Returns number of samples returned.
+    virtual unsigned int receiveSamples(float *output, unsigned int maxSamples) = 0;
+    virtual unsigned int receiveSamples(short *output, unsigned int maxSamples) = 0;
+
+    /// Returns number of samples available for receiving
+    virtual unsigned int numSamples() const = 0;
+
+    virtual void flush() = 0;
+    virtual void clear() = 0;
+};
+
+}
+
+#endif  // SoundTouchEngine_H
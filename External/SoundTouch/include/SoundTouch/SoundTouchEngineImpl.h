@@ -0,0 +1,155 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+/// SoundTouchEngine implementation template that gets instantiated for both the
+/// float and the 16bit integer sample variant of the SoundTouch processor.
+///
+///
+/// Author        : Copyright (c) Olli Parviainen
+/// Author e-mail : oparviai 'at' iki.fi
+/// SoundTouch WWW: http://www.surina.net/soundtouch
+///
+////////////////////////////////////////////////////////////////////////////////
+//
+// License :
+//
+//  SoundTouch audio processing library
+//  Copyright (c) Olli Parviainen
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Lesser General Public
+//  License as published by the Free Software Foundation; either
+//  version 2.1 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this library; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+#ifndef SoundTouchEngineImpl_H
+#define SoundTouchEngineImpl_H
+
+#include <assert.h>
+#include <math.h>
+#include "SoundTouchEngine.h"
+
+namespace soundtouch
+{
+
+/// Creates a new engine of the 16bit integer sample variant, see SoundTouchInt16.cpp
+SoundTouchEngine *newInt16Engine();
+
+
+/// SoundTouchEngine implementation for processor class 'PROCESSOR' that processes
+/// samples of type 'SAMPLE'. Samples of the engine's own type are passed directly
+/// to the processor, while samples of the other type get converted directly into
+/// the processor's input buffer, in slices so that the buffer doesn't grow past
+/// its usual size, and directly out of its output buffer.
+template <class PROCESSOR, typename SAMPLE>
+class SoundTouchEngineImpl : public SoundTouchEngine
+{
+private:
+    enum { CONVERT_SLICE_SIZE = 4096 };
+
+    PROCESSOR processor;
+
+    static void convert(short *dest, const float *src, unsigned int count)
+    {
+        for (unsigned int i = 0; i < count; i ++)
+        {
+            float value = src[i] * 32768.0f;
+            // saturate to 16 bit integer limits
+            value = (value < -32768.0f) ? -32768.0f : (value > 32767.0f) ? 32767.0f : value;
+            dest[i] = (short)lrintf(value);
+        }
+    }
+
+    static void convert(float *dest, const short *src, unsigned int count)
+    {
+        for (unsigned int i = 0; i < count; i ++)
+        {
+            dest[i] = (float)src[i] * (1.0f / 32768.0f);
+        }
+    }
+
+    /// Number of multichannel samples converted into the input buffer at a time
+    unsigned int sliceSamples() const
+    {
+        assert(processor.numChannels() > 0);
+        return CONVERT_SLICE_SIZE / processor.numChannels();
+    }
+
+    void put(const SAMPLE *samples, unsigned int numSamples)
+    {
+        processor.putSamples(samples, numSamples);
+    }
+
+    template <typename OTHER>
+    void put(const OTHER *samples, unsigned int numSamples)
+    {
+        const unsigned int slice = sliceSamples();
+
+        while (numSamples > 0)
+        {
+            const unsigned int count = (numSamples < slice) ? numSamples : slice;
+
+            convert(processor.ptrEnd(count), samples, count * processor.numChannels());
+            processor.putSamples(count);
+            samples += count * processor.numChannels();
+            numSamples -= count;
+        }
+    }
+
+    unsigned int receive(SAMPLE *output, unsigned int maxSamples)
+    {
+        return processor.receiveSamples(output, maxSamples);
+    }
+
+    template <typename OTHER>
+    unsigned int receive(OTHER *output, unsigned int maxSamples)
+    {
+        const unsigned int available = processor.numSamples();
+        const unsigned int count = (maxSamples < available) ? maxSamples : available;
+
+        convert(output, processor.ptrBegin(), count * processor.numChannels());
+        return processor.receiveSamples(count);
+    }
+
+public:
+    SAMPLEFORMAT getSampleFormat() const override
+    {
+        return (sizeof(SAMPLE) == sizeof(short)) ? INT16_SAMPLES : FLOAT_SAMPLES;
+    }
+
+    void setRate(double newRate) override { processor.setRate(newRate); }
+    void setTempo(double newTempo) override { processor.setTempo(newTempo); }
+    void setPitchSemiTones(double newPitch) override { processor.setPitchSemiTones(newPitch); }
+    void preparePitchSemiTones(double newPitch) override { processor.preparePitchSemiTones(newPitch); }
+    void setChannels(unsigned int numChannels) override { processor.setChannels(numChannels); }
+    void setSampleRate(unsigned int srate) override { processor.setSampleRate(srate); }
+    bool setSetting(int settingId, int value) override { return processor.setSetting(settingId, value); }
+    int getSetting(int settingId) const override { return processor.getSetting(settingId); }
+    int getInputLatency() const override { return processor.getInputLatency(); }
+    int getOutputLatency() const override { return processor.getOutputLatency(); }
+
+    void putSamples(const float *samples, unsigned int numSamples) override { put(samples, numSamples); }
+    void putSamples(const short *samples, unsigned int numSamples) override { put(samples, numSamples); }
+
+    unsigned int receiveSamples(float *output, unsigned int maxSamples) override { return receive(output, maxSamples); }
+    unsigned int receiveSamples(short *output, unsigned int maxSamples) override { return receive(output, maxSamples); }
+
+    unsigned int numSamples() const override { return processor.numSamples(); }
+
+    void flush() override { processor.flush(); }
+    void clear() override { processor.clear(); }
+};
+
+}
+
+#endif  // SoundTouchEngineImpl_H
@@ -2,7 +2,7 @@ LOCAL_PATH := $(call my-dir)
 
 include $(CLEAR_VARS)
 
-LOCAL_C_INCLUDES += $(LOCAL_PATH)/../../../include $(LOCAL_PATH)/../../SoundStretch
+LOCAL_C_INCLUDES += $(LOCAL_PATH)/../../../include/SoundTouch $(LOCAL_PATH)/../../SoundStretch
 # *** Remember: Change -O0 into -O2 in add-applications.mk ***
 
 LOCAL_MODULE    := soundtouch
@@ -12,7 +12,10 @@ LOCAL_SRC_FILES := soundtouch-jni.cpp ../../SoundTouch/AAFilter.cpp  ../../Sound
                 ../../SoundTouch/RateTransposer.cpp ../../SoundTouch/SoundTouch.cpp \
                 ../../SoundTouch/InterpolateCubic.cpp ../../SoundTouch/InterpolateLinear.cpp \
                 ../../SoundTouch/InterpolateShannon.cpp ../../SoundTouch/TDStretch.cpp \
-                ../../SoundTouch/BPMDetect.cpp ../../SoundTouch/PeakFinder.cpp 
+                ../../SoundTouch/InterpolatePolyphase.cpp \
+                ../../SoundTouch/SoundTouchEngine.cpp ../../SoundTouch/SoundTouchInt16.cpp \
+                ../../SoundTouch/BPMDetect.cpp ../../SoundTouch/PeakFinder.cpp \
+                ../../SoundTouch/WorkerPool.cpp
 
 # for native audio
 LOCAL_SHARED_LIBRARIES += -lgcc 
@@ -27,6 +30,8 @@ LOCAL_LDLIBS    += -llog
 LOCAL_CFLAGS += -fvisibility=hidden -fdata-sections -ffunction-sections -ffast-math
 
 # OpenMP mode : enable these flags to enable using OpenMP for parallel computation 
+# in file processing. Keep disabled when using SoundTouchStream in real-time audio
+# callbacks, as OpenMP threads don't meet the callback deadlines.
 #LOCAL_CFLAGS += -fopenmp
 #LOCAL_LDFLAGS += -fopenmp
 
@@ -9,16 +9,24 @@
 ////////////////////////////////////////////////////////////////////////////////
 
 #include <jni.h>
-#include <android/log.h>
 #include <stdexcept>
 #include <string>
+#include <string.h>
 
 using namespace std;
 
-#include "../../../include/SoundTouch.h"
-#include "../source/SoundStretch/WavFile.h"
+#include "SoundTouch.h"
+#include "SoundTouchEngine.h"
+#include "WavFile.h"
 
+#ifdef __ANDROID__
+#include <android/log.h>
 #define LOGV(...)   __android_log_print((int)ANDROID_LOG_INFO, "SOUNDTOUCH", __VA_ARGS__)
+#else
+// host JDK build for testing on desktop Linux
+#include <stdio.h>
+#define LOGV(...)   (fprintf(stderr, "SOUNDTOUCH: " __VA_ARGS__), fputc('\n', stderr))
+#endif
 //#define LOGV(...)
 
 
@@ -33,6 +41,7 @@ static string _errMsg = "";
 
 
 using namespace soundtouch;
+using namespace soundstretch;
 
 
 // Set error message to return
@@ -41,57 +50,6 @@ static void _setErrmsg(const char *msg)
 	_errMsg = msg;
 }
 
-#if 0   // apparently following workaround not needed any more with concurrent Android SDKs
-#ifdef _OPENMP
-
-#include <pthread.h>
-extern pthread_key_t gomp_tls_key;
-static void * _p_gomp_tls = nullptr;
-
-/// Function to initialize threading for OpenMP.
-///
-/// This is a workaround for bug in Android NDK v10 regarding OpenMP: OpenMP works only if
-/// called from the Android App main thread because in the main thread the gomp_tls storage is
-/// properly set, however, Android does not properly initialize gomp_tls storage for other threads.
-/// Thus if OpenMP routines are invoked from some other thread than the main thread,
-/// the OpenMP routine will crash the application due to nullptr access on uninitialized storage.
-///
-/// This workaround stores the gomp_tls storage from main thread, and copies to other threads.
-/// In order this to work, the Application main thread needws to call at least "getVersionString"
-/// routine.
-static int _init_threading(bool warn)
-{
-	void *ptr = pthread_getspecific(gomp_tls_key);
-	LOGV("JNI thread-specific TLS storage %ld", (long)ptr);
-	if (ptr == nullptr)
-	{
-		LOGV("JNI set missing TLS storage to %ld", (long)_p_gomp_tls);
-		pthread_setspecific(gomp_tls_key, _p_gomp_tls);
-	}
-	else
-	{
-		LOGV("JNI store this TLS storage");
-		_p_gomp_tls = ptr;
-	}
-	// Where critical, show warning if storage still not properly initialized
-	if ((warn) && (_p_gomp_tls == nullptr))
-	{
-		_setErrmsg("Error - OpenMP threading not properly initialized: Call SoundTouch.getVersionString() from the App main thread!");
-		return -1;
-	}
-	return 0;
-}
-
-#else
-static int _init_threading(bool warn)
-{
-	// do nothing if not OpenMP build
-	return 0;
-}
-#endif
-
-#endif
-
 // Processes the sound file
 static void _processFile(SoundTouch *pSoundTouch, const char *inFileName, const char *outFileName)
 {
@@ -163,18 +121,6 @@ extern "C" DLL_PUBLIC jstring Java_net_surina_soundtouch_SoundTouch_getVersionSt
     // Call example SoundTouch routine
     verStr = SoundTouch::getVersionString();
 
-    // gomp_tls storage bug workaround - see comments in _init_threading() function!
-    // update: apparently this is not needed any more with concurrent Android SDKs
-    // _init_threading(false);
-
-    int threads = 0;
-	#pragma omp parallel
-    {
-		#pragma omp atomic
-    	threads ++;
-    }
-    LOGV("JNI thread count %d", threads);
-
     // return version as string
     return env->NewStringUTF(verStr);
 }
@@ -233,10 +179,6 @@ extern "C" DLL_PUBLIC int Java_net_surina_soundtouch_SoundTouch_processFile(JNIE
 
 	LOGV("JNI process file %s", inputFile);
 
-    /// gomp_tls storage bug workaround - see comments in _init_threading() function!
-    // update: apparently this is not needed any more with concurrent Android SDKs
-    // if (_init_threading(true)) return -1;
-
 	try
 	{
 		_processFile(ptr, inputFile, outputFile);
@@ -256,3 +198,257 @@ extern "C" DLL_PUBLIC int Java_net_surina_soundtouch_SoundTouch_processFile(JNIE
 
 	return 0;
 }
+
+
+
+////////////////////////////////////////////////////////////////////////////////
+//
+// Block streaming interface for class 'SoundTouchStream'. Audio passes through
+// direct NIO buffers that the native code accesses in place, so that no Java
+// arrays get copied. Each stream has its own processor instance behind its
+// handle, and the processing path doesn't allocate memory or use OpenMP, so
+// streams can be processed in real-time audio callbacks.
+//
+////////////////////////////////////////////////////////////////////////////////
+
+/// Native state of one SoundTouchStream
+class JniStream
+{
+public:
+    SoundTouchEngine *engine;
+    int channels;
+
+    /// Number of silent frames that 'process' still outputs before the
+    /// processed audio, see '_processStream'
+    int prerollRemaining;
+
+    JniStream(int sampleRate, int numChannels)
+    {
+        engine = SoundTouchEngine::newInstance(SoundTouchEngine::FLOAT_SAMPLES);
+        try
+        {
+            engine->setSampleRate(sampleRate);
+            engine->setChannels(numChannels);
+        }
+        catch (...)
+        {
+            delete engine;
+            throw;
+        }
+        channels = numChannels;
+        clear();
+    }
+
+    ~JniStream()
+    {
+        delete engine;
+    }
+
+    void clear()
+    {
+        engine->clear();
+        prerollRemaining = engine->getOutputLatency();
+    }
+};
+
+
+// Returns address of 'numBytes' long region starting at 'offset' elements from
+// the position of the direct buffer, or nullptr if the region isn't valid.
+// 'unitSize' is the byte size of the buffer elements.
+static void *_getDirectRegion(JNIEnv *env, jobject buffer, jint offset, size_t unitSize, size_t numBytes, size_t alignment)
+{
+    char *base = (char *)env->GetDirectBufferAddress(buffer);
+    jlong capacity = env->GetDirectBufferCapacity(buffer);
+
+    if ((base == nullptr) || (capacity < 0))
+    {
+        _setErrmsg("Error - SoundTouchStream requires direct buffers");
+        return nullptr;
+    }
+    if ((offset < 0) || ((size_t)offset * unitSize + numBytes > (size_t)capacity * unitSize))
+    {
+        _setErrmsg("Error - SoundTouchStream buffer region out of bounds");
+        return nullptr;
+    }
+
+    char *ptr = base + (size_t)offset * unitSize;
+    if ((size_t)ptr % alignment)
+    {
+        _setErrmsg("Error - SoundTouchStream buffer region misaligned");
+        return nullptr;
+    }
+    return ptr;
+}
+
+
+// Returns sample pointer to 'numFrames' frames in a direct FloatBuffer
+static float *_getFloatFrames(JNIEnv *env, JniStream *stream, jobject buffer, jint offset, jint numFrames)
+{
+    if (numFrames < 0) return nullptr;
+    return (float *)_getDirectRegion(env, buffer, offset, sizeof(float),
+                                     (size_t)numFrames * stream->channels * sizeof(float), sizeof(float));
+}
+
+
+// Returns sample pointer to 'numFrames' frames of 16bit samples in a direct ByteBuffer
+static short *_getShortFrames(JNIEnv *env, JniStream *stream, jobject buffer, jint offset, jint numFrames)
+{
+    if (numFrames < 0) return nullptr;
+    return (short *)_getDirectRegion(env, buffer, offset, 1,
+                                     (size_t)numFrames * stream->channels * sizeof(short), sizeof(short));
+}
+
+
+// Feeds 'numFrames' frames into the stream, and outputs equal amount of frames.
+// SoundTouch outputs audio in bursts, so the output starts with silence of the
+// output latency, after which the processed audio flows without gaps as long as
+// tempo and speed remain 1.0. 'input' and 'output' may be the same buffer.
+template <typename SAMPLE>
+static jint _processStream(JniStream *stream, const SAMPLE *input, SAMPLE *output, int numFrames)
+{
+    const int channels = stream->channels;
+
+    stream->engine->putSamples(input, (uint)numFrames);
+
+    int silent = (stream->prerollRemaining < numFrames) ? stream->prerollRemaining : numFrames;
+    int wanted = numFrames - silent;
+    stream->prerollRemaining -= silent;
+
+    int received = (int)stream->engine->receiveSamples(output + silent * channels, (uint)wanted);
+
+    // if still short of samples (e.g. right after parameter change), put the gap
+    // as silence before the received samples instead of cutting the audio
+    if (received < wanted)
+    {
+        int missing = wanted - received;
+        memmove(output + (silent + missing) * channels, output + silent * channels, sizeof(SAMPLE) * received * channels);
+        memset(output + silent * channels, 0, sizeof(SAMPLE) * missing * channels);
+    }
+
+    memset(output, 0, sizeof(SAMPLE) * silent * channels);
+
+    return numFrames;
+}
+
+
+extern "C" DLL_PUBLIC jlong Java_net_surina_soundtouch_SoundTouchStream_newStream(JNIEnv *env, jobject thiz, jint sampleRate, jint channels)
+{
+	try
+	{
+		return (jlong)(new JniStream(sampleRate, channels));
+	}
+	catch (const runtime_error &e)
+	{
+		LOGV("JNI exception in SoundTouchStream::newStream: %s", e.what());
+		_setErrmsg(e.what());
+		return 0;
+	}
+}
+
+
+extern "C" DLL_PUBLIC void Java_net_surina_soundtouch_SoundTouchStream_deleteStream(JNIEnv *env, jobject thiz, jlong handle)
+{
+	JniStream *ptr = (JniStream*)handle;
+	delete ptr;
+}
+
+
+extern "C" DLL_PUBLIC void Java_net_surina_soundtouch_SoundTouchStream_setTempo(JNIEnv *env, jobject thiz, jlong handle, jfloat tempo)
+{
+	JniStream *ptr = (JniStream*)handle;
+	ptr->engine->setTempo(tempo);
+}
+
+
+extern "C" DLL_PUBLIC void Java_net_surina_soundtouch_SoundTouchStream_setPitchSemiTones(JNIEnv *env, jobject thiz, jlong handle, jfloat pitch)
+{
+	JniStream *ptr = (JniStream*)handle;
+	ptr->engine->setPitchSemiTones(pitch);
+}
+
+
+extern "C" DLL_PUBLIC void Java_net_surina_soundtouch_SoundTouchStream_setSpeed(JNIEnv *env, jobject thiz, jlong handle, jfloat speed)
+{
+	JniStream *ptr = (JniStream*)handle;
+	ptr->engine->setRate(speed);
+}
+
+
+extern "C" DLL_PUBLIC jint Java_net_surina_soundtouch_SoundTouchStream_getLatency(JNIEnv *env, jobject thiz, jlong handle)
+{
+	JniStream *ptr = (JniStream*)handle;
+	return ptr->engine->getOutputLatency();
+}
+
+
+extern "C" DLL_PUBLIC void Java_net_surina_soundtouch_SoundTouchStream_clear(JNIEnv *env, jobject thiz, jlong handle)
+{
+	JniStream *ptr = (JniStream*)handle;
+	ptr->clear();
+}
+
+
+extern "C" DLL_PUBLIC jint Java_net_surina_soundtouch_SoundTouchStream_putFloat(JNIEnv *env, jobject thiz, jlong handle, jobject input, jint offset, jint numFrames)
+{
+	JniStream *ptr = (JniStream*)handle;
+	const float *samples = _getFloatFrames(env, ptr, input, offset, numFrames);
+	if (samples == nullptr) return -1;
+
+	ptr->engine->putSamples(samples, (uint)numFrames);
+	return numFrames;
+}
+
+
+extern "C" DLL_PUBLIC jint Java_net_surina_soundtouch_SoundTouchStream_putShort(JNIEnv *env, jobject thiz, jlong handle, jobject input, jint offset, jint numFrames)
+{
+	JniStream *ptr = (JniStream*)handle;
+	const short *samples = _getShortFrames(env, ptr, input, offset, numFrames);
+	if (samples == nullptr) return -1;
+
+	ptr->engine->putSamples(samples, (uint)numFrames);
+	return numFrames;
+}
+
+
+extern "C" DLL_PUBLIC jint Java_net_surina_soundtouch_SoundTouchStream_receiveFloat(JNIEnv *env, jobject thiz, jlong handle, jobject output, jint offset, jint maxFrames)
+{
+	JniStream *ptr = (JniStream*)handle;
+	float *samples = _getFloatFrames(env, ptr, output, offset, maxFrames);
+	if (samples == nullptr) return -1;
+
+	return (jint)ptr->engine->receiveSamples(samples, (uint)maxFrames);
+}
+
+
+extern "C" DLL_PUBLIC jint Java_net_surina_soundtouch_SoundTouchStream_receiveShort(JNIEnv *env, jobject thiz, jlong handle, jobject output, jint offset, jint maxFrames)
+{
+	JniStream *ptr = (JniStream*)handle;
+	short *samples = _getShortFrames(env, ptr, output, offset, maxFrames);
+	if (samples == nullptr) return -1;
+
+	return (jint)ptr->engine->receiveSamples(samples, (uint)maxFrames);
+}
+
+
+extern "C" DLL_PUBLIC jint Java_net_surina_soundtouch_SoundTouchStream_processFloat(JNIEnv *env, jobject thiz, jlong handle,
+                                                                                   jobject input, jint inOffset, jobject output, jint outOffset, jint numFrames)
+{
+	JniStream *ptr = (JniStream*)handle;
+	const float *in = _getFloatFrames(env, ptr, input, inOffset, numFrames);
+	float *out = _getFloatFrames(env, ptr, output, outOffset, numFrames);
+	if ((in == nullptr) || (out == nullptr)) return -1;
+
+	return _processStream(ptr, in, out, numFrames);
+}
+
+
+extern "C" DLL_PUBLIC jint Java_net_surina_soundtouch_SoundTouchStream_processShort(JNIEnv *env, jobject thiz, jlong handle,
+                                                                                   jobject input, jint inOffset, jobject output, jint outOffset, jint numFrames)
+{
+	JniStream *ptr = (JniStream*)handle;
+	const short *in = _getShortFrames(env, ptr, input, inOffset, numFrames);
+	short *out = _getShortFrames(env, ptr, output, outOffset, numFrames);
+	if ((in == nullptr) || (out == nullptr)) return -1;
+
+	return _processStream(ptr, in, out, numFrames);
+}
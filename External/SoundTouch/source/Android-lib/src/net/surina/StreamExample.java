@@ -0,0 +1,134 @@
+/////////////////////////////////////////////////////////////////////////////
+///
+/// Example command-line program that pitch-shifts a test tone in fixed size
+/// blocks through SoundTouchStream, as an audio callback would do. Runs also
+/// on desktop with a host JDK, see README-SoundTouch-Android.html.
+///
+/// Usage: java net.surina.StreamExample [pitch semitones] [channels]
+///
+/// Copyright (c) Olli Parviainen
+///
+////////////////////////////////////////////////////////////////////////////////
+
+package net.surina;
+
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.FloatBuffer;
+
+import net.surina.soundtouch.SoundTouch;
+import net.surina.soundtouch.SoundTouchStream;
+
+public class StreamExample
+{
+	static final int SAMPLE_RATE = 44100;
+	static final int BLOCK_FRAMES = 256;
+	static final int NUM_BLOCKS = 400;
+
+
+	// Fills block with a sine test tone, returns the phase for next block
+	static double fillTone(FloatBuffer block, int channels, double phase)
+	{
+		for (int i = 0; i < BLOCK_FRAMES; i ++)
+		{
+			float value = (float)(0.5 * Math.sin(phase));
+			for (int c = 0; c < channels; c ++)
+			{
+				block.put(i * channels + c, value);
+			}
+			phase += 2 * Math.PI * 440.0 / SAMPLE_RATE;
+		}
+		return phase;
+	}
+
+
+	// Processes the test tone in place in a direct buffer, and returns the index
+	// of the first non-silent output frame
+	static long runFloat(SoundTouchStream stream)
+	{
+		final int channels = stream.getChannels();
+		FloatBuffer block = ByteBuffer.allocateDirect(4 * BLOCK_FRAMES * channels)
+				.order(ByteOrder.nativeOrder()).asFloatBuffer();
+		double phase = 0;
+		long firstSound = -1;
+
+		for (int n = 0; n < NUM_BLOCKS; n ++)
+		{
+			phase = fillTone(block, channels, phase);
+
+			block.clear();
+			stream.process(block, block, BLOCK_FRAMES);
+			block.clear();
+
+			for (int i = 0; (i < BLOCK_FRAMES) && (firstSound < 0); i ++)
+			{
+				if (block.get(i * channels) != 0) firstSound = (long)n * BLOCK_FRAMES + i;
+			}
+		}
+		return firstSound;
+	}
+
+
+	// Same with 16bit samples in separate input and output buffers
+	static long runShort(SoundTouchStream stream)
+	{
+		final int channels = stream.getChannels();
+		ByteBuffer input = ByteBuffer.allocateDirect(2 * BLOCK_FRAMES * channels).order(ByteOrder.nativeOrder());
+		ByteBuffer output = ByteBuffer.allocateDirect(2 * BLOCK_FRAMES * channels).order(ByteOrder.nativeOrder());
+		double phase = 0;
+		long firstSound = -1;
+
+		for (int n = 0; n < NUM_BLOCKS; n ++)
+		{
+			for (int i = 0; i < BLOCK_FRAMES; i ++)
+			{
+				short value = (short)(16384 * Math.sin(phase));
+				for (int c = 0; c < channels; c ++)
+				{
+					input.putShort(2 * (i * channels + c), value);
+				}
+				phase += 2 * Math.PI * 440.0 / SAMPLE_RATE;
+			}
+
+			input.clear();
+			output.clear();
+			stream.process(input, output, BLOCK_FRAMES);
+
+			for (int i = 0; (i < BLOCK_FRAMES) && (firstSound < 0); i ++)
+			{
+				if (output.getShort(2 * i * channels) != 0) firstSound = (long)n * BLOCK_FRAMES + i;
+			}
+		}
+		return firstSound;
+	}
+
+
+	public static void main(String[] args)
+	{
+		float pitch = (args.length > 0) ? Float.parseFloat(args[0]) : 3.0f;
+		int channels = (args.length > 1) ? Integer.parseInt(args[1]) : 2;
+
+		System.out.println("SoundTouch " + SoundTouch.getVersionString());
+
+		SoundTouchStream stream = new SoundTouchStream(SAMPLE_RATE, channels);
+		stream.setPitchSemiTones(pitch);
+		stream.clear();
+
+		final int latency = stream.getLatency();
+		final long firstFloat = runFloat(stream);
+		stream.clear();
+		final long firstShort = runShort(stream);
+		stream.close();
+
+		System.out.println("pitch " + pitch + " semitones, " + channels + " channels, latency " + latency + " frames");
+		System.out.println("float: first processed frame " + firstFloat);
+		System.out.println("16bit: first processed frame " + firstShort);
+
+		// the processed audio starts right after the reported latency; allow few
+		// frames for the fade-in of the tone rounding to zero
+		boolean ok = (firstFloat >= latency) && (firstFloat < latency + 8) &&
+		             (firstShort >= latency) && (firstShort < latency + 8);
+		System.out.println(ok ? "OK" : "FAILED");
+		if (!ok) System.exit(1);
+	}
+}
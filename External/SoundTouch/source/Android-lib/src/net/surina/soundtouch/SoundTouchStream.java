@@ -0,0 +1,207 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+/// Block streaming interface to native SoundTouch routines. Audio passes in
+/// direct NIO buffers that the native code reads and writes in place, so that
+/// no Java arrays get copied. Each stream owns a native processor instance, and
+/// the processing calls don't allocate memory, so that they can be invoked from
+/// real-time audio callbacks.
+///
+/// Samples are interleaved, either as 32bit floats in a direct FloatBuffer, or
+/// as 16bit integers in a direct ByteBuffer with native byte order. All calls
+/// are relative: they start at the buffer position, and advance the position
+/// past the processed samples.
+///
+/// Author        : Copyright (c) Olli Parviainen
+/// Author e-mail : oparviai 'at' iki.fi
+/// WWW           : http://www.surina.net
+///
+////////////////////////////////////////////////////////////////////////////////
+
+package net.surina.soundtouch;
+
+import java.nio.Buffer;
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.nio.FloatBuffer;
+
+public final class SoundTouchStream
+{
+    private native final long newStream(int sampleRate, int channels);
+
+    private native final void deleteStream(long handle);
+
+    private native final void setTempo(long handle, float tempo);
+
+    private native final void setPitchSemiTones(long handle, float pitch);
+
+    private native final void setSpeed(long handle, float speed);
+
+    private native final int getLatency(long handle);
+
+    private native final void clear(long handle);
+
+    private native final int putFloat(long handle, FloatBuffer input, int offset, int numFrames);
+
+    private native final int putShort(long handle, ByteBuffer input, int offset, int numFrames);
+
+    private native final int receiveFloat(long handle, FloatBuffer output, int offset, int maxFrames);
+
+    private native final int receiveShort(long handle, ByteBuffer output, int offset, int maxFrames);
+
+    private native final int processFloat(long handle, FloatBuffer input, int inOffset, FloatBuffer output, int outOffset, int numFrames);
+
+    private native final int processShort(long handle, ByteBuffer input, int inOffset, ByteBuffer output, int outOffset, int numFrames);
+
+    long handle = 0;
+
+    final int channels;
+
+
+    public SoundTouchStream(int sampleRate, int channels)
+    {
+    	handle = newStream(sampleRate, channels);
+    	if (handle == 0)
+    	{
+    		throw new IllegalArgumentException(SoundTouch.getErrorString());
+    	}
+    	this.channels = channels;
+    }
+
+
+    public void close()
+    {
+    	deleteStream(handle);
+    	handle = 0;
+    }
+
+
+    public int getChannels()
+    {
+    	return channels;
+    }
+
+
+    public void setTempo(float tempo)
+    {
+    	setTempo(handle, tempo);
+    }
+
+
+    public void setPitchSemiTones(float pitch)
+    {
+    	setPitchSemiTones(handle, pitch);
+    }
+
+
+    public void setSpeed(float speed)
+    {
+    	setSpeed(handle, speed);
+    }
+
+
+    // Returns the number of silent frames that 'process' outputs before the
+    // processed audio. Call 'clear' after changing the settings to start the
+    // stream again with the new latency.
+    public int getLatency()
+    {
+    	return getLatency(handle);
+    }
+
+
+    // Discards the buffered audio and restarts the stream
+    public void clear()
+    {
+    	clear(handle);
+    }
+
+
+    // Feeds 'numFrames' frames into the stream
+    public void putSamples(FloatBuffer input, int numFrames)
+    {
+    	checkResult(putFloat(handle, input, input.position(), numFrames));
+    	advance(input, numFrames);
+    }
+
+
+    public void putSamples(ByteBuffer input, int numFrames)
+    {
+    	checkOrder(input);
+    	checkResult(putShort(handle, input, input.position(), numFrames));
+    	advance(input, 2 * numFrames);
+    }
+
+
+    // Outputs at most 'maxFrames' processed frames. Returns the number of frames
+    // output, which may be zero during some rounds.
+    public int receiveSamples(FloatBuffer output, int maxFrames)
+    {
+    	int frames = checkResult(receiveFloat(handle, output, output.position(), maxFrames));
+    	advance(output, frames);
+    	return frames;
+    }
+
+
+    public int receiveSamples(ByteBuffer output, int maxFrames)
+    {
+    	checkOrder(output);
+    	int frames = checkResult(receiveShort(handle, output, output.position(), maxFrames));
+    	advance(output, 2 * frames);
+    	return frames;
+    }
+
+
+    // Processes 'numFrames' frames from 'input' into the same amount of frames to
+    // 'output', for pitch shifting in fixed size blocks at tempo and speed 1.0.
+    // The output starts with 'getLatency' frames of silence, after which the
+    // processed audio flows without gaps. 'input' and 'output' may be the same
+    // buffer for processing in place.
+    public void process(FloatBuffer input, FloatBuffer output, int numFrames)
+    {
+    	checkResult(processFloat(handle, input, input.position(), output, output.position(), numFrames));
+    	advance(input, numFrames);
+    	if (output != input) advance(output, numFrames);
+    }
+
+
+    public void process(ByteBuffer input, ByteBuffer output, int numFrames)
+    {
+    	checkOrder(input);
+    	checkOrder(output);
+    	checkResult(processShort(handle, input, input.position(), output, output.position(), numFrames));
+    	advance(input, 2 * numFrames);
+    	if (output != input) advance(output, 2 * numFrames);
+    }
+
+
+    // 16bit samples are accessed in native byte order
+    private static void checkOrder(ByteBuffer buffer)
+    {
+    	if (buffer.order() != ByteOrder.nativeOrder())
+    	{
+    		throw new IllegalArgumentException("SoundTouchStream requires native byte order");
+    	}
+    }
+
+
+    private static int checkResult(int result)
+    {
+    	if (result < 0)
+    	{
+    		throw new IllegalArgumentException(SoundTouch.getErrorString());
+    	}
+    	return result;
+    }
+
+
+    private void advance(Buffer buffer, int numFrames)
+    {
+    	buffer.position(buffer.position() + numFrames * channels);
+    }
+
+
+    // Load the native library upon startup
+    static
+    {
+        System.loadLibrary("soundtouch");
+    }
+}
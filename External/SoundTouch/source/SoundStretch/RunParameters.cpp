@@ -81,7 +81,9 @@ static const char usage[] =
     "  -rate=n  : Change sound rate by n percents   (n=-95..+5000 %)\n"
     "  -bpm=n   : Detect the BPM rate of sound and adjust tempo to meet 'n' BPMs.\n"
     "             If '=n' is omitted, just detects the BPM rate.\n"
-    "  -quick   : Use quicker tempo change algorithm (gain speed, lose quality)\n"
+    "  -quick=n : Use quicker tempo change algorithm (gain speed, lose quality).\n"
+    "             n=2 selects the hierarchical seek, which loses less quality,\n"
+    "             n=3 the pitch guided seek for speech.\n"
     "  -naa     : Don't use anti-alias filtering (gain speed, lose quality)\n"
     "  -speech  : Tune algorithm for speech processing (default is for music)\n"
     "  -license : Display the program license text (LGPL)\n";
@@ -264,8 +266,17 @@ void RunParameters::parseSwitchParam(const STRING& str)
             break;
 
         case 'q' :
-            // switch '-quick'
+            // switch '-quick=xx'
             quick = 1;
+            try
+            {
+                const int value = (int)parseSwitchValue(str);
+                if ((value == 2) || (value == 3)) quick = value;
+            }
+            catch (const runtime_error &)
+            {
+                // missing value => the quick seek
+            }
             break;
 
         case 'n' :
@@ -122,13 +122,14 @@ static void setup(SoundTouch& soundTouch, const WavInFile& inFile, const RunPara
 
     soundTouch.setSetting(SETTING_USE_QUICKSEEK, params.quick);
     soundTouch.setSetting(SETTING_USE_AA_FILTER, !(params.noAntiAlias));
+    // file processing has no real-time deadlines, so use all cores for large full seeks
+    soundTouch.setSetting(SETTING_PARALLEL_SEEK, 1);
 
     if (params.speech)
     {
-        // use settings for speech processing
-        soundTouch.setSetting(SETTING_SEQUENCE_MS, 40);
-        soundTouch.setSetting(SETTING_SEEKWINDOW_MS, 15);
-        soundTouch.setSetting(SETTING_OVERLAP_MS, 8);
+        // use settings for speech processing, derived from the default voice
+        // fundamental frequency range and latency budget
+        soundTouch.setSetting(SETTING_SPEECH_PROFILE, 1);
         fprintf(stderr, "Tune processing parameters for speech processing.\n");
     }
 
@@ -37,6 +37,7 @@
 #include <assert.h>
 #include <math.h>
 #include <stdlib.h>
+#include <atomic>
 #include "AAFilter.h"
 #include "FIRFilter.h"
 
@@ -45,6 +46,13 @@ using namespace soundtouch;
 #define PI       3.14159265358979323846
 #define TWOPI    (2 * PI)
 
+// Resolution of the cutoff frequency in the filter cache, as fraction of sampling
+// frequency. Cutoff frequencies closer than this to each other share same filter.
+#define AA_CUTOFF_RESOLUTION    8192
+
+// Number of hash buckets in the filter cache
+#define AA_CACHE_BUCKETS        64
+
 // define this to save AA filter coefficients to a file
 // #define _DEBUG_SAVE_AAFILTER_COEFFICIENTS   1
 
@@ -70,44 +78,41 @@ using namespace soundtouch;
 
 /*****************************************************************************
  *
- * Implementation of the class 'AAFilter'
+ * Process-wide cache of anti-alias filter coefficients
  *
  *****************************************************************************/
 
-AAFilter::AAFilter(uint len)
-{
-    pFIR = FIRFilter::newInstance();
-    cutoffFreq = 0.5;
-    setLength(len);
-}
-
-
-AAFilter::~AAFilter()
+namespace
 {
-    delete pFIR;
-}
-
+    /// Entry of the filter cache. Entries are immutable once added to the cache,
+    /// and live until the program exits, so the coefficient sets can be shared
+    /// read-only by all AAFilter instances.
+    struct AACacheEntry
+    {
+        uint length;
+        int cutoffKey;
+        const FIRCoefficients *coeffs;
+        const AACacheEntry *next;
+    };
 
-// Sets new anti-alias filter cut-off edge frequency, scaled to
-// sampling frequency (nyquist frequency = 0.5).
-// The filter will cut frequencies higher than the given frequency.
-void AAFilter::setCutoffFreq(double newCutoffFreq)
-{
-    cutoffFreq = newCutoffFreq;
-    calculateCoeffs();
-}
+    // Cache buckets, each holding a linked list of entries. Lookups are lock-free,
+    // and new entries get prepended to the lists with compare-and-swap.
+    std::atomic<const AACacheEntry*> _aaCache[AA_CACHE_BUCKETS];
 
 
-// Sets number of FIR filter taps
-void AAFilter::setLength(uint newLength)
-{
-    length = newLength;
-    calculateCoeffs();
+    const AACacheEntry *findEntry(const AACacheEntry *entry, uint length, int cutoffKey)
+    {
+        for (; entry != nullptr; entry = entry->next)
+        {
+            if ((entry->length == length) && (entry->cutoffKey == cutoffKey)) return entry;
+        }
+        return nullptr;
+    }
 }
 
 
 // Calculates coefficients for a low-pass FIR filter using Hamming window
-void AAFilter::calculateCoeffs()
+static FIRCoefficients *designCoeffs(double cutoffFreq, uint length)
 {
     uint i;
     double cntTemp, temp, tempCoeff,h, w;
@@ -115,6 +120,7 @@ void AAFilter::calculateCoeffs()
     double scaleCoeff, sum;
     double *work;
     SAMPLETYPE *coeffs;
+    FIRCoefficients *result;
 
     assert(length >= 2);
     assert(length % 4 == 0);
@@ -172,22 +178,135 @@ void AAFilter::calculateCoeffs()
         coeffs[i] = (SAMPLETYPE)temp;
     }
 
-    // Set coefficients. Use divide factor 14 => divide result by 2^14 = 16384
-    pFIR->setCoefficients(coeffs, length, 14);
+    // Use divide factor 14 => divide result by 2^14 = 16384
+    result = new FIRCoefficients(coeffs, length, 14);
 
     _DEBUG_SAVE_AAFIR_COEFFS(coeffs, length);
 
     delete[] work;
     delete[] coeffs;
+
+    return result;
+}
+
+
+/*****************************************************************************
+ *
+ * Implementation of the class 'AAFilter'
+ *
+ *****************************************************************************/
+
+AAFilter::AAFilter(uint len)
+{
+    pFIR = FIRFilter::newInstance();
+    cutoffFreq = 0.5;
+    delayLength = 0;
+    setLength(len);
+}
+
+
+AAFilter::~AAFilter()
+{
+    delete pFIR;
+}
+
+
+// Sets new anti-alias filter cut-off edge frequency, scaled to
+// sampling frequency (nyquist frequency = 0.5).
+// The filter will cut frequencies higher than the given frequency.
+void AAFilter::setCutoffFreq(double newCutoffFreq)
+{
+    cutoffFreq = newCutoffFreq;
+    calculateCoeffs();
+}
+
+
+// Sets number of FIR filter taps
+void AAFilter::setLength(uint newLength)
+{
+    length = newLength;
+    calculateCoeffs();
+}
+
+
+// Sets number of FIR filter taps whose delay the filter keeps when shorter
+void AAFilter::setDelayLength(uint newDelayLength)
+{
+    delayLength = newDelayLength;
+}
+
+
+uint AAFilter::getDelayLength() const
+{
+    return delayLength;
+}
+
+
+uint AAFilter::getPadding() const
+{
+    return (delayLength > length) ? (delayLength - length) / 2 : 0;
+}
+
+
+uint AAFilter::getDelay() const
+{
+    return getLength() / 2 + getPadding();
+}
+
+
+// Takes the FIR coefficients realizing the current cutoff-frequency and length
+// into use. The coefficients are designed only if not yet found in the cache.
+void AAFilter::calculateCoeffs()
+{
+    pFIR->useCoefficients(getCoefficients(cutoffFreq, length));
+}
+
+
+// Returns coefficient set for given cutoff frequency and filter length from the
+// process-wide filter cache. Designs the filter and adds it to the cache if it's
+// not there yet.
+const FIRCoefficients *AAFilter::getCoefficients(double cutoffFreq, uint length)
+{
+    const int cutoffKey = (int)(cutoffFreq * AA_CUTOFF_RESOLUTION + 0.5);
+    std::atomic<const AACacheEntry*> &bucket = _aaCache[(uint)(cutoffKey + 31 * length) % AA_CACHE_BUCKETS];
+
+    const AACacheEntry *head = bucket.load(std::memory_order_acquire);
+    const AACacheEntry *found = findEntry(head, length, cutoffKey);
+    if (found) return found->coeffs;
+
+    // not cached yet, design the filter for the quantized cutoff frequency
+    AACacheEntry *entry = new AACacheEntry;
+    entry->length = length;
+    entry->cutoffKey = cutoffKey;
+    entry->coeffs = designCoeffs((double)cutoffKey / AA_CUTOFF_RESOLUTION, length);
+    entry->next = head;
+
+    while (!bucket.compare_exchange_weak(entry->next, entry, std::memory_order_acq_rel, std::memory_order_acquire))
+    {
+        // another thread modified the bucket meanwhile, check if it added the same filter
+        found = findEntry(entry->next, length, cutoffKey);
+        if (found)
+        {
+            delete entry->coeffs;
+            delete entry;
+            return found->coeffs;
+        }
+    }
+    return entry->coeffs;
 }
 
 
 // Applies the filter to the given sequence of samples.
-// Note : The amount of outputted samples is by value of 'filter length'
-// smaller than the amount of input samples.
+// Note : The amount of outputted samples is by value of 'filter length', or of
+// 'delay length' if that is longer, smaller than the amount of input samples.
 uint AAFilter::evaluate(SAMPLETYPE *dest, const SAMPLETYPE *src, uint numSamples, uint numChannels) const
 {
-    return pFIR->evaluate(dest, src, numSamples, numChannels);
+    // skip the padding on both sides, so that the output is centered on the
+    // middle of the longer window
+    const uint pad = getPadding();
+    if (numSamples <= 2 * pad) return 0;
+
+    return pFIR->evaluate(dest, src + pad * numChannels, numSamples - 2 * pad, numChannels);
 }
 
 
@@ -208,7 +327,7 @@ uint AAFilter::evaluate(FIFOSampleBuffer &dest, FIFOSampleBuffer &src) const
     numSrcSamples = src.numSamples();
     psrc = src.ptrBegin();
     pdest = dest.ptrEnd(numSrcSamples);
-    result = pFIR->evaluate(pdest, psrc, numSrcSamples, numChannels);
+    result = evaluate(pdest, psrc, numSrcSamples, numChannels);
     src.receiveSamples(result);
     dest.putSamples(result);
 
@@ -220,3 +339,9 @@ uint AAFilter::getLength() const
 {
     return pFIR->getLength();
 }
+
+
+uint AAFilter::getInputLength(uint numOutput, uint numChannels) const
+{
+    return pFIR->getInputLength(numOutput, numChannels) + 2 * getPadding();
+}
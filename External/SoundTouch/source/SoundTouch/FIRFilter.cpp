@@ -47,6 +47,56 @@
 
 using namespace soundtouch;
 
+/*****************************************************************************
+ *
+ * Implementation of the class 'FIRCoefficients'
+ *
+ *****************************************************************************/
+
+// Scales and arranges the given filter coefficients for the filter routines.
+//
+// Throws an exception if filter length isn't divisible by 8
+FIRCoefficients::FIRCoefficients(const SAMPLETYPE *coeffs, uint newLength, uint uResultDivFactor)
+{
+    assert(newLength > 0);
+    if (newLength % 8) ST_THROW_RT_ERROR("FIR filter length not divisible by 8");
+
+    length = newLength;
+    resultDivFactor = uResultDivFactor;
+
+    // allocate both coefficient sets from single memory block, stereo set first
+    // so that it gets aligned to 16-byte boundary
+    memory = new SAMPLETYPE[3 * length + 16 / sizeof(SAMPLETYPE)];
+    SAMPLETYPE *pStereo = (SAMPLETYPE *)SOUNDTOUCH_ALIGN_POINTER_16(memory);
+    SAMPLETYPE *pMono = pStereo + 2 * length;
+
+#ifdef SOUNDTOUCH_FLOAT_SAMPLES
+    // scale coefficients already here if using floating samples
+    const double scale = ::pow(0.5, (int)resultDivFactor);;
+#else
+    const short scale = 1;
+#endif
+
+    for (uint i = 0; i < length; i ++)
+    {
+        pMono[i] = (SAMPLETYPE)(coeffs[i] * scale);
+        // create also stereo set of filter coefficients: this allows compiler
+        // to autovectorize filter evaluation much more efficiently
+        pStereo[2 * i] = (SAMPLETYPE)(coeffs[i] * scale);
+        pStereo[2 * i + 1] = (SAMPLETYPE)(coeffs[i] * scale);
+    }
+
+    mono = pMono;
+    stereo = pStereo;
+}
+
+
+FIRCoefficients::~FIRCoefficients()
+{
+    delete[] memory;
+}
+
+
 /*****************************************************************************
  *
  * Implementation of the class 'FIRFilter'
@@ -60,89 +110,86 @@ FIRFilter::FIRFilter()
     lengthDiv8 = 0;
     filterCoeffs = nullptr;
     filterCoeffsStereo = nullptr;
+    ownCoeffs = nullptr;
 }
 
 
 FIRFilter::~FIRFilter()
 {
-    delete[] filterCoeffs;
-    delete[] filterCoeffsStereo;
+    delete ownCoeffs;
 }
 
 
-// Usual C-version of the filter routine for stereo sound
-uint FIRFilter::evaluateFilterStereo(SAMPLETYPE *dest, const SAMPLETYPE *src, uint numSamples) const
+// Filter routine specialized for 'CHANNELS' interleaved channels. The channel
+// count is a compile-time constant so that the compiler can unroll and vectorize
+// the loops with constant strides. 'coeffs' contains each filter coefficient
+// repeated for every channel, so that the inner loop can process the channels
+// alike, splitting the sum to eight partial sums, each of which accumulates one
+// channel only.
+template <int CHANNELS>
+static inline uint evaluateFilterChannels(SAMPLETYPE *dest, const SAMPLETYPE *src, uint numSamples,
+                                          const SAMPLETYPE *coeffs, uint length, uint resultDivFactor)
 {
+    static_assert((8 % CHANNELS) == 0, "channel count must divide the partial sum count");
     int j, end;
     // hint compiler autovectorization that loop length is divisible by 8
-    uint ilength = length & -8;
-
-    assert((length != 0) && (length == ilength) && (src != nullptr) && (dest != nullptr) && (filterCoeffs != nullptr));
-    assert(numSamples > ilength);
+    const int ilength = CHANNELS * (length & -8);
 
-    end = 2 * (numSamples - ilength);
+    end = CHANNELS * (numSamples - (length & -8));
 
     #pragma omp parallel for
-    for (j = 0; j < end; j += 2)
+    for (j = 0; j < end; j += CHANNELS)
     {
-        const SAMPLETYPE *ptr;
-        LONG_SAMPLETYPE suml, sumr;
+        const SAMPLETYPE *ptr = src + j;
+        LONG_SAMPLETYPE sums[8] = { 0 };
+        int i, c;
 
-        suml = sumr = 0;
-        ptr = src + j;
-
-        for (uint i = 0; i < ilength; i ++)
+        for (i = 0; i < ilength; i += 8)
         {
-            suml += ptr[2 * i] * filterCoeffsStereo[2 * i];
-            sumr += ptr[2 * i + 1] * filterCoeffsStereo[2 * i + 1];
+            for (c = 0; c < 8; c ++)
+            {
+                sums[c] += ptr[i + c] * coeffs[i + c];
+            }
         }
 
+        for (c = 0; c < CHANNELS; c ++)
+        {
+            LONG_SAMPLETYPE sum = 0;
+
+            for (i = c; i < 8; i += CHANNELS)
+            {
+                sum += sums[i];
+            }
 #ifdef SOUNDTOUCH_INTEGER_SAMPLES
-        suml >>= resultDivFactor;
-        sumr >>= resultDivFactor;
-        // saturate to 16 bit integer limits
-        suml = (suml < -32768) ? -32768 : (suml > 32767) ? 32767 : suml;
-        // saturate to 16 bit integer limits
-        sumr = (sumr < -32768) ? -32768 : (sumr > 32767) ? 32767 : sumr;
+            sum >>= resultDivFactor;
+            // saturate to 16 bit integer limits
+            sum = (sum < -32768) ? -32768 : (sum > 32767) ? 32767 : sum;
+#else
+            (void)resultDivFactor;
 #endif // SOUNDTOUCH_INTEGER_SAMPLES
-        dest[j] = (SAMPLETYPE)suml;
-        dest[j + 1] = (SAMPLETYPE)sumr;
+            dest[j + c] = (SAMPLETYPE)sum;
+        }
     }
-    return numSamples - ilength;
+    return numSamples - (length & -8);
 }
 
 
-// Usual C-version of the filter routine for mono sound
-uint FIRFilter::evaluateFilterMono(SAMPLETYPE *dest, const SAMPLETYPE *src, uint numSamples) const
+// Usual C-version of the filter routine for stereo sound
+uint FIRFilter::evaluateFilterStereo(SAMPLETYPE *dest, const SAMPLETYPE *src, uint numSamples) const
 {
-    int j, end;
+    assert((length != 0) && (length == (length & -8)) && (src != nullptr) && (dest != nullptr) && (filterCoeffs != nullptr));
+    assert(numSamples > length);
 
-    // hint compiler autovectorization that loop length is divisible by 8
-    int ilength = length & -8;
+    return evaluateFilterChannels<2>(dest, src, numSamples, filterCoeffsStereo, length, resultDivFactor);
+}
 
-    assert(ilength != 0);
 
-    end = numSamples - ilength;
-    #pragma omp parallel for
-    for (j = 0; j < end; j ++)
-    {
-        const SAMPLETYPE *pSrc = src + j;
-        LONG_SAMPLETYPE sum;
-        int i;
+// Usual C-version of the filter routine for mono sound
+uint FIRFilter::evaluateFilterMono(SAMPLETYPE *dest, const SAMPLETYPE *src, uint numSamples) const
+{
+    assert(length != 0);
 
-        sum = 0;
-        for (i = 0; i < ilength; i ++)
-        {
-            sum += pSrc[i] * filterCoeffs[i];
-        }
-#ifdef SOUNDTOUCH_INTEGER_SAMPLES
-        sum >>= resultDivFactor;
-        // saturate to 16 bit integer limits
-        sum = (sum < -32768) ? -32768 : (sum > 32767) ? 32767 : sum;
-#endif // SOUNDTOUCH_INTEGER_SAMPLES
-        dest[j] = (SAMPLETYPE)sum;
-    }
-    return end;
+    return evaluateFilterChannels<1>(dest, src, numSamples, filterCoeffs, length, resultDivFactor);
 }
 
 
@@ -203,34 +250,31 @@ uint FIRFilter::evaluateFilterMulti(SAMPLETYPE *dest, const SAMPLETYPE *src, uin
 // Throws an exception if filter length isn't divisible by 8
 void FIRFilter::setCoefficients(const SAMPLETYPE *coeffs, uint newLength, uint uResultDivFactor)
 {
-    assert(newLength > 0);
-    if (newLength % 8) ST_THROW_RT_ERROR("FIR filter length not divisible by 8");
+    FIRCoefficients *newCoeffs = new FIRCoefficients(coeffs, newLength, uResultDivFactor);
 
-    lengthDiv8 = newLength / 8;
-    length = lengthDiv8 * 8;
-    assert(length == newLength);
+    // useCoefficients releases the previously owned set
+    useCoefficients(newCoeffs);
+    ownCoeffs = newCoeffs;
+}
 
-    resultDivFactor = uResultDivFactor;
 
-    delete[] filterCoeffs;
-    filterCoeffs = new SAMPLETYPE[length];
-    delete[] filterCoeffsStereo;
-    filterCoeffsStereo = new SAMPLETYPE[length*2];
+// Takes given shared coefficient set into use. The set remains owned by the caller.
+void FIRFilter::useCoefficients(const FIRCoefficients *coeffs)
+{
+    assert(coeffs != nullptr);
 
-#ifdef SOUNDTOUCH_FLOAT_SAMPLES
-    // scale coefficients already here if using floating samples
-    const double scale = ::pow(0.5, (int)resultDivFactor);;
-#else
-    const short scale = 1;
-#endif
+    lengthDiv8 = coeffs->length / 8;
+    length = lengthDiv8 * 8;
+    assert(length == coeffs->length);
 
-    for (uint i = 0; i < length; i ++)
+    resultDivFactor = coeffs->resultDivFactor;
+    filterCoeffs = coeffs->mono;
+    filterCoeffsStereo = coeffs->stereo;
+
+    if (coeffs != ownCoeffs)
     {
-        filterCoeffs[i] = (SAMPLETYPE)(coeffs[i] * scale);
-        // create also stereo set of filter coefficients: this allows compiler
-        // to autovectorize filter evaluation much more efficiently
-        filterCoeffsStereo[2 * i] = (SAMPLETYPE)(coeffs[i] * scale);
-        filterCoeffsStereo[2 * i + 1] = (SAMPLETYPE)(coeffs[i] * scale);
+        delete ownCoeffs;
+        ownCoeffs = nullptr;
     }
 }
 
@@ -241,6 +285,14 @@ uint FIRFilter::getLength() const
 }
 
 
+// Returns the number of input samples needed for outputting 'numOutput' samples.
+// The filter holds back its full length of samples.
+uint FIRFilter::getInputLength(uint numOutput, uint) const
+{
+    return numOutput + length;
+}
+
+
 // Applies the filter to the given sequence of samples.
 //
 // Note : The amount of outputted samples is by value of 'filter_length'
@@ -250,7 +302,8 @@ uint FIRFilter::evaluate(SAMPLETYPE *dest, const SAMPLETYPE *src, uint numSample
     assert(length > 0);
     assert(lengthDiv8 * 8 == length);
 
-    if (numSamples < length) return 0;
+    // need more than 'length' samples to output anything
+    if (numSamples <= length) return 0;
 
 #ifndef USE_MULTICH_ALWAYS
     if (numChannels == 1)
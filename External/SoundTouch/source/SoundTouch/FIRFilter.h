@@ -41,6 +41,33 @@
 namespace soundtouch
 {
 
+/// Immutable set of FIR filter coefficients, prescaled and arranged for the filter
+/// routines. A coefficient set can be shared read-only by several FIRFilter instances.
+class FIRCoefficients
+{
+private:
+    SAMPLETYPE *memory;
+
+public:
+    /// Number of filter taps
+    uint length;
+
+    /// Result divider factor in 2^k format
+    uint resultDivFactor;
+
+    /// Filter coefficients for the mono and multichannel routines
+    const SAMPLETYPE *mono;
+
+    /// Each filter coefficient twice in a row for the stereo routines. Aligned
+    /// to 16-byte boundary
+    const SAMPLETYPE *stereo;
+
+    /// Throws an exception if filter length isn't divisible by 8
+    FIRCoefficients(const SAMPLETYPE *coeffs, uint newLength, uint uResultDivFactor);
+    ~FIRCoefficients();
+};
+
+
 class FIRFilter
 {
 protected:
@@ -52,9 +79,12 @@ protected:
     // Result divider factor in 2^k format
     uint resultDivFactor;
 
-    // Memory for filter coefficients
-    SAMPLETYPE *filterCoeffs;
-    SAMPLETYPE *filterCoeffsStereo;
+    // Filter coefficients, either shared or owned by this instance
+    const SAMPLETYPE *filterCoeffs;
+    const SAMPLETYPE *filterCoeffsStereo;
+
+    // Coefficient set created by 'setCoefficients', nullptr if shared set is in use
+    FIRCoefficients *ownCoeffs;
 
     virtual uint evaluateFilterStereo(SAMPLETYPE *dest,
                                       const SAMPLETYPE *src,
@@ -86,9 +116,18 @@ public:
 
     uint getLength() const;
 
-    virtual void setCoefficients(const SAMPLETYPE *coeffs,
-                                 uint newLength,
-                                 uint uResultDivFactor);
+    /// Returns the number of input samples needed for outputting 'numOutput'
+    /// samples with the given number of channels.
+    virtual uint getInputLength(uint numOutput, uint numChannels) const;
+
+    /// Sets filter coefficients by making a private copy of them.
+    void setCoefficients(const SAMPLETYPE *coeffs,
+                         uint newLength,
+                         uint uResultDivFactor);
+
+    /// Takes the given coefficient set into use. The set isn't copied, so it
+    /// must remain valid as long as this filter uses it.
+    virtual void useCoefficients(const FIRCoefficients *coeffs);
 };
 
 
@@ -108,7 +147,9 @@ public:
         FIRFilterMMX();
         ~FIRFilterMMX();
 
-        virtual void setCoefficients(const short *coeffs, uint newLength, uint uResultDivFactor) override;
+        virtual uint getInputLength(uint numOutput, uint numChannels) const override;
+
+        virtual void useCoefficients(const FIRCoefficients *coeffs) override;
     };
 
 #endif // SOUNDTOUCH_ALLOW_MMX
@@ -119,15 +160,15 @@ public:
     class FIRFilterSSE : public FIRFilter
     {
     protected:
-        float *filterCoeffsUnalign;
-        float *filterCoeffsAlign;
+        const float *filterCoeffsAlign;
 
         virtual uint evaluateFilterStereo(float *dest, const float *src, uint numSamples) const override;
     public:
         FIRFilterSSE();
-        ~FIRFilterSSE();
 
-        virtual void setCoefficients(const float *coeffs, uint newLength, uint uResultDivFactor) override;
+        virtual uint getInputLength(uint numOutput, uint numChannels) const override;
+
+        virtual void useCoefficients(const FIRCoefficients *coeffs) override;
     };
 
 #endif // SOUNDTOUCH_ALLOW_SSE
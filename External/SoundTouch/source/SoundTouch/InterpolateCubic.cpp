@@ -44,15 +44,63 @@ static const float _coeffs[]=
    0.5f, -0.5f,  0.0f, 0.0f};
 
 
+namespace
+{
+    /// Polyphase table of cubic interpolation weights, one row of 4 weights
+    /// for each fractional position 0, 1/PHASES, ..., 1.0
+    class CubicTable
+    {
+    public:
+        enum { PHASES = TransposerBase::PHASES };
+
+        alignas(16) float coeffs[4 * (PHASES + 1)];
+
+        CubicTable()
+        {
+            for (int p = 0; p <= PHASES; p ++)
+            {
+                const float x3 = 1.0f;
+                const float x2 = (float)p / (float)PHASES;  // x
+                const float x1 = x2*x2;                     // x^2
+                const float x0 = x1*x2;                     // x^3
+
+                for (int k = 0; k < 4; k ++)
+                {
+                    coeffs[4 * p + k] = _coeffs[4 * k] * x0 + _coeffs[4 * k + 1] * x1 +
+                                        _coeffs[4 * k + 2] * x2 + _coeffs[4 * k + 3] * x3;
+                }
+            }
+        }
+    };
+}
+
+
+const float *InterpolateCubic::getCoeffTable()
+{
+    // table gets built once on first use, and is then shared by all instances
+    static const CubicTable table;
+    return table.coeffs;
+}
+
+
 InterpolateCubic::InterpolateCubic()
 {
-    fract = 0;
+    coeffTable = getCoeffTable();
+    iFract = 0;
+    iRate = fixedRate(1.0);
 }
 
 
 void InterpolateCubic::resetRegisters()
 {
-    fract = 0;
+    iFract = 0;
+}
+
+
+void InterpolateCubic::setRate(double newRate)
+{
+    TransposerBase::setRate(newRate);
+    iRate = fixedRate(newRate);
 }
 
 
@@ -70,29 +118,20 @@ int InterpolateCubic::transposeMono(SAMPLETYPE *pdest,
     while (srcCount < srcSampleEnd)
     {
         float out;
-        const float x3 = 1.0f;
-        const float x2 = (float)fract;    // x
-        const float x1 = x2*x2;           // x^2
-        const float x0 = x1*x2;           // x^3
-        float y0, y1, y2, y3;
-
-        assert(fract < 1.0);
+        const float *y = coeffTable + 4 * phaseIndex(iFract);
 
-        y0 =  _coeffs[0] * x0 +  _coeffs[1] * x1 +  _coeffs[2] * x2 +  _coeffs[3] * x3;
-        y1 =  _coeffs[4] * x0 +  _coeffs[5] * x1 +  _coeffs[6] * x2 +  _coeffs[7] * x3;
-        y2 =  _coeffs[8] * x0 +  _coeffs[9] * x1 + _coeffs[10] * x2 + _coeffs[11] * x3;
-        y3 = _coeffs[12] * x0 + _coeffs[13] * x1 + _coeffs[14] * x2 + _coeffs[15] * x3;
+        assert(iFract <= FRACT_MASK);
 
-        out = y0 * psrc[0] + y1 * psrc[1] + y2 * psrc[2] + y3 * psrc[3];
+        out = y[0] * psrc[0] + y[1] * psrc[1] + y[2] * psrc[2] + y[3] * psrc[3];
 
         pdest[i] = (SAMPLETYPE)out;
         i ++;
 
         // update position fraction
-        fract += rate;
+        iFract += iRate;
         // update whole positions
-        int whole = (int)fract;
-        fract -= whole;
+        int whole = (int)(iFract >> FRACT_BITS);
+        iFract &= FRACT_MASK;
         psrc += whole;
         srcCount += whole;
     }
@@ -114,32 +153,23 @@ int InterpolateCubic::transposeStereo(SAMPLETYPE *pdest,
     i = 0;
     while (srcCount < srcSampleEnd)
     {
-        const float x3 = 1.0f;
-        const float x2 = (float)fract;    // x
-        const float x1 = x2*x2;           // x^2
-        const float x0 = x1*x2;           // x^3
-        float y0, y1, y2, y3;
         float out0, out1;
+        const float *y = coeffTable + 4 * phaseIndex(iFract);
 
-        assert(fract < 1.0);
+        assert(iFract <= FRACT_MASK);
 
-        y0 =  _coeffs[0] * x0 +  _coeffs[1] * x1 +  _coeffs[2] * x2 +  _coeffs[3] * x3;
-        y1 =  _coeffs[4] * x0 +  _coeffs[5] * x1 +  _coeffs[6] * x2 +  _coeffs[7] * x3;
-        y2 =  _coeffs[8] * x0 +  _coeffs[9] * x1 + _coeffs[10] * x2 + _coeffs[11] * x3;
-        y3 = _coeffs[12] * x0 + _coeffs[13] * x1 + _coeffs[14] * x2 + _coeffs[15] * x3;
-
-        out0 = y0 * psrc[0] + y1 * psrc[2] + y2 * psrc[4] + y3 * psrc[6];
-        out1 = y0 * psrc[1] + y1 * psrc[3] + y2 * psrc[5] + y3 * psrc[7];
+        out0 = y[0] * psrc[0] + y[1] * psrc[2] + y[2] * psrc[4] + y[3] * psrc[6];
+        out1 = y[0] * psrc[1] + y[1] * psrc[3] + y[2] * psrc[5] + y[3] * psrc[7];
 
         pdest[2*i]   = (SAMPLETYPE)out0;
         pdest[2*i+1] = (SAMPLETYPE)out1;
         i ++;
 
         // update position fraction
-        fract += rate;
+        iFract += iRate;
         // update whole positions
-        int whole = (int)fract;
-        fract -= whole;
+        int whole = (int)(iFract >> FRACT_BITS);
+        iFract &= FRACT_MASK;
         psrc += 2*whole;
         srcCount += whole;
     }
@@ -161,33 +191,24 @@ int InterpolateCubic::transposeMulti(SAMPLETYPE *pdest,
     i = 0;
     while (srcCount < srcSampleEnd)
     {
-        const float x3 = 1.0f;
-        const float x2 = (float)fract;    // x
-        const float x1 = x2*x2;           // x^2
-        const float x0 = x1*x2;           // x^3
-        float y0, y1, y2, y3;
-
-        assert(fract < 1.0);
+        const float *y = coeffTable + 4 * phaseIndex(iFract);
 
-        y0 =  _coeffs[0] * x0 +  _coeffs[1] * x1 +  _coeffs[2] * x2 +  _coeffs[3] * x3;
-        y1 =  _coeffs[4] * x0 +  _coeffs[5] * x1 +  _coeffs[6] * x2 +  _coeffs[7] * x3;
-        y2 =  _coeffs[8] * x0 +  _coeffs[9] * x1 + _coeffs[10] * x2 + _coeffs[11] * x3;
-        y3 = _coeffs[12] * x0 + _coeffs[13] * x1 + _coeffs[14] * x2 + _coeffs[15] * x3;
+        assert(iFract <= FRACT_MASK);
 
         for (int c = 0; c < numChannels; c ++)
         {
             float out;
-            out = y0 * psrc[c] + y1 * psrc[c + numChannels] + y2 * psrc[c + 2 * numChannels] + y3 * psrc[c + 3 * numChannels];
+            out = y[0] * psrc[c] + y[1] * psrc[c + numChannels] + y[2] * psrc[c + 2 * numChannels] + y[3] * psrc[c + 3 * numChannels];
             pdest[0] = (SAMPLETYPE)out;
             pdest ++;
         }
         i ++;
 
         // update position fraction
-        fract += rate;
+        iFract += iRate;
         // update whole positions
-        int whole = (int)fract;
-        fract -= whole;
+        int whole = (int)(iFract >> FRACT_BITS);
+        iFract &= FRACT_MASK;
         psrc += numChannels*whole;
         srcCount += whole;
     }
@@ -38,6 +38,8 @@
 namespace soundtouch
 {
 
+/// Cubic interpolation transposer. Interpolation weights are read from a
+/// precomputed polyphase table that is indexed by a fixed-point read position.
 class InterpolateCubic : public TransposerBase
 {
 protected:
@@ -51,19 +53,51 @@ protected:
                         const SAMPLETYPE *src,
                         int &srcSamples) override;
 
-    double fract;
+    /// Fractional read position and rate step in FRACT_BITS fixed-point format
+    uint iFract;
+    uint iRate;
+
+    /// Polyphase table of (PHASES + 1) rows with 4 weights each. The table is
+    /// shared by all instances and aligned to 16-byte boundary.
+    const float *coeffTable;
+
+    static const float *getCoeffTable();
 
 public:
     InterpolateCubic();
 
+    virtual void setRate(double newRate) override;
+
     virtual void resetRegisters() override;
 
     virtual int getLatency() const override
     {
         return 1;
     }
+
+    virtual int getHistoryLength() const override
+    {
+        return 4;
+    }
 };
 
+
+#ifdef SOUNDTOUCH_ALLOW_SSE
+    /// Class that implements SSE optimized cubic interpolation. Evaluates four
+    /// output samples per loop round.
+    class InterpolateCubicSSE : public InterpolateCubic
+    {
+    protected:
+        virtual int transposeMono(SAMPLETYPE *dest,
+                            const SAMPLETYPE *src,
+                            int &srcSamples) override;
+        virtual int transposeStereo(SAMPLETYPE *dest,
+                            const SAMPLETYPE *src,
+                            int &srcSamples) override;
+    };
+
+#endif /// SOUNDTOUCH_ALLOW_SSE
+
 }
 
 #endif
@@ -173,6 +173,12 @@ void InterpolateLinearInteger::setRate(double newRate)
 }
 
 
+int InterpolateLinearInteger::getSourcePosition(int n) const
+{
+    return (int)(((long long)n * iRate) / SCALE);
+}
+
+
 //////////////////////////////////////////////////////////////////////////////
 //
 // InterpolateLinearFloat - floating point arithmetic implementation
@@ -196,6 +202,12 @@ void InterpolateLinearFloat::resetRegisters()
 }
 
 
+int InterpolateLinearFloat::getSourcePosition(int n) const
+{
+    return (int)(n * rate);
+}
+
+
 // Transposes the sample rate of the given samples using linear interpolation.
 // 'Mono' version of the routine. Returns the number of samples returned in
 // the "dest" buffer
@@ -65,6 +65,13 @@ public:
     {
         return 0;
     }
+
+    virtual int getHistoryLength() const override
+    {
+        return 1;
+    }
+
+    virtual int getSourcePosition(int n) const override;
 };
 
 
@@ -91,8 +98,45 @@ public:
     {
         return 0;
     }
+
+    int getHistoryLength() const
+    {
+        return 1;
+    }
+
+    int getSourcePosition(int n) const;
 };
 
+
+#ifdef SOUNDTOUCH_ALLOW_SSE
+    /// Class that implements SSE optimized linear interpolation. Uses fixed-point
+    /// read position and evaluates four output samples per loop round.
+    class InterpolateLinearSSE : public InterpolateLinearFloat
+    {
+    protected:
+        /// Fractional read position and rate step in FRACT_BITS fixed-point format
+        uint iFract;
+        uint iRate;
+
+        virtual int transposeMono(SAMPLETYPE *dest,
+                           const SAMPLETYPE *src,
+                           int &srcSamples) override;
+        virtual int transposeStereo(SAMPLETYPE *dest,
+                             const SAMPLETYPE *src,
+                             int &srcSamples) override;
+
+    public:
+        InterpolateLinearSSE();
+
+        virtual void setRate(double newRate) override;
+
+        virtual void resetRegisters() override;
+
+        virtual int getSourcePosition(int n) const override;
+    };
+
+#endif /// SOUNDTOUCH_ALLOW_SSE
+
 }
 
 #endif
@@ -0,0 +1,308 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+/// Sample rate transposer using polyphase windowed-sinc interpolation. The
+/// interpolation filter is band-limited according to the transposing rate, so
+/// that this transposer does anti-alias filtering and rate conversion in a
+/// single pass, and evaluates the filter only for the produced output samples.
+///
+/// Author        : Copyright (c) Olli Parviainen
+/// Author e-mail : oparviai 'at' iki.fi
+/// SoundTouch WWW: http://www.surina.net/soundtouch
+///
+////////////////////////////////////////////////////////////////////////////////
+//
+// License :
+//
+//  SoundTouch audio processing library
+//  Copyright (c) Olli Parviainen
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Lesser General Public
+//  License as published by the Free Software Foundation; either
+//  version 2.1 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this library; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <math.h>
+#include <atomic>
+#include "InterpolatePolyphase.h"
+#include "STTypes.h"
+
+using namespace soundtouch;
+
+#define PI       3.14159265358979323846
+#define TWOPI    (2 * PI)
+
+// Filter cutoff frequency relative to the lower one of the input & output nyquist
+// frequencies. Leaves some room for the filter transition band.
+#define CUTOFF_SCALE            0.9
+
+// Resolution of the cutoff frequency in the table cache, as fraction of sampling
+// frequency. Rates with cutoff frequencies closer than this share the same table.
+#define CUTOFF_RESOLUTION       8192
+
+namespace
+{
+    /// Entry of the process-wide filter table cache. Entries are immutable once
+    /// added to the cache and live until the program exits.
+    struct PolyphaseTableEntry
+    {
+        int cutoffKey;
+        float *memory;
+        const float *taps;
+        const PolyphaseTableEntry *next;
+    };
+
+    // Linked list of cached tables, there's only a table per distinct pitch setting.
+    // Lookups are lock-free, and new entries get prepended with compare-and-swap.
+    std::atomic<const PolyphaseTableEntry*> _tableCache;
+
+
+    const PolyphaseTableEntry *findTable(const PolyphaseTableEntry *entry, int cutoffKey)
+    {
+        for (; entry != nullptr; entry = entry->next)
+        {
+            if (entry->cutoffKey == cutoffKey) return entry;
+        }
+        return nullptr;
+    }
+
+
+    // Designs windowed-sinc filter phases for given cutoff frequency, scaled to
+    // sampling frequency (nyquist frequency = 0.5)
+    void designTable(float *taps, double cutoffFreq)
+    {
+        const int TAPS = InterpolatePolyphase::TAPS;
+        const int PHASES = InterpolatePolyphase::TABLE_PHASES;
+        const double wc = 2.0 * PI * cutoffFreq;
+
+        for (int p = 0; p <= PHASES; p ++)
+        {
+            const double fract = (double)p / (double)PHASES;
+            float *row = taps + TAPS * p;
+            double sum = 0;
+            double work[TAPS];
+
+            for (int k = 0; k < TAPS; k ++)
+            {
+                // distance of tap from the interpolated position
+                const double t = (double)(k - (TAPS / 2 - 1)) - fract;
+                const double temp = t * wc;
+                const double h = (temp != 0) ? sin(temp) / temp : 1.0;     // sinc function
+                // blackman window, spans TAPS samples around the interpolated position
+                const double w = 0.42 + 0.5 * cos(TWOPI * t / TAPS) + 0.08 * cos(2 * TWOPI * t / TAPS);
+
+                work[k] = h * w;
+                sum += work[k];
+            }
+
+            // normalize each phase to unity gain
+            assert(sum > 0);
+            for (int k = 0; k < TAPS; k ++)
+            {
+                row[k] = (float)(work[k] / sum);
+            }
+        }
+    }
+}
+
+
+InterpolatePolyphase::InterpolatePolyphase()
+{
+    iFract = 0;
+    iRate = fixedRate(1.0);
+    taps = getTable(1.0);
+}
+
+
+void InterpolatePolyphase::resetRegisters()
+{
+    iFract = 0;
+}
+
+
+void InterpolatePolyphase::setRate(double newRate)
+{
+    TransposerBase::setRate(newRate);
+    iRate = fixedRate(newRate);
+    taps = getTable(newRate);
+}
+
+
+// Returns filter table for given rate from the process-wide table cache. Designs
+// the table and adds it to the cache if not yet there.
+const float *InterpolatePolyphase::getTable(double rate)
+{
+    // cut off at the lower one of input & output nyquist frequencies
+    const double cutoff = CUTOFF_SCALE * ((rate > 1.0) ? 0.5 / rate : 0.5);
+    const int cutoffKey = (int)(cutoff * CUTOFF_RESOLUTION + 0.5);
+
+    const PolyphaseTableEntry *head = _tableCache.load(std::memory_order_acquire);
+    const PolyphaseTableEntry *found = findTable(head, cutoffKey);
+    if (found) return found->taps;
+
+    // not cached yet, design the table for the quantized cutoff frequency
+    PolyphaseTableEntry *entry = new PolyphaseTableEntry;
+    float *taps;
+
+    entry->cutoffKey = cutoffKey;
+    entry->memory = new float[TAPS * (TABLE_PHASES + 1) + 4];
+    taps = (float *)SOUNDTOUCH_ALIGN_POINTER_16(entry->memory);
+    designTable(taps, (double)cutoffKey / CUTOFF_RESOLUTION);
+    entry->taps = taps;
+    entry->next = head;
+
+    while (!_tableCache.compare_exchange_weak(entry->next, entry, std::memory_order_acq_rel, std::memory_order_acquire))
+    {
+        // another thread modified the cache meanwhile, check if it added the same table
+        found = findTable(entry->next, cutoffKey);
+        if (found)
+        {
+            delete[] entry->memory;
+            delete entry;
+            return found->taps;
+        }
+    }
+    return entry->taps;
+}
+
+
+/// Transpose mono audio. Returns number of produced output samples, and
+/// updates "srcSamples" to amount of consumed source samples
+int InterpolatePolyphase::transposeMono(SAMPLETYPE *pdest,
+                    const SAMPLETYPE *psrc,
+                    int &srcSamples)
+{
+    int i;
+    int srcSampleEnd = srcSamples - TAPS;
+    int srcCount = 0;
+
+    i = 0;
+    while (srcCount < srcSampleEnd)
+    {
+        const float *w = taps + TAPS * tablePhase(iFract);
+        // use separate partial sums for 8 successive taps, this allows compiler to
+        // autovectorize the loop without reordering the float additions
+        float sum[8] = { 0 };
+
+        assert(iFract <= FRACT_MASK);
+
+        for (int k = 0; k < TAPS; k += 8)
+        {
+            for (int j = 0; j < 8; j ++)
+            {
+                sum[j] += psrc[k + j] * w[k + j];
+            }
+        }
+
+        pdest[i] = (SAMPLETYPE)(((sum[0] + sum[4]) + (sum[1] + sum[5])) + ((sum[2] + sum[6]) + (sum[3] + sum[7])));
+        i ++;
+
+        // update position fraction
+        iFract += iRate;
+        // update whole positions
+        int whole = (int)(iFract >> FRACT_BITS);
+        iFract &= FRACT_MASK;
+        psrc += whole;
+        srcCount += whole;
+    }
+    srcSamples = srcCount;
+    return i;
+}
+
+
+/// Transpose stereo audio. Returns number of produced output samples, and
+/// updates "srcSamples" to amount of consumed source samples
+int InterpolatePolyphase::transposeStereo(SAMPLETYPE *pdest,
+                    const SAMPLETYPE *psrc,
+                    int &srcSamples)
+{
+    int i;
+    int srcSampleEnd = srcSamples - TAPS;
+    int srcCount = 0;
+
+    i = 0;
+    while (srcCount < srcSampleEnd)
+    {
+        const float *w = taps + TAPS * tablePhase(iFract);
+        // separate partial sums for 8 successive taps of both channels
+        float suml[8] = { 0 };
+        float sumr[8] = { 0 };
+
+        assert(iFract <= FRACT_MASK);
+
+        for (int k = 0; k < TAPS; k += 8)
+        {
+            for (int j = 0; j < 8; j ++)
+            {
+                suml[j] += psrc[2 * (k + j)] * w[k + j];
+                sumr[j] += psrc[2 * (k + j) + 1] * w[k + j];
+            }
+        }
+
+        pdest[2*i]   = (SAMPLETYPE)(((suml[0] + suml[4]) + (suml[1] + suml[5])) + ((suml[2] + suml[6]) + (suml[3] + suml[7])));
+        pdest[2*i+1] = (SAMPLETYPE)(((sumr[0] + sumr[4]) + (sumr[1] + sumr[5])) + ((sumr[2] + sumr[6]) + (sumr[3] + sumr[7])));
+        i ++;
+
+        // update position fraction
+        iFract += iRate;
+        // update whole positions
+        int whole = (int)(iFract >> FRACT_BITS);
+        iFract &= FRACT_MASK;
+        psrc += 2*whole;
+        srcCount += whole;
+    }
+    srcSamples = srcCount;
+    return i;
+}
+
+
+/// Transpose multi-channel audio. Returns number of produced output samples, and
+/// updates "srcSamples" to amount of consumed source samples
+int InterpolatePolyphase::transposeMulti(SAMPLETYPE *pdest,
+                    const SAMPLETYPE *psrc,
+                    int &srcSamples)
+{
+    int i;
+    int srcSampleEnd = srcSamples - TAPS;
+    int srcCount = 0;
+
+    i = 0;
+    while (srcCount < srcSampleEnd)
+    {
+        const float *w = taps + TAPS * tablePhase(iFract);
+
+        assert(iFract <= FRACT_MASK);
+
+        for (int c = 0; c < numChannels; c ++)
+        {
+            float sum = 0;
+            for (int k = 0; k < TAPS; k ++)
+            {
+                sum += psrc[c + k * numChannels] * w[k];
+            }
+            pdest[0] = (SAMPLETYPE)sum;
+            pdest ++;
+        }
+        i ++;
+
+        // update position fraction
+        iFract += iRate;
+        // update whole positions
+        int whole = (int)(iFract >> FRACT_BITS);
+        iFract &= FRACT_MASK;
+        psrc += numChannels*whole;
+        srcCount += whole;
+    }
+    srcSamples = srcCount;
+    return i;
+}
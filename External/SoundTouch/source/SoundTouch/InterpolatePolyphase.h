@@ -0,0 +1,114 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+/// Sample rate transposer using polyphase windowed-sinc interpolation. The
+/// interpolation filter is band-limited according to the transposing rate, so
+/// that this transposer does anti-alias filtering and rate conversion in a
+/// single pass, and evaluates the filter only for the produced output samples.
+///
+/// Author        : Copyright (c) Olli Parviainen
+/// Author e-mail : oparviai 'at' iki.fi
+/// SoundTouch WWW: http://www.surina.net/soundtouch
+///
+////////////////////////////////////////////////////////////////////////////////
+//
+// License :
+//
+//  SoundTouch audio processing library
+//  Copyright (c) Olli Parviainen
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Lesser General Public
+//  License as published by the Free Software Foundation; either
+//  version 2.1 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this library; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef _InterpolatePolyphase_H_
+#define _InterpolatePolyphase_H_
+
+#include "RateTransposer.h"
+#include "STTypes.h"
+
+namespace soundtouch
+{
+
+/// Polyphase windowed-sinc transposer. Filter taps are read from a table of
+/// precalculated filter phases, designed for the cutoff frequency of the current
+/// rate. Tables are cached process-wide and shared by all instances.
+class InterpolatePolyphase : public TransposerBase
+{
+public:
+    enum {
+        /// Number of filter taps per output sample
+        TAPS = 32,
+
+        /// Number of precalculated filter phases between two input samples
+        TABLE_PHASE_BITS = 8,
+        TABLE_PHASES = 1 << TABLE_PHASE_BITS
+    };
+
+protected:
+    int transposeMono(SAMPLETYPE *dest,
+                        const SAMPLETYPE *src,
+                        int &srcSamples) override;
+    int transposeStereo(SAMPLETYPE *dest,
+                        const SAMPLETYPE *src,
+                        int &srcSamples) override;
+    int transposeMulti(SAMPLETYPE *dest,
+                        const SAMPLETYPE *src,
+                        int &srcSamples) override;
+
+    /// Fractional read position and rate step in FRACT_BITS fixed-point format
+    uint iFract;
+    uint iRate;
+
+    /// Filter table for current rate: (TABLE_PHASES + 1) rows of TAPS taps,
+    /// aligned to 16-byte boundary
+    const float *taps;
+
+    /// Converts a fixed-point fraction to the nearest filter table row
+    static inline uint tablePhase(uint fract)
+    {
+        return (fract + (1 << (FRACT_BITS - TABLE_PHASE_BITS - 1))) >> (FRACT_BITS - TABLE_PHASE_BITS);
+    }
+
+public:
+    InterpolatePolyphase();
+
+    void setRate(double newRate) override;
+
+    void resetRegisters() override;
+
+    bool includesAAFilter() const override
+    {
+        return true;
+    }
+
+    virtual int getLatency() const override
+    {
+        return TAPS / 2 - 1;
+    }
+
+    virtual int getHistoryLength() const override
+    {
+        return TAPS;
+    }
+
+    /// Returns the filter table for the given rate from a process-wide table cache,
+    /// designing the table only if not yet cached. Tables are immutable and stay
+    /// valid until program exit.
+    static const float *getTable(double rate);
+};
+
+}
+
+#endif
@@ -83,6 +83,20 @@ public:
                      int minPos,        ///< Min allowed peak location within the vector data.
                      int maxPos         ///< Max allowed peak location within the vector data.
                      );
+
+    /// Detect the period of a periodic data vector, such as a correlation function of
+    /// voiced sound, as the distance between the largest peak hump and the nearest peak
+    /// hump next to it. All data values have to be non-negative.
+    ///
+    /// \return The period, or zero if the data has no two peaks of at least 'minLevel'
+    /// height within the allowed distance.
+    double detectPeriod(const float *data, /// Data vector to be analyzed.
+                        int minPos,         ///< Min allowed peak location within the vector data.
+                        int maxPos,         ///< Max allowed peak location within the vector data.
+                        int minPeriod,      ///< Min allowed distance between the peaks.
+                        int maxPeriod,      ///< Max allowed distance between the peaks.
+                        float minLevel      ///< Min height of the peaks.
+                        );
 };
 
 }
@@ -39,13 +39,18 @@
 #include "InterpolateLinear.h"
 #include "InterpolateCubic.h"
 #include "InterpolateShannon.h"
+#include "InterpolatePolyphase.h"
 #include "AAFilter.h"
+#include "cpu_detect.h"
 
 using namespace soundtouch;
 
-// Define default interpolation algorithm here
+// Define default interpolation algorithm of new instances here
 TransposerBase::ALGORITHM TransposerBase::algorithm = TransposerBase::CUBIC;
 
+// Number of anti-alias filter taps
+#define AA_FILTER_LENGTH    64
+
 
 // Constructor
 RateTransposer::RateTransposer() : FIFOProcessor(&outputBuffer)
@@ -59,8 +64,15 @@ RateTransposer::RateTransposer() : FIFOProcessor(&outputBuffer)
 #endif
 
     // Instantiates the anti-alias filter
-    pAAFilter = new AAFilter(64);
-    pTransposer = TransposerBase::newInstance();
+    pAAFilter = new AAFilter(AA_FILTER_LENGTH);
+    pOutputTarget = &outputBuffer;
+
+    for (int i = 0; i <= TransposerBase::POLYPHASE; i ++)
+    {
+        pTransposers[i] = nullptr;
+    }
+    algorithm = TransposerBase::getAlgorithm();
+    pTransposer = pTransposers[algorithm] = TransposerBase::newInstance(algorithm);
     clear();
 }
 
@@ -68,7 +80,10 @@ RateTransposer::RateTransposer() : FIFOProcessor(&outputBuffer)
 RateTransposer::~RateTransposer()
 {
     delete pAAFilter;
-    delete pTransposer;
+    for (int i = 0; i <= TransposerBase::POLYPHASE; i ++)
+    {
+        delete pTransposers[i];
+    }
 }
 
 
@@ -96,24 +111,75 @@ AAFilter *RateTransposer::getAAFilter()
 }
 
 
+// Returns anti-alias filter cutoff frequency for given rate
+static double aaCutoffFreq(double rate)
+{
+    if (rate > 1.0)
+    {
+        return 0.5 / rate;
+    }
+    else
+    {
+        return 0.5 * rate;
+    }
+}
+
+
 // Sets new target iRate. Normal iRate = 1.0, smaller values represent slower
 // iRate, larger faster iRates.
 void RateTransposer::setRate(double newRate)
 {
-    double fCutoff;
-
     pTransposer->setRate(newRate);
 
-    // design a new anti-alias filter
-    if (newRate > 1.0)
+    // design a new anti-alias filter, unless the transposer takes care of that
+    if (pTransposer->includesAAFilter() == false)
     {
-        fCutoff = 0.5 / newRate;
+        pAAFilter->setCutoffFreq(aaCutoffFreq(newRate));
     }
-    else
+}
+
+
+// Designs the anti-alias filter for given rate in advance into the filter cache,
+// for the current algorithm and anti-alias filter length
+void RateTransposer::prepareRate(double newRate) const
+{
+#ifndef SOUNDTOUCH_INTEGER_SAMPLES
+    if (algorithm == TransposerBase::POLYPHASE)
+    {
+        InterpolatePolyphase::getTable(newRate);
+        return;
+    }
+#endif
+    AAFilter::getCoefficients(aaCutoffFreq(newRate), pAAFilter->getLength());
+}
+
+
+// Changes the interpolation algorithm of this instance. The samples buffered
+// for the previous transposer carry on into the new one, so that the output
+// continues without a gap.
+void RateTransposer::setAlgorithm(TransposerBase::ALGORITHM a)
+{
+    assert((a >= TransposerBase::LINEAR) && (a <= TransposerBase::POLYPHASE));
+    if (a == algorithm) return;
+
+    if (pTransposers[a] == nullptr)
     {
-        fCutoff = 0.5 * newRate;
+        pTransposers[a] = TransposerBase::newInstance(a);
     }
-    pAAFilter->setCutoffFreq(fCutoff);
+
+    const double rate = pTransposer->rate;
+    pTransposers[a]->setChannels(pTransposer->numChannels);
+    pTransposer = pTransposers[a];
+    algorithm = a;
+
+    // applies the rate to the new transposer and the anti-alias filter
+    setRate(rate);
+}
+
+
+TransposerBase::ALGORITHM RateTransposer::getAlgorithm() const
+{
+    return algorithm;
 }
 
 
@@ -135,12 +201,18 @@ void RateTransposer::processSamples(const SAMPLETYPE *src, uint nSamples)
 
     // Store samples to input buffer
     inputBuffer.putSamples(src, nSamples);
+    processInput();
+}
 
-    // If anti-alias filter is turned off, simply transpose without applying
-    // the filter
-    if (bUseAAFilter == false)
+
+// Transposes the samples in the input buffer into the output target
+void RateTransposer::processInput()
+{
+    // If anti-alias filter is turned off, or the transposer filters the signal
+    // itself, simply transpose without applying the filter
+    if ((bUseAAFilter == false) || pTransposer->includesAAFilter())
     {
-        (void)pTransposer->transpose(outputBuffer, inputBuffer);
+        (void)pTransposer->transpose(*pOutputTarget, inputBuffer);
         return;
     }
 
@@ -156,7 +228,7 @@ void RateTransposer::processSamples(const SAMPLETYPE *src, uint nSamples)
         pTransposer->transpose(midBuffer, inputBuffer);
 
         // Apply the anti-alias filter for transposed samples in midBuffer
-        pAAFilter->evaluate(outputBuffer, midBuffer);
+        pAAFilter->evaluate(*pOutputTarget, midBuffer);
     }
     else
     {
@@ -168,11 +240,19 @@ void RateTransposer::processSamples(const SAMPLETYPE *src, uint nSamples)
         pAAFilter->evaluate(midBuffer, inputBuffer);
 
         // Transpose the AA-filtered samples in "midBuffer"
-        pTransposer->transpose(outputBuffer, midBuffer);
+        pTransposer->transpose(*pOutputTarget, midBuffer);
     }
 }
 
 
+// Sets the buffer where the processed samples get written, nullptr for the own
+// output buffer
+void RateTransposer::setOutputTarget(FIFOSampleBuffer *target)
+{
+    pOutputTarget = (target != nullptr) ? target : &outputBuffer;
+}
+
+
 // Sets the number of channels, 1 = mono, 2 = stereo
 void RateTransposer::setChannels(int nChannels)
 {
@@ -183,6 +263,10 @@ void RateTransposer::setChannels(int nChannels)
     inputBuffer.setChannels(nChannels);
     midBuffer.setChannels(nChannels);
     outputBuffer.setChannels(nChannels);
+
+    // redo the silence prefill, as the buffered samples got reinterpreted
+    // for the new channel count
+    clear();
 }
 
 
@@ -215,7 +299,40 @@ int RateTransposer::isEmpty() const
 int RateTransposer::getLatency() const
 {
     return pTransposer->getLatency() +
-        ((bUseAAFilter) ? (pAAFilter->getLength() / 2) : 0);
+        ((bUseAAFilter && !pTransposer->includesAAFilter()) ? pAAFilter->getDelay() : 0);
+}
+
+
+/// Return exact number of input samples needed before 'numOutput' samples come out
+int RateTransposer::getInputLatency(int numOutput) const
+{
+    int required;
+
+    if (numOutput <= 0) return 0;
+
+    const bool useAAFilter = bUseAAFilter && !pTransposer->includesAAFilter();
+    const uint channels = (uint)pTransposer->numChannels;
+    const double rate = pTransposer->rate;
+
+    if (useAAFilter && (rate < 1.0f))
+    {
+        // the anti-alias filter is applied to the transposed samples
+        numOutput = (int)pAAFilter->getInputLength((uint)numOutput, channels);
+    }
+
+    // the interpolator outputs sample 'n' once the source extends its history
+    // past position n * rate
+    required = pTransposer->getHistoryLength() + pTransposer->getSourcePosition(numOutput - 1) + 1;
+
+    if (useAAFilter && (rate >= 1.0f))
+    {
+        // the anti-alias filter is applied before transposing
+        required = (int)pAAFilter->getInputLength((uint)required, channels);
+    }
+
+    // 'clear' prefills the input buffer with silence
+    required -= getLatency();
+    return (required > 0) ? required : 0;
 }
 
 
@@ -224,13 +341,20 @@ int RateTransposer::getLatency() const
 // TransposerBase - Base class for interpolation
 //
 
-// static function to set interpolation algorithm
+// static function to set the default interpolation algorithm of new instances
 void TransposerBase::setAlgorithm(TransposerBase::ALGORITHM a)
 {
     TransposerBase::algorithm = a;
 }
 
 
+// static function to get the default interpolation algorithm
+TransposerBase::ALGORITHM TransposerBase::getAlgorithm()
+{
+    return TransposerBase::algorithm;
+}
+
+
 // Transposes the sample rate of the given samples using linear interpolation.
 // Returns the number of samples returned in the "dest" buffer
 int TransposerBase::transpose(FIFOSampleBuffer &dest, FIFOSampleBuffer &src)
@@ -287,24 +411,55 @@ void TransposerBase::setRate(double newRate)
 }
 
 
-// static factory function
+int TransposerBase::getSourcePosition(int n) const
+{
+    return (int)(((unsigned long long)n * fixedRate(rate)) >> FRACT_BITS);
+}
+
+
+// static factory function for the default algorithm
 TransposerBase *TransposerBase::newInstance()
+{
+    return newInstance(algorithm);
+}
+
+
+// static factory function for the given algorithm
+TransposerBase *TransposerBase::newInstance(ALGORITHM a)
 {
 #ifdef SOUNDTOUCH_INTEGER_SAMPLES
     // Notice: For integer arithmetic support only linear algorithm (due to simplest calculus)
+    (void)a;
     return ::new InterpolateLinearInteger;
 #else
-    switch (algorithm)
+    uint uExtensions;
+
+    uExtensions = detectCPUextensions();
+    (void)uExtensions;
+
+    switch (a)
     {
         case LINEAR:
+#ifdef SOUNDTOUCH_ALLOW_SSE
+            if (uExtensions & SUPPORT_SSE) return new InterpolateLinearSSE;
+#endif // SOUNDTOUCH_ALLOW_SSE
             return new InterpolateLinearFloat;
 
         case CUBIC:
+#ifdef SOUNDTOUCH_ALLOW_SSE
+            if (uExtensions & SUPPORT_SSE) return new InterpolateCubicSSE;
+#endif // SOUNDTOUCH_ALLOW_SSE
             return new InterpolateCubic;
 
         case SHANNON:
+#ifdef SOUNDTOUCH_ALLOW_SSE
+            if (uExtensions & SUPPORT_SSE) return new InterpolateShannonSSE;
+#endif // SOUNDTOUCH_ALLOW_SSE
             return new InterpolateShannon;
 
+        case POLYPHASE:
+            return new InterpolatePolyphase;
+
         default:
             assert(false);
             return nullptr;
@@ -96,6 +96,7 @@ SoundTouch::SoundTouch()
     setOutPipe(pTDStretch);
 
     rate = tempo = 0;
+    bFusedPipeline = false;
 
     virtualPitch =
     virtualRate =
@@ -213,6 +214,14 @@ void SoundTouch::setPitchSemiTones(double newPitch)
 }
 
 
+// Designs the anti-alias filter for given pitch change in semi-tones in advance
+// into the process-wide filter cache, assuming normal rate & tempo
+void SoundTouch::preparePitchSemiTones(double newPitch) const
+{
+    pRateTransposer->prepareRate(exp(0.69314718056 * (newPitch / 12.0)));
+}
+
+
 // Calculates 'effective' rate and tempo values from the
 // nominal control values.
 void SoundTouch::calcEffectiveRateAndTempo()
@@ -254,12 +263,49 @@ void SoundTouch::calcEffectiveRateAndTempo()
             // move samples in the current output buffer to the output of pRateTransposer
             transOut = pRateTransposer->getOutput();
             transOut->moveSamples(*output);
-            // move samples in tempo changer's input to pitch transposer's input
-            pRateTransposer->moveSamples(*pTDStretch->getInput());
 
+            // reconnect the stages before feeding the transposer, which now is the last one
             output = pRateTransposer;
+            updateStageTargets();
+
+            // move samples in tempo changer's input to pitch transposer's input
+            pRateTransposer->moveSamples(*pTDStretch->getInput());
         }
     }
+
+    updateStageTargets();
+}
+
+
+// Connects the first processing stage's output to the second stage's input in the
+// fused pipeline mode. Both stages process their whole input on each call, so the
+// own output buffer of the first stage is empty when the connection changes.
+void SoundTouch::updateStageTargets()
+{
+    if (bFusedPipeline == false)
+    {
+        pRateTransposer->setOutputTarget(nullptr);
+        pTDStretch->setOutputTarget(nullptr);
+    }
+    else if (output == pTDStretch)
+    {
+        // rate transposer first, then tempo changer
+        pRateTransposer->setOutputTarget(pTDStretch->getInputBuffer());
+        pTDStretch->setOutputTarget(nullptr);
+    }
+    else
+    {
+        // tempo changer first, then rate transposer
+        pTDStretch->setOutputTarget(pRateTransposer->getInputBuffer());
+        pRateTransposer->setOutputTarget(nullptr);
+    }
+}
+
+
+// Returns the input buffer of the first processing stage
+FIFOSampleBuffer *SoundTouch::getInputBuffer()
+{
+    return (output == pTDStretch) ? pRateTransposer->getInputBuffer() : pTDStretch->getInputBuffer();
 }
 
 
@@ -285,6 +331,41 @@ void SoundTouch::putSamples(const SAMPLETYPE *samples, uint nSamples)
         ST_THROW_RT_ERROR("SoundTouch : Number of channels not defined");
     }
 
+    getInputBuffer()->putSamples(samples, nSamples);
+    processInput(nSamples);
+}
+
+
+// Returns a pointer for writing samples directly into the input of the object
+SAMPLETYPE *SoundTouch::ptrEnd(uint slackCapacity)
+{
+    return getInputBuffer()->ptrEnd(slackCapacity);
+}
+
+
+// Processes 'numSamples' samples written to the address returned by 'ptrEnd'
+void SoundTouch::putSamples(uint nSamples)
+{
+    if (bSrateSet == false)
+    {
+        ST_THROW_RT_ERROR("SoundTouch : Sample rate not defined");
+    }
+    else if (channels == 0)
+    {
+        ST_THROW_RT_ERROR("SoundTouch : Number of channels not defined");
+    }
+
+    getInputBuffer()->putSamples(nSamples);
+    processInput(nSamples);
+}
+
+
+// Runs the processing stages for 'nSamples' new samples in the input buffer of
+// the first stage
+void SoundTouch::processInput(uint nSamples)
+{
+    if (nSamples == 0) return;
+
     // accumulate how many samples are expected out from processing, given the current
     // processing setting
     samplesExpectedOut += (double)nSamples / ((double)rate * (double)tempo);
@@ -294,20 +375,43 @@ void SoundTouch::putSamples(const SAMPLETYPE *samples, uint nSamples)
     {
         // transpose the rate down, output the transposed sound to tempo changer buffer
         assert(output == pTDStretch);
-        pRateTransposer->putSamples(samples, nSamples);
-        pTDStretch->moveSamples(*pRateTransposer);
+        pRateTransposer->processInput();
+        if (bFusedPipeline)
+        {
+            // the transposer wrote directly into the tempo changer's input
+            pTDStretch->processInput();
+        }
+        else
+        {
+            pTDStretch->moveSamples(*pRateTransposer);
+        }
     }
     else
 #endif
     {
         // evaluate the tempo changer, then transpose the rate up,
         assert(output == pRateTransposer);
-        pTDStretch->putSamples(samples, nSamples);
-        pRateTransposer->moveSamples(*pTDStretch);
+        pTDStretch->processInput();
+        if (bFusedPipeline)
+        {
+            // the tempo changer wrote directly into the transposer's input
+            pRateTransposer->processInput();
+        }
+        else
+        {
+            pRateTransposer->moveSamples(*pTDStretch);
+        }
     }
 }
 
 
+// Returns a pointer to the beginning of the ready output samples
+SAMPLETYPE *SoundTouch::ptrBegin()
+{
+    return FIFOProcessor::ptrBegin();
+}
+
+
 // Flushes the last samples from the processing pipeline to the output.
 // Clears also the internal processing buffers.
 //
@@ -367,9 +471,22 @@ bool SoundTouch::setSetting(int settingId, int value)
             pRateTransposer->getAAFilter()->setLength(value);
             return true;
 
+        case SETTING_AA_FILTER_DELAY_LENGTH :
+            // sets anti-alias filter length whose delay is kept for shorter filters
+            pRateTransposer->getAAFilter()->setDelayLength(value);
+            return true;
+
         case SETTING_USE_QUICKSEEK :
-            // enables / disables tempo routine quick seeking algorithm
-            pTDStretch->enableQuickSeek((value != 0) ? true : false);
+            // selects tempo routine seeking algorithm: 0 = full, 1 = quick, 2 = hierarchical,
+            // 3 = pitch guided
+            if ((value == TDStretch::SEEK_HIERARCHICAL) || (value == TDStretch::SEEK_PITCH_GUIDED))
+            {
+                pTDStretch->setSeekMode((TDStretch::SEEKMODE)value);
+            }
+            else
+            {
+                pTDStretch->enableQuickSeek((value != 0) ? true : false);
+            }
             return true;
 
         case SETTING_SEQUENCE_MS:
@@ -387,6 +504,47 @@ bool SoundTouch::setSetting(int settingId, int value)
             pTDStretch->setParameters(sampleRate, sequenceMs, seekWindowMs, value);
             return true;
 
+        case SETTING_SPEECH_PROFILE:
+            // enables / disables speech processing profile
+            pTDStretch->enableSpeechProfile((value != 0) ? true : false);
+            return true;
+
+        case SETTING_SPEECH_MIN_F0:
+            // change speech profile voice fundamental frequency range
+            pTDStretch->setSpeechParameters(value, -1, -1);
+            return true;
+
+        case SETTING_SPEECH_MAX_F0:
+            pTDStretch->setSpeechParameters(-1, value, -1);
+            return true;
+
+        case SETTING_SPEECH_LATENCY_MS:
+            // change speech profile latency budget
+            pTDStretch->setSpeechParameters(-1, -1, value);
+            return true;
+
+        case SETTING_OVERLAP_WINDOW:
+            // selects the tempo routine crossfade shape
+            pTDStretch->enableRaisedCosineOverlap((value != 0) ? true : false);
+            return true;
+
+        case SETTING_PARALLEL_SEEK:
+            // enables / disables the parallel full seek of the tempo routine
+            pTDStretch->enableParallelSeek((value != 0) ? true : false);
+            return true;
+
+        case SETTING_FUSED_PIPELINE:
+            // enables / disables direct connection of the processing stages
+            bFusedPipeline = (value != 0) ? true : false;
+            updateStageTargets();
+            return true;
+
+        case SETTING_TRANSPOSER_ALGORITHM:
+            // change interpolation algorithm of this instance
+            if ((value < TransposerBase::LINEAR) || (value > TransposerBase::POLYPHASE)) return false;
+            pRateTransposer->setAlgorithm((TransposerBase::ALGORITHM)value);
+            return true;
+
         default :
             return false;
     }
@@ -409,8 +567,11 @@ int SoundTouch::getSetting(int settingId) const
         case SETTING_AA_FILTER_LENGTH :
             return pRateTransposer->getAAFilter()->getLength();
 
+        case SETTING_AA_FILTER_DELAY_LENGTH :
+            return pRateTransposer->getAAFilter()->getDelayLength();
+
         case SETTING_USE_QUICKSEEK :
-            return (uint)pTDStretch->isQuickSeekEnabled();
+            return (int)pTDStretch->getSeekMode();
 
         case SETTING_SEQUENCE_MS:
             pTDStretch->getParameters(nullptr, &temp, nullptr, nullptr);
@@ -424,6 +585,33 @@ int SoundTouch::getSetting(int settingId) const
             pTDStretch->getParameters(nullptr, nullptr, nullptr, &temp);
             return temp;
 
+        case SETTING_SPEECH_PROFILE:
+            return (uint)pTDStretch->isSpeechProfileEnabled();
+
+        case SETTING_SPEECH_MIN_F0:
+            pTDStretch->getSpeechParameters(&temp, nullptr, nullptr);
+            return temp;
+
+        case SETTING_SPEECH_MAX_F0:
+            pTDStretch->getSpeechParameters(nullptr, &temp, nullptr);
+            return temp;
+
+        case SETTING_SPEECH_LATENCY_MS:
+            pTDStretch->getSpeechParameters(nullptr, nullptr, &temp);
+            return temp;
+
+        case SETTING_TRANSPOSER_ALGORITHM:
+            return (int)pRateTransposer->getAlgorithm();
+
+        case SETTING_FUSED_PIPELINE:
+            return (uint)bFusedPipeline;
+
+        case SETTING_OVERLAP_WINDOW:
+            return (uint)pTDStretch->isRaisedCosineOverlapEnabled();
+
+        case SETTING_PARALLEL_SEEK:
+            return (uint)pTDStretch->isParallelSeekEnabled();
+
         case SETTING_NOMINAL_INPUT_SEQUENCE :
         {
             int size = pTDStretch->getInputSampleReq();
@@ -536,3 +724,35 @@ double SoundTouch::getInputOutputSampleRatio()
 {
     return 1.0 / (tempo * rate);
 }
+
+
+/// Get exact number of input samples needed before the first processed sample comes out
+int SoundTouch::getInputLatency() const
+{
+#ifndef SOUNDTOUCH_PREVENT_CLICK_AT_RATE_CROSSOVER
+    if (rate <= 1.0f)
+    {
+        // rate transposer feeds the tempo changer
+        return pRateTransposer->getInputLatency(pTDStretch->getInputLatency(1));
+    }
+    else
+#endif
+    {
+        // tempo changer feeds the rate transposer
+        return pTDStretch->getInputLatency(pRateTransposer->getInputLatency(1));
+    }
+}
+
+
+/// Get real-time latency in output samples
+int SoundTouch::getOutputLatency() const
+{
+    int inputLatency = getInputLatency();
+
+    if (inputLatency == 0) return 0;
+
+    // the output runs dry at worst just before the first processed sample comes out.
+    // Allow for rounding error as rate * tempo is often nominally 1.0
+    double latency = (double)(inputLatency - 1) / ((double)rate * (double)tempo);
+    return (int)ceil(latency - 1e-6);
+}
@@ -97,11 +97,33 @@ namespace soundtouch
 /// Increasing this value increases computational burden & vice versa.
 #define DEFAULT_OVERLAP_MS      8
 
+/// Default voice fundamental frequency range in Hz for the speech processing
+/// profile, see TDStretch::enableSpeechProfile. Covers adult male and female
+/// speaking voices.
+#define DEFAULT_SPEECH_MIN_F0       75
+#define DEFAULT_SPEECH_MAX_F0       400
+
+/// Default latency budget of the speech processing profile in milliseconds
+#define DEFAULT_SPEECH_LATENCY_MS   40
+
 
 /// Class that does the time-stretch (tempo change) effect for the processed
 /// sound.
 class TDStretch : public FIFOProcessor
 {
+public:
+    /// Algorithms for seeking the best overlap position, see 'setSeekMode'
+    enum SEEKMODE
+    {
+        SEEK_FULL = 0,          ///< Tests every position of the seek window
+        SEEK_QUICK = 1,         ///< Tests every 16th position, then refines around the two best ones
+        SEEK_HIERARCHICAL = 2,  ///< Tests every position of decimated signals, then refines
+                                ///< around the two best ones at full resolution
+        SEEK_PITCH_GUIDED = 3   ///< For voiced sound tests only the surroundings of positions
+                                ///< aligned to the tracked pitch period, otherwise as
+                                ///< SEEK_HIERARCHICAL
+    };
+
 protected:
     int channels;
     int sampleReq;
@@ -124,18 +146,48 @@ protected:
     double nominalSkip;
     double skipFract;
 
-    bool bQuickSeek;
+    SEEKMODE seekMode;
+    bool bParallelSeek;
+    bool bRaisedCosineOverlap;
     bool bAutoSeqSetting;
     bool bAutoSeekSetting;
+    bool bSpeechProfile;
     bool isBeginning;
 
+    int speechMinF0;
+    int speechMaxF0;
+    int speechLatencyMs;
+
     SAMPLETYPE *pMidBuffer;
     SAMPLETYPE *pMidBufferUnaligned;
 
+    /// Crossfade weights of the overlap: 'overlapLength' fade-in weights for the
+    /// new sequence, followed by as many fade-out weights for 'pMidBuffer'. With
+    /// integer samples the weights are scaled to 'overlapLength'.
+    SAMPLETYPE *pOverlapWindow;
+    SAMPLETYPE *pOverlapWindowUnaligned;
+
+    /// Work buffer of the hierarchical seek for the decimated overlap reference,
+    /// the decimated seek range and their correlations
+    float *pCoarseBuffer;
+    int coarseBufferSize;
+
+    /// Pitch period of voiced sound tracked by the pitch guided seek in samples,
+    /// zero when unknown or unvoiced
+    double pitchPeriod;
+
+    /// Position of 'pMidBuffer' in the input relative to the next seek range
+    int midBufferPos;
+
     FIFOSampleBuffer outputBuffer;
     FIFOSampleBuffer inputBuffer;
 
+    /// Buffer where the processed samples get written: 'outputBuffer', or in a
+    /// fused pipeline the input buffer of the next processing stage
+    FIFOSampleBuffer *pOutputTarget;
+
     void acceptNewOverlapLength(int newOverlapLength);
+    void calcOverlapWindow();
 
     virtual void clearCrossCorrState();
     void calculateOverlapLength(int overlapMs);
@@ -145,6 +197,12 @@ protected:
 
     virtual int seekBestOverlapPositionFull(const SAMPLETYPE *refPos);
     virtual int seekBestOverlapPositionQuick(const SAMPLETYPE *refPos);
+    virtual int seekBestOverlapPositionHierarchical(const SAMPLETYPE *refPos);
+    virtual int seekBestOverlapPositionPitchGuided(const SAMPLETYPE *refPos);
+    double calcNorm(const SAMPLETYPE *pos) const;
+    void seekFullRange(const SAMPLETYPE *refPos, int start, int end, double norm,
+                       double &bestCorr, int &bestOffs);
+    static void seekFullPart(void *context, int part, int numParts);
     virtual int seekBestOverlapPosition(const SAMPLETYPE *refPos);
 
     virtual void overlapStereo(SAMPLETYPE *output, const SAMPLETYPE *input) const;
@@ -155,6 +213,10 @@ protected:
     void overlap(SAMPLETYPE *output, const SAMPLETYPE *input, uint ovlPos) const;
 
     void calcSeqParameters();
+    void allocCoarseBuffer();
+    void decimate(float *dest, const SAMPLETYPE *src, int numBlocks) const;
+    void applySpeechProfile();
+    int getInitialSkip() const;
     void adaptNormalizer();
 
     /// Changes the tempo of the given sound samples.
@@ -182,6 +244,19 @@ public:
     /// Returns the input buffer object
     FIFOSamplePipe *getInput() { return &inputBuffer; };
 
+    /// Returns the input buffer, for a previous stage that writes its output
+    /// directly into it
+    FIFOSampleBuffer *getInputBuffer() { return &inputBuffer; };
+
+    /// Makes the processed samples get written directly into the given buffer,
+    /// e.g. the input buffer of the next processing stage, instead of this
+    /// object's own output buffer. nullptr restores the own output buffer.
+    void setOutputTarget(FIFOSampleBuffer *target);
+
+    /// Processes the samples that a previous stage has written directly into
+    /// the input buffer
+    void processInput();
+
     /// Sets new target tempo. Normal tempo = 'SCALE', smaller values represent slower
     /// tempo, larger faster tempo.
     void setTempo(double newTempo);
@@ -202,6 +277,55 @@ public:
     /// Returns nonzero if the quick seeking algorithm is enabled.
     bool isQuickSeekEnabled() const;
 
+    /// Selects the overlap position seeking algorithm. The hierarchical seek costs
+    /// less CPU than the quick seek and matches nearly as well as the full seek.
+    void setSeekMode(SEEKMODE mode);
+
+    /// Returns the overlap position seeking algorithm
+    SEEKMODE getSeekMode() const;
+
+    /// Enables/disables splitting the full seek over the threads of a persistent
+    /// worker pool. Meant for offline processing: only seeks with large enough
+    /// seek windows go parallel, and only in builds with float samples.
+    ///
+    /// Don't enable this for a stretcher that runs on a real-time audio thread:
+    /// starting a job takes a mutex, and the calling thread then spin-waits with
+    /// yields for the workers, which the OS may schedule late. The result is the
+    /// same whichever threads run the parts, but can differ slightly from the
+    /// seek with this disabled.
+    void enableParallelSeek(bool enable);
+
+    /// Returns nonzero if the parallel full seek is enabled.
+    bool isParallelSeekEnabled() const;
+
+    /// Selects the crossfade shape of the overlapping sequences: linear, or
+    /// raised-cosine that changes more smoothly at the overlap ends. Costs the
+    /// same as the weights are taken from a precalculated table.
+    void enableRaisedCosineOverlap(bool enable);
+
+    /// Returns nonzero if the raised-cosine crossfade is enabled.
+    bool isRaisedCosineOverlapEnabled() const;
+
+    /// Enables/disables the speech processing profile. When enabled, the sequence,
+    /// seek window and overlap lengths are derived from the voice's fundamental
+    /// frequency range and the latency budget given with 'setSpeechParameters',
+    /// instead of the tempo dependent automatic settings that are tuned for music.
+    /// Disabling returns to the automatic settings.
+    void enableSpeechProfile(bool enable);
+
+    /// Returns nonzero if the speech processing profile is enabled.
+    bool isSpeechProfileEnabled() const;
+
+    /// Sets the speech profile parameters. Zero or negative values keep the old value.
+    void setSpeechParameters(int minF0,             ///< Lowest fundamental frequency of the voice (Hz)
+                             int maxF0,             ///< Highest fundamental frequency of the voice (Hz)
+                             int latencyBudgetMs    ///< Target latency of the processing (ms)
+                             );
+
+    /// Get speech profile parameters, see setSpeechParameters() function.
+    /// Any of the parameters to this function can be nullptr.
+    void getSpeechParameters(int *pMinF0, int *pMaxF0, int *pLatencyBudgetMs) const;
+
     /// Sets routine control parameters. These control are certain time constants
     /// defining how the sound is stretched to the desired duration.
     //
@@ -246,6 +370,11 @@ public:
 	{
 		return sampleReq;
 	}
+
+    /// Returns the exact number of input samples that have to be entered after
+    /// 'clear' before 'numOutput' samples are available in the output, following
+    /// the processing batches of the current sequence, seek window and overlap lengths.
+    int getInputLatency(int numOutput) const;
 };
 
 
@@ -271,6 +400,8 @@ public:
     protected:
         double calcCrossCorr(const float *mixingPos, const float *compare, double &norm) override;
         double calcCrossCorrAccumulate(const float *mixingPos, const float *compare, double &norm) override;
+        void overlapMono(float *output, const float *input) const override;
+        void overlapStereo(float *output, const float *input) const override;
     };
 
 #endif /// SOUNDTOUCH_ALLOW_SSE
@@ -0,0 +1,170 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+/// Persistent pool of worker threads that run the parts of a job in parallel,
+/// for the parallel overlap position seek of the tempo changer. The threads are
+/// started once and then wait for jobs, so unlike an OpenMP parallel region a
+/// job doesn't pay for forking and joining threads.
+///
+/// Author        : Copyright (c) Olli Parviainen
+/// Author e-mail : oparviai 'at' iki.fi
+/// SoundTouch WWW: http://www.surina.net/soundtouch
+///
+////////////////////////////////////////////////////////////////////////////////
+//
+// License :
+//
+//  SoundTouch audio processing library
+//  Copyright (c) Olli Parviainen
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Lesser General Public
+//  License as published by the Free Software Foundation; either
+//  version 2.1 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this library; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include "WorkerPool.h"
+
+#if defined(_WIN32)
+    #include <windows.h>
+#elif defined(__linux__)
+    #include <sched.h>
+#endif
+
+using namespace soundtouch;
+
+
+// Pins the calling thread to the given CPU core, so that the scheduler doesn't move
+// the workers around between the jobs. Platforms without thread affinity control,
+// such as Apple ones, leave the thread where the scheduler puts it.
+static void pinCurrentThread(int cpu)
+{
+#if defined(_WIN32)
+    SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << cpu);
+#elif defined(__linux__)
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    CPU_SET(cpu, &cpuSet);
+    sched_setaffinity(0, sizeof(cpuSet), &cpuSet);
+#else
+    (void)cpu;
+#endif
+}
+
+
+WorkerPool &WorkerPool::getInstance()
+{
+    // started on first use, and the threads are stopped at program exit
+    static WorkerPool pool;
+    return pool;
+}
+
+
+WorkerPool::WorkerPool()
+{
+    job = nullptr;
+    jobContext = nullptr;
+    jobCount = 0;
+    quit = false;
+    pendingParts = 0;
+    busy.clear();
+
+    // one part for each core, the calling thread included
+    int cores = (int)std::thread::hardware_concurrency();
+    numParts = (cores < 1) ? 1 : ((cores > MAX_PARTS) ? MAX_PARTS : cores);
+
+    for (int part = 1; part < numParts; part ++)
+    {
+        workers.push_back(std::thread(&WorkerPool::workerLoop, this, part));
+    }
+}
+
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        quit = true;
+    }
+    jobReady.notify_all();
+
+    for (size_t i = 0; i < workers.size(); i ++)
+    {
+        workers[i].join();
+    }
+}
+
+
+int WorkerPool::getNumParts() const
+{
+    return numParts;
+}
+
+
+// Runs the job parts in parallel, part 0 in the calling thread
+bool WorkerPool::tryRun(JobFunction func, void *context)
+{
+    if (numParts < 2) return false;
+
+    // one job at a time: another caller runs its job by itself
+    if (busy.test_and_set(std::memory_order_acquire)) return false;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        job = func;
+        jobContext = context;
+        pendingParts.store(numParts - 1, std::memory_order_relaxed);
+        jobCount ++;
+    }
+    jobReady.notify_all();
+
+    func(context, 0, numParts);
+
+    // the other parts take about as long as this one, so just spin until they're done
+    while (pendingParts.load(std::memory_order_acquire) > 0)
+    {
+        std::this_thread::yield();
+    }
+
+    busy.clear(std::memory_order_release);
+    return true;
+}
+
+
+void WorkerPool::workerLoop(int part)
+{
+    unsigned int doneCount = 0;
+
+    pinCurrentThread(part);
+
+    for (;;)
+    {
+        JobFunction func;
+        void *context;
+
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            while ((quit == false) && (jobCount == doneCount))
+            {
+                jobReady.wait(lock);
+            }
+            if (quit) return;
+
+            doneCount = jobCount;
+            func = job;
+            context = jobContext;
+        }
+
+        func(context, part, numParts);
+        pendingParts.fetch_sub(1, std::memory_order_release);
+    }
+}
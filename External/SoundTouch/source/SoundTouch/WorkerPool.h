@@ -0,0 +1,100 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+/// Persistent pool of worker threads that run the parts of a job in parallel,
+/// for the parallel overlap position seek of the tempo changer. The threads are
+/// started once and then wait for jobs, so unlike an OpenMP parallel region a
+/// job doesn't pay for forking and joining threads.
+///
+/// Author        : Copyright (c) Olli Parviainen
+/// Author e-mail : oparviai 'at' iki.fi
+/// SoundTouch WWW: http://www.surina.net/soundtouch
+///
+////////////////////////////////////////////////////////////////////////////////
+//
+// License :
+//
+//  SoundTouch audio processing library
+//  Copyright (c) Olli Parviainen
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Lesser General Public
+//  License as published by the Free Software Foundation; either
+//  version 2.1 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this library; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#ifndef _WorkerPool_H_
+#define _WorkerPool_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace soundtouch
+{
+
+/// Process-wide pool of worker threads, each pinned to its own CPU core where the
+/// platform allows that. A job is split into 'getNumParts()' parts: the calling
+/// thread runs part 0 and the workers the others. One job runs at a time.
+///
+/// Not real-time safe: 'tryRun' locks a mutex to hand out the job and then
+/// spin-waits with yields until the workers are done, so don't call it from a
+/// real-time audio thread.
+class WorkerPool
+{
+public:
+    enum {
+        /// Max number of parts a job is split into
+        MAX_PARTS = 8
+    };
+
+    /// Runs one part of a job. 'context' is the pointer given to 'tryRun'.
+    typedef void (*JobFunction)(void *context, int part, int numParts);
+
+    /// Returns the process-wide pool, starting the worker threads on first call
+    static WorkerPool &getInstance();
+
+    /// Returns the number of parts a job is split into, 1 if there are no workers
+    int getNumParts() const;
+
+    /// Runs the job parts in parallel and returns when all of them are done.
+    /// Takes a mutex and spin-waits, see above.
+    ///
+    /// \return false without running anything if the pool has no workers, or
+    /// another thread is running a job at the moment.
+    bool tryRun(JobFunction job, void *context);
+
+private:
+    WorkerPool();
+    ~WorkerPool();
+
+    void workerLoop(int part);
+
+    std::vector<std::thread> workers;
+    int numParts;
+
+    std::mutex mutex;
+    std::condition_variable jobReady;
+    JobFunction job;
+    void *jobContext;
+    unsigned int jobCount;      ///< Incremented for each job, workers wait for a change
+    bool quit;
+
+    std::atomic<int> pendingParts;
+    std::atomic_flag busy;
+};
+
+}
+
+#endif
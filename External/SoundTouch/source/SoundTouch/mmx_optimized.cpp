@@ -221,31 +221,31 @@ void TDStretchMMX::clearCrossCorrState()
 void TDStretchMMX::overlapStereo(short *output, const short *input) const
 {
     const __m64 *pVinput, *pVMidBuf;
+    const short *pFadeIn, *pFadeOut;
     __m64 *pVdest;
-    __m64 mix1, mix2, adder, shifter;
+    __m64 mix1, mix2, shifter;
     int i;
 
     pVinput  = (const __m64*)input;
     pVMidBuf = (const __m64*)pMidBuffer;
     pVdest   = (__m64*)output;
 
-    // mix1  = mixer values for 1st stereo sample
-    // mix1  = mixer values for 2nd stereo sample
-    // adder = adder for updating mixer values after each round
-
-    mix1  = _mm_set_pi16(0, overlapLength,   0, overlapLength);
-    adder = _mm_set_pi16(1, -1, 1, -1);
-    mix2  = _mm_add_pi16(mix1, adder);
-    adder = _mm_add_pi16(adder, adder);
+    // mixer values come from the precalculated crossfade weights
+    pFadeIn  = pOverlapWindow;
+    pFadeOut = pOverlapWindow + overlapLength;
 
     // Overlaplength-division by shifter. "+1" is to account for "-1" deduced in
     // overlapDividerBits calculation earlier.
     shifter = _m_from_int(overlapDividerBitsPure + 1);
 
-    for (i = 0; i < overlapLength / 4; i ++)
+    for (i = 0; i < overlapLength; i += 4)
     {
         __m64 temp1, temp2;
 
+        // mix1 = mixer values for 1st stereo sample, mix2 for 2nd stereo sample
+        mix1 = _mm_set_pi16(pFadeIn[i], pFadeOut[i], pFadeIn[i], pFadeOut[i]);
+        mix2 = _mm_set_pi16(pFadeIn[i + 1], pFadeOut[i + 1], pFadeIn[i + 1], pFadeOut[i + 1]);
+
         // load & shuffle data so that input & mixbuffer data samples are paired
         temp1 = _mm_unpacklo_pi16(pVMidBuf[0], pVinput[0]);     // = i0l m0l i0r m0r
         temp2 = _mm_unpackhi_pi16(pVMidBuf[0], pVinput[0]);     // = i1l m1l i1r m1r
@@ -255,12 +255,11 @@ void TDStretchMMX::overlapStereo(short *output, const short *input) const
         temp2 = _mm_sra_pi32(_mm_madd_pi16(temp2, mix2), shifter);
         pVdest[0] = _mm_packs_pi32(temp1, temp2); // pack 2*2*32bit => 4*16bit
 
-        // update mix += adder
-        mix1 = _mm_add_pi16(mix1, adder);
-        mix2 = _mm_add_pi16(mix2, adder);
-
         // --- second round begins here ---
 
+        mix1 = _mm_set_pi16(pFadeIn[i + 2], pFadeOut[i + 2], pFadeIn[i + 2], pFadeOut[i + 2]);
+        mix2 = _mm_set_pi16(pFadeIn[i + 3], pFadeOut[i + 3], pFadeIn[i + 3], pFadeOut[i + 3]);
+
         // load & shuffle data so that input & mixbuffer data samples are paired
         temp1 = _mm_unpacklo_pi16(pVMidBuf[1], pVinput[1]);       // = i2l m2l i2r m2r
         temp2 = _mm_unpackhi_pi16(pVMidBuf[1], pVinput[1]);       // = i3l m3l i3r m3r
@@ -270,10 +269,6 @@ void TDStretchMMX::overlapStereo(short *output, const short *input) const
         temp2 = _mm_sra_pi32(_mm_madd_pi16(temp2, mix2), shifter);
         pVdest[1] = _mm_packs_pi32(temp1, temp2); // pack 2*2*32bit => 4*16bit
 
-        // update mix += adder
-        mix1 = _mm_add_pi16(mix1, adder);
-        mix2 = _mm_add_pi16(mix2, adder);
-
         pVinput  += 2;
         pVMidBuf += 2;
         pVdest   += 2;
@@ -306,29 +301,43 @@ FIRFilterMMX::~FIRFilterMMX()
 
 
 // (overloaded) Calculates filter coefficients for MMX routine
-void FIRFilterMMX::setCoefficients(const short *coeffs, uint newLength, uint uResultDivFactor)
+void FIRFilterMMX::useCoefficients(const FIRCoefficients *coeffs)
 {
     uint i;
-    FIRFilter::setCoefficients(coeffs, newLength, uResultDivFactor);
+    FIRFilter::useCoefficients(coeffs);
 
     // Ensure that filter coeffs array is aligned to 16-byte boundary
     delete[] filterCoeffsUnalign;
-    filterCoeffsUnalign = new short[2 * newLength + 8];
+    filterCoeffsUnalign = new short[2 * length + 8];
     filterCoeffsAlign = (short *)SOUNDTOUCH_ALIGN_POINTER_16(filterCoeffsUnalign);
 
-    // rearrange the filter coefficients for mmx routines
+    // rearrange the filter coefficients for mmx routines. Notice that with
+    // integer samples the mono coefficient set equals to original coefficients
     for (i = 0;i < length; i += 4)
     {
-        filterCoeffsAlign[2 * i + 0] = coeffs[i + 0];
-        filterCoeffsAlign[2 * i + 1] = coeffs[i + 2];
-        filterCoeffsAlign[2 * i + 2] = coeffs[i + 0];
-        filterCoeffsAlign[2 * i + 3] = coeffs[i + 2];
-
-        filterCoeffsAlign[2 * i + 4] = coeffs[i + 1];
-        filterCoeffsAlign[2 * i + 5] = coeffs[i + 3];
-        filterCoeffsAlign[2 * i + 6] = coeffs[i + 1];
-        filterCoeffsAlign[2 * i + 7] = coeffs[i + 3];
+        filterCoeffsAlign[2 * i + 0] = filterCoeffs[i + 0];
+        filterCoeffsAlign[2 * i + 1] = filterCoeffs[i + 2];
+        filterCoeffsAlign[2 * i + 2] = filterCoeffs[i + 0];
+        filterCoeffsAlign[2 * i + 3] = filterCoeffs[i + 2];
+
+        filterCoeffsAlign[2 * i + 4] = filterCoeffs[i + 1];
+        filterCoeffsAlign[2 * i + 5] = filterCoeffs[i + 3];
+        filterCoeffsAlign[2 * i + 6] = filterCoeffs[i + 1];
+        filterCoeffsAlign[2 * i + 7] = filterCoeffs[i + 3];
+    }
+}
+
+
+// (overloaded) The MMX stereo routine outputs samples in pairs
+uint FIRFilterMMX::getInputLength(uint numOutput, uint numChannels) const
+{
+#ifndef USE_MULTICH_ALWAYS
+    if (numChannels == 2)
+    {
+        numOutput = (numOutput + 1) & (uint)-2;
     }
+#endif // USE_MULTICH_ALWAYS
+    return FIRFilter::getInputLength(numOutput, numChannels);
 }
 
 
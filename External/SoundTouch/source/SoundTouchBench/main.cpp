@@ -0,0 +1,1079 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+/// SoundTouch microbenchmarks. Times the inner routines of the library one by
+/// one: cross-correlation, overlap position seek and overlap-add of the time stretcher, FIR
+/// filter, sample rate transposers and FIFO buffer, plus the complete SoundTouch
+/// processing chain. Each routine is run over a grid of sample rates, channel
+/// counts, block sizes and pitch shifts, and the results are written as JSON so
+/// that runs from different versions or devices can be compared by scripts.
+///
+/// Usage : soundtouch_bench [switches]
+///
+/// Author        : Copyright (c) Olli Parviainen
+/// Author e-mail : oparviai 'at' iki.fi
+/// SoundTouch WWW: http://www.surina.net/soundtouch
+///
+////////////////////////////////////////////////////////////////////////////////
+//
+// License :
+//
+//  SoundTouch audio processing library
+//  Copyright (c) Olli Parviainen
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Lesser General Public
+//  License as published by the Free Software Foundation; either
+//  version 2.1 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this library; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+////////////////////////////////////////////////////////////////////////////////
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "SoundTouch.h"
+#include "TDStretch.h"
+#include "FIRFilter.h"
+#include "FIFOSampleBuffer.h"
+#include "InterpolateLinear.h"
+#include "InterpolateCubic.h"
+#include "InterpolateShannon.h"
+#include "InterpolatePolyphase.h"
+#include "cpu_detect.h"
+
+using namespace soundtouch;
+using namespace std;
+
+// Instruction set specific variants of the routines, compared against the plain C++ ones
+#if defined(SOUNDTOUCH_ALLOW_SSE)
+    typedef TDStretchSSE TDStretchSIMD;
+    typedef FIRFilterSSE FIRFilterSIMD;
+    #define SIMD_NAME       "sse"
+    #define SIMD_SUPPORT    SUPPORT_SSE
+#elif defined(SOUNDTOUCH_ALLOW_MMX)
+    typedef TDStretchMMX TDStretchSIMD;
+    typedef FIRFilterMMX FIRFilterSIMD;
+    #define SIMD_NAME       "mmx"
+    #define SIMD_SUPPORT    SUPPORT_MMX
+#endif
+
+#ifdef SOUNDTOUCH_INTEGER_SAMPLES
+    #define SAMPLE_TYPE_NAME    "int16"
+#else
+    #define SAMPLE_TYPE_NAME    "float"
+#endif
+
+// Number of FIR filter taps, same as in the anti-alias filter of the rate transposer
+#define FIR_LENGTH          64
+
+// Each measurement is repeated this many times and the median reported
+#define REPEATS             5
+
+static const char _helpText[] =
+    "\n"
+    "Usage :\n"
+    "    soundtouch_bench [switches]\n"
+    "\n"
+    "Available switches are:\n"
+    "  -rates=list   : Sample rates to test (Hz), default 44100,48000\n"
+    "  -channels=list: Channel counts to test, default 1,2\n"
+    "  -blocks=list  : Block sizes to test (samples per channel), default 256,1024\n"
+    "  -pitch=list   : Pitch shifts to test (semitones), default -3,3\n"
+    "  -filter=text  : Run only the benchmarks whose name contains 'text'\n"
+    "  -time=n       : Minimum duration of one measurement (ms), default 20\n"
+    "  -json=file    : Write results into 'file' instead of the standard output\n"
+    "  -nosimd       : Don't run the instruction set specific variants\n"
+    "  -baseline=file: Compare the results against an earlier '-json' output and\n"
+    "                  fail if any routine got slower than the tolerance allows\n"
+    "  -tolerance=n  : Allowed slowdown against the baseline (%), default 15\n"
+    "  -budget=file  : Fail if any result loads the CPU more than 'file' allows\n"
+    "  -golden=dir   : Compare the SoundTouch output against golden output files\n"
+    "                  in directory 'dir'. A missing golden file is a failure.\n"
+    "  -update       : Write the golden output files of '-golden' instead of\n"
+    "                  comparing against them\n"
+    "  -snr=n        : Minimum signal-to-noise ratio of the output against the\n"
+    "                  golden output (dB), default 60\n"
+    "  -maxerror=n   : Maximum difference of any sample from the golden output,\n"
+    "                  relative to the golden output peak (dB), default -40\n"
+    "\n"
+    "Lists are separated by commas. Progress is printed to the standard error.\n"
+    "Exit code is nonzero if the baseline, budget or golden output check fails.\n";
+
+
+// Accumulates results of the timed routines so that the compiler can't optimize
+// the work away
+static volatile double benchSink = 0;
+
+
+/// Benchmark program settings
+struct BenchParameters
+{
+    vector<int> sampleRates;
+    vector<int> channels;
+    vector<int> blockSizes;
+    vector<double> pitches;
+    string filter;
+    string jsonFileName;
+    string baselineFileName;
+    string budgetFileName;
+    string goldenDir;
+    double minTimeNs;
+    double tolerance;
+    double minSnr;
+    double maxError;
+    bool updateGolden;
+    bool simd;
+
+    BenchParameters()
+    {
+        sampleRates = { 44100, 48000 };
+        channels = { 1, 2 };
+        blockSizes = { 256, 1024 };
+        pitches = { -3, 3 };
+        minTimeNs = 20e6;
+        tolerance = 15;
+        minSnr = 60;
+        maxError = -40;
+        updateGolden = false;
+        simd = true;
+    }
+};
+
+
+/// One grid point of the benchmark parameters
+struct BenchConfig
+{
+    int sampleRate;
+    int channels;
+    int blockSize;
+    double pitch;
+
+    /// Sample rate conversion ratio that gives the pitch shift
+    double getRate() const
+    {
+        return pow(2.0, pitch / 12.0);
+    }
+};
+
+
+/// Collects measurement results and formats them as JSON
+class BenchReport
+{
+private:
+    vector<string> records;
+    string filter;
+
+public:
+    explicit BenchReport(const string &nameFilter) : filter(nameFilter)
+    {
+    }
+
+    /// Returns nonzero if benchmark 'name' was selected with the '-filter' switch
+    bool isSelected(const char *name) const
+    {
+        return filter.empty() || strstr(name, filter.c_str()) != nullptr;
+    }
+
+    /// Adds a result. 'framesPerCall' is the number of sample frames that one call
+    /// processes, for comparing the cost per frame across block sizes.
+    void add(const char *name, const char *variant, const BenchConfig &config,
+             uint iterations, double nsPerCall, int framesPerCall)
+    {
+        char line[512];
+
+        snprintf(line, sizeof(line),
+                 "    {\"name\":\"%s\",\"variant\":\"%s\",\"sampleRate\":%d,\"channels\":%d,"
+                 "\"blockSize\":%d,\"pitch\":%.2f,\"rate\":%.6f,\"iterations\":%u,"
+                 "\"nsPerCall\":%.1f,\"framesPerCall\":%d,\"nsPerFrame\":%.3f}",
+                 name, variant, config.sampleRate, config.channels,
+                 config.blockSize, config.pitch, config.getRate(), iterations,
+                 nsPerCall, framesPerCall, nsPerCall / max(framesPerCall, 1));
+        records.push_back(line);
+
+        fprintf(stderr, "%-29s %-6s %6d Hz %d ch %5d smp %+5.1f st : %10.1f ns/call %8.3f ns/frame\n",
+                name, variant, config.sampleRate, config.channels, config.blockSize,
+                config.pitch, nsPerCall, nsPerCall / max(framesPerCall, 1));
+    }
+
+    void write(FILE *file) const
+    {
+        fprintf(file, "{\n");
+        fprintf(file, "  \"benchmark\":\"soundtouch_bench\",\n");
+        fprintf(file, "  \"version\":\"%s\",\n", SoundTouch::getVersionString());
+        fprintf(file, "  \"sampleType\":\"%s\",\n", SAMPLE_TYPE_NAME);
+        fprintf(file, "  \"cpuExtensions\":%u,\n", detectCPUextensions());
+        fprintf(file, "  \"results\":[\n");
+        for (size_t i = 0; i < records.size(); i ++)
+        {
+            fprintf(file, "%s%s\n", records[i].c_str(), (i + 1 < records.size()) ? "," : "");
+        }
+        fprintf(file, "  ]\n}\n");
+    }
+
+    /// Compares the results against the results of an earlier run, saved with the
+    /// '-json' switch. Returns the number of routines that got slower than 'tolerance'
+    /// percent, which are reported to the standard error.
+    int checkBaseline(const string &fileName, double tolerance) const
+    {
+        FILE *file = fopen(fileName.c_str(), "r");
+        if (file == nullptr) throw runtime_error("Unable to open file: " + fileName);
+
+        vector<string> baseline;
+        char line[1024];
+        while (fgets(line, sizeof(line), file))
+        {
+            if (strstr(line, "\"name\":")) baseline.push_back(line);
+        }
+        fclose(file);
+
+        int regressions = 0;
+        int compared = 0;
+        for (const string &record : records)
+        {
+            const string key = getRecordKey(record);
+            for (const string &base : baseline)
+            {
+                if (getRecordKey(base) != key) continue;
+
+                const double current = atof(getField(record, "nsPerFrame").c_str());
+                const double previous = atof(getField(base, "nsPerFrame").c_str());
+                compared ++;
+                if (current > previous * (1.0 + tolerance / 100.0))
+                {
+                    fprintf(stderr, "SLOWER: %s : %.3f -> %.3f ns/frame (%+.1f%%)\n",
+                            key.c_str(), previous, current, 100.0 * (current / previous - 1.0));
+                    regressions ++;
+                }
+                break;
+            }
+        }
+        fprintf(stderr, "Baseline check: %d of %d results slower than %.1f%% tolerance\n",
+                regressions, compared, tolerance);
+        return regressions;
+    }
+
+    /// Compares the CPU load of each result against the budget in 'fileName'. Each
+    /// line of the file has a routine name, a variant and the max CPU load in percent
+    /// of one core per second of audio, for all sample rates, channel counts, block
+    /// sizes and pitches; '#' starts a comment line. Returns the number of results
+    /// over the budget, which are reported to the standard error.
+    int checkBudget(const string &fileName) const
+    {
+        FILE *file = fopen(fileName.c_str(), "r");
+        if (file == nullptr) throw runtime_error("Unable to open file: " + fileName);
+
+        int overBudget = 0;
+        int compared = 0;
+        char line[1024];
+        while (fgets(line, sizeof(line), file))
+        {
+            char name[256];
+            char variant[256];
+            double maxLoad;
+            if (line[0] == '#' || sscanf(line, "%255s %255s %lf", name, variant, &maxLoad) != 3) continue;
+
+            for (const string &record : records)
+            {
+                if (getField(record, "name") != name || getField(record, "variant") != variant) continue;
+
+                // ns per frame times frames per second of audio, in percent of one second
+                const double load = atof(getField(record, "nsPerFrame").c_str()) *
+                                    atof(getField(record, "sampleRate").c_str()) * 1e-7;
+                compared ++;
+                if (load > maxLoad)
+                {
+                    fprintf(stderr, "OVER BUDGET: %s : %.2f%% CPU, budget %.2f%%\n",
+                            getRecordKey(record).c_str(), load, maxLoad);
+                    overBudget ++;
+                }
+            }
+        }
+        fclose(file);
+
+        fprintf(stderr, "Budget check: %d of %d results over the CPU budget\n", overBudget, compared);
+        return overBudget;
+    }
+
+private:
+    /// Returns value of 'key' in a JSON record written by 'add'
+    static string getField(const string &record, const char *key)
+    {
+        const string tag = string("\"") + key + "\":";
+        size_t pos = record.find(tag);
+        if (pos == string::npos) return "";
+        pos += tag.size();
+        if (record[pos] == '"')
+        {
+            pos ++;
+            return record.substr(pos, record.find('"', pos) - pos);
+        }
+        return record.substr(pos, record.find_first_of(",}", pos) - pos);
+    }
+
+    /// Identifies the routine and parameters of a result
+    static string getRecordKey(const string &record)
+    {
+        static const char *keys[] = { "name", "variant", "sampleRate", "channels", "blockSize", "pitch" };
+        string result;
+        for (const char *key : keys)
+        {
+            if (!result.empty()) result += " ";
+            result += getField(record, key);
+        }
+        return result;
+    }
+};
+
+
+/// Runs 'func' so many times that one round takes at least 'minTimeNs', and returns
+/// the median duration of one call over REPEATS rounds
+template <typename Func>
+static double measure(Func func, double minTimeNs, uint &iterations)
+{
+    typedef chrono::steady_clock Clock;
+
+    auto runRound = [&func](uint count)
+    {
+        const Clock::time_point start = Clock::now();
+        for (uint i = 0; i < count; i ++)
+        {
+            func();
+        }
+        return (double)chrono::duration_cast<chrono::nanoseconds>(Clock::now() - start).count();
+    };
+
+    // warm up caches and find the iteration count
+    iterations = 1;
+    while (runRound(iterations) < minTimeNs && iterations < (1u << 30))
+    {
+        iterations *= 2;
+    }
+
+    double times[REPEATS];
+    for (int r = 0; r < REPEATS; r ++)
+    {
+        times[r] = runRound(iterations) / iterations;
+    }
+    nth_element(times, times + REPEATS / 2, times + REPEATS);
+    return times[REPEATS / 2];
+}
+
+
+/// Fills 'dest' with a deterministic speech-like test signal: harmonic tone with
+/// a gliding pitch and some noise
+static void generateSignal(SAMPLETYPE *dest, int numFrames, int channels, int sampleRate)
+{
+    uint seed = 12345;
+    double phase = 0;
+
+    for (int i = 0; i < numFrames; i ++)
+    {
+        const double f0 = 120.0 + 40.0 * sin(2.0 * M_PI * 3.0 * i / sampleRate);
+        phase += 2.0 * M_PI * f0 / sampleRate;
+
+        double value = 0.4 * sin(phase) + 0.2 * sin(2 * phase) + 0.1 * sin(3 * phase);
+        for (int c = 0; c < channels; c ++)
+        {
+            seed = seed * 1664525u + 1013904223u;
+            const double noise = 0.02 * ((double)(seed >> 8) / (double)(1 << 24) - 0.5);
+#ifdef SOUNDTOUCH_INTEGER_SAMPLES
+            dest[i * channels + c] = (SAMPLETYPE)((value + noise) * 32767.0);
+#else
+            dest[i * channels + c] = (SAMPLETYPE)(value + noise);
+#endif
+        }
+    }
+}
+
+
+/// Fills 'dest' with a 220 Hz sine at half of the full scale
+static void generateSine(SAMPLETYPE *dest, int numFrames, int channels, int sampleRate)
+{
+    for (int i = 0; i < numFrames; i ++)
+    {
+        const double value = 0.5 * sin(2.0 * M_PI * 220.0 * i / sampleRate);
+        for (int c = 0; c < channels; c ++)
+        {
+#ifdef SOUNDTOUCH_INTEGER_SAMPLES
+            dest[i * channels + c] = (SAMPLETYPE)(value * 32767.0);
+#else
+            dest[i * channels + c] = (SAMPLETYPE)value;
+#endif
+        }
+    }
+}
+
+
+/// Exposes the protected correlation and seek routines of the time stretcher.
+/// Instances are created on stack, as the 'new' operator of TDStretch is reserved
+/// for choosing the instruction set variant.
+template <class Base>
+class BenchStretch : public Base
+{
+public:
+    BenchStretch(const BenchConfig &config)
+    {
+        this->setChannels(config.channels);
+        this->setParameters(config.sampleRate);
+        // SoundTouch stretches the tempo by the inverse of the pitch transposing rate,
+        // which affects the automatic sequence and seek window lengths
+        this->setTempo(1.0 / config.getRate());
+    }
+
+    int getOverlapLength() const
+    {
+        return this->overlapLength;
+    }
+
+    /// Number of positions that one seek tests
+    int getSeekLength() const
+    {
+        return this->seekLength;
+    }
+
+    /// Number of frames that one seek scans
+    int getSeekFrames() const
+    {
+        return this->seekLength + this->overlapLength;
+    }
+
+    /// Number of output frames that each seek produces
+    int getBatchFrames() const
+    {
+        return this->seekWindowLength - this->overlapLength;
+    }
+
+    /// Sets the reference overlap segment that the seek routines match against
+    void setReference(const SAMPLETYPE *ref)
+    {
+        memcpy(this->pMidBuffer, ref, this->overlapLength * this->channels * sizeof(SAMPLETYPE));
+    }
+
+    double crossCorr(const SAMPLETYPE *pos)
+    {
+        double norm;
+        return this->calcCrossCorr(pos, this->pMidBuffer, norm);
+    }
+
+    double crossCorrAccumulate(const SAMPLETYPE *pos, double &norm)
+    {
+        return this->calcCrossCorrAccumulate(pos, this->pMidBuffer, norm);
+    }
+
+    int seekFull(const SAMPLETYPE *refPos)
+    {
+        return this->seekBestOverlapPositionFull(refPos);
+    }
+
+    int seekQuick(const SAMPLETYPE *refPos)
+    {
+        return this->seekBestOverlapPositionQuick(refPos);
+    }
+
+    int seekHierarchical(const SAMPLETYPE *refPos)
+    {
+        return this->seekBestOverlapPositionHierarchical(refPos);
+    }
+
+    /// Crossfades 'input' with the reference overlap segment into 'output'
+    void overlapAdd(SAMPLETYPE *output, const SAMPLETYPE *input)
+    {
+        if (this->channels == 1)
+        {
+            this->overlapMono(output, input);
+        }
+        else if (this->channels == 2)
+        {
+            this->overlapStereo(output, input);
+        }
+        else
+        {
+            this->overlapMulti(output, input);
+        }
+    }
+};
+
+
+template <class Base>
+static void benchStretch(BenchReport &report, const char *variant, const BenchParameters &params,
+                         const BenchConfig &config)
+{
+    BenchStretch<Base> stretch(config);
+
+    const int seekFrames = stretch.getSeekFrames();
+    vector<SAMPLETYPE> signal((2 * seekFrames + 16) * config.channels);
+    generateSignal(signal.data(), (int)signal.size() / config.channels, config.channels, config.sampleRate);
+
+    // reference is taken from a later part of the signal, like the overlap segment
+    // of the previous processing sequence would be
+    stretch.setReference(signal.data() + seekFrames * config.channels);
+    const SAMPLETYPE *pos = signal.data();
+    uint iterations;
+    double ns;
+
+    if (report.isSelected("tdstretch.crossCorr"))
+    {
+        ns = measure([&]() { benchSink = benchSink + stretch.crossCorr(pos); }, params.minTimeNs, iterations);
+        report.add("tdstretch.crossCorr", variant, config, iterations, ns, stretch.getOverlapLength());
+    }
+
+    if (report.isSelected("tdstretch.crossCorrAccumulate"))
+    {
+        double norm = 0;
+        stretch.crossCorr(pos);
+        ns = measure([&]() { benchSink = benchSink + stretch.crossCorrAccumulate(pos + config.channels, norm); }, params.minTimeNs, iterations);
+        report.add("tdstretch.crossCorrAccumulate", variant, config, iterations, ns, stretch.getOverlapLength());
+    }
+
+    if (report.isSelected("tdstretch.seekFull"))
+    {
+        ns = measure([&]() { benchSink = benchSink + stretch.seekFull(pos); }, params.minTimeNs, iterations);
+        report.add("tdstretch.seekFull", variant, config, iterations, ns, stretch.getBatchFrames());
+    }
+
+    if (report.isSelected("tdstretch.seekFullParallel"))
+    {
+        // sweep of seek window lengths for finding the crossover where splitting the
+        // full seek over the worker pool gets faster than the sequential seek. Here
+        // 'framesPerCall' is the number of seek positions
+        static const int seekWindowsMs[] = { 10, 15, 25, 40, 60 };
+        for (int seekMs : seekWindowsMs)
+        {
+            BenchStretch<Base> sweep(config);
+            sweep.setParameters(config.sampleRate, -1, seekMs, -1);
+            sweep.setReference(signal.data());
+
+            const int sweepFrames = sweep.getSeekFrames();
+            vector<SAMPLETYPE> sweepSignal((sweepFrames + 16) * config.channels);
+            generateSignal(sweepSignal.data(), (int)sweepSignal.size() / config.channels, config.channels, config.sampleRate);
+
+            for (int parallel = 0; parallel <= 1; parallel ++)
+            {
+                sweep.enableParallelSeek(parallel != 0);
+                ns = measure([&]() { benchSink = benchSink + sweep.seekFull(sweepSignal.data()); }, params.minTimeNs, iterations);
+                report.add("tdstretch.seekFullParallel", parallel ? "parallel" : "serial", config, iterations, ns, sweep.getSeekLength());
+            }
+        }
+    }
+
+    if (report.isSelected("tdstretch.seekQuick"))
+    {
+        ns = measure([&]() { benchSink = benchSink + stretch.seekQuick(pos); }, params.minTimeNs, iterations);
+        report.add("tdstretch.seekQuick", variant, config, iterations, ns, stretch.getBatchFrames());
+    }
+
+    if (report.isSelected("tdstretch.seekHierarchical"))
+    {
+        ns = measure([&]() { benchSink = benchSink + stretch.seekHierarchical(pos); }, params.minTimeNs, iterations);
+        report.add("tdstretch.seekHierarchical", variant, config, iterations, ns, stretch.getBatchFrames());
+    }
+
+    if (report.isSelected("tdstretch.overlap"))
+    {
+        vector<SAMPLETYPE> output(stretch.getOverlapLength() * config.channels);
+        ns = measure([&]()
+        {
+            stretch.overlapAdd(output.data(), pos);
+            benchSink = benchSink + (double)output[0];
+        }, params.minTimeNs, iterations);
+        report.add("tdstretch.overlap", variant, config, iterations, ns, stretch.getOverlapLength());
+    }
+}
+
+
+template <class Filter>
+static void benchFIR(BenchReport &report, const char *variant, const BenchParameters &params,
+                     const BenchConfig &config)
+{
+    if (!report.isSelected("firfilter.evaluate")) return;
+
+    // windowed sinc lowpass at quarter of the sample rate
+    SAMPLETYPE coeffs[FIR_LENGTH];
+#ifdef SOUNDTOUCH_INTEGER_SAMPLES
+    const uint resultDivFactor = 14;
+#else
+    const uint resultDivFactor = 0;
+#endif
+    for (int i = 0; i < FIR_LENGTH; i ++)
+    {
+        const double t = i - (FIR_LENGTH - 1) / 2.0;
+        const double sinc = (t == 0) ? 0.5 : sin(0.5 * M_PI * t) / (M_PI * t);
+        const double window = 0.54 - 0.46 * cos(2.0 * M_PI * i / (FIR_LENGTH - 1));
+        coeffs[i] = (SAMPLETYPE)(sinc * window * (1 << resultDivFactor));
+    }
+
+    Filter filter;
+    filter.setCoefficients(coeffs, FIR_LENGTH, resultDivFactor);
+
+    const int inputFrames = config.blockSize + FIR_LENGTH;
+    vector<SAMPLETYPE> input(inputFrames * config.channels);
+    vector<SAMPLETYPE> output(inputFrames * config.channels);
+    generateSignal(input.data(), inputFrames, config.channels, config.sampleRate);
+
+    uint iterations;
+    const double ns = measure([&]()
+    {
+        benchSink = benchSink + filter.evaluate(output.data(), input.data(), inputFrames, config.channels);
+    }, params.minTimeNs, iterations);
+    report.add("firfilter.evaluate", variant, config, iterations, ns, config.blockSize);
+}
+
+
+static void benchTransposer(BenchReport &report, const char *name, const char *variant,
+                            TransposerBase &transposer, const BenchParameters &params,
+                            const BenchConfig &config)
+{
+    if (!report.isSelected(name)) return;
+
+    transposer.setChannels(config.channels);
+    transposer.setRate(config.getRate());
+
+    vector<SAMPLETYPE> input(config.blockSize * config.channels);
+    generateSignal(input.data(), config.blockSize, config.channels, config.sampleRate);
+
+    FIFOSampleBuffer src(config.channels);
+    FIFOSampleBuffer dest(config.channels);
+
+    uint iterations;
+    const double ns = measure([&]()
+    {
+        src.putSamples(input.data(), config.blockSize);
+        benchSink = benchSink + transposer.transpose(dest, src);
+        dest.clear();
+    }, params.minTimeNs, iterations);
+    report.add(name, variant, config, iterations, ns, config.blockSize);
+}
+
+
+static void benchFIFO(BenchReport &report, const BenchParameters &params, const BenchConfig &config)
+{
+    if (!report.isSelected("fifo.putReceive")) return;
+
+    vector<SAMPLETYPE> input(config.blockSize * config.channels);
+    vector<SAMPLETYPE> output(config.blockSize * config.channels);
+    generateSignal(input.data(), config.blockSize, config.channels, config.sampleRate);
+
+    FIFOSampleBuffer fifo(config.channels);
+
+    uint iterations;
+    const double ns = measure([&]()
+    {
+        fifo.putSamples(input.data(), config.blockSize);
+        benchSink = benchSink + fifo.receiveSamples(output.data(), config.blockSize);
+    }, params.minTimeNs, iterations);
+    report.add("fifo.putReceive", "c++", config, iterations, ns, config.blockSize);
+}
+
+
+static void benchSoundTouch(BenchReport &report, const char *variant, int seekMode, bool fused,
+                            const BenchParameters &params, const BenchConfig &config)
+{
+    if (!report.isSelected("soundtouch.process")) return;
+
+    SoundTouch soundTouch;
+    soundTouch.setChannels(config.channels);
+    soundTouch.setSampleRate(config.sampleRate);
+    soundTouch.setPitchSemiTones(config.pitch);
+    soundTouch.setSetting(SETTING_USE_QUICKSEEK, seekMode);
+    soundTouch.setSetting(SETTING_FUSED_PIPELINE, fused ? 1 : 0);
+
+    // a few seconds of signal, looped so that the routines see varying audio
+    const int signalFrames = 4 * config.sampleRate / config.blockSize * config.blockSize;
+    vector<SAMPLETYPE> input(signalFrames * config.channels);
+    vector<SAMPLETYPE> output(config.blockSize * config.channels);
+    generateSignal(input.data(), signalFrames, config.channels, config.sampleRate);
+    int position = 0;
+
+    uint iterations;
+    const double ns = measure([&]()
+    {
+        soundTouch.putSamples(input.data() + position * config.channels, config.blockSize);
+        benchSink = benchSink + soundTouch.receiveSamples(output.data(), config.blockSize);
+        position = (position + config.blockSize) % signalFrames;
+    }, params.minTimeNs, iterations);
+    report.add("soundtouch.process", variant, config, iterations, ns, config.blockSize);
+}
+
+
+/// Test signals of the golden output check
+enum GoldenFixture
+{
+    FIXTURE_SPEECH,
+    FIXTURE_SINE
+};
+
+/// SoundTouch settings of the golden output check: library defaults, or the
+/// settings of the DAF processor at full quality
+enum GoldenProfile
+{
+    PROFILE_DEFAULT,
+    PROFILE_APP
+};
+
+
+/// Runs a test signal through SoundTouch in blocks of 'config.blockSize' and
+/// returns all output, including the samples flushed at end
+static vector<SAMPLETYPE> renderSoundTouch(const BenchConfig &config, GoldenFixture fixture, GoldenProfile profile)
+{
+    SoundTouch soundTouch;
+    soundTouch.setChannels(config.channels);
+    soundTouch.setSampleRate(config.sampleRate);
+    soundTouch.setPitchSemiTones(config.pitch);
+
+    if (profile == PROFILE_APP)
+    {
+        // same as DAFAudioProcessor::preparePitchEngine and applyQualityTier
+        soundTouch.setSetting(SETTING_FUSED_PIPELINE, 1);
+        soundTouch.setSetting(SETTING_SPEECH_PROFILE, 1);
+        soundTouch.setSetting(SETTING_OVERLAP_WINDOW, 1);
+        soundTouch.setSetting(SETTING_USE_QUICKSEEK, TDStretch::SEEK_PITCH_GUIDED);
+        soundTouch.setSetting(SETTING_AA_FILTER_LENGTH, 64);
+        soundTouch.setSetting(SETTING_TRANSPOSER_ALGORITHM, 1);
+    }
+
+    // a short signal keeps the golden files small, and still covers a few dozen
+    // sequences of the time stretcher
+    const int numFrames = config.sampleRate / 4;
+    vector<SAMPLETYPE> input(numFrames * config.channels);
+    if (fixture == FIXTURE_SINE)
+    {
+        generateSine(input.data(), numFrames, config.channels, config.sampleRate);
+    }
+    else
+    {
+        generateSignal(input.data(), numFrames, config.channels, config.sampleRate);
+    }
+
+    vector<SAMPLETYPE> output;
+    vector<SAMPLETYPE> block(config.blockSize * config.channels);
+    auto receiveAll = [&]()
+    {
+        uint received;
+        while ((received = soundTouch.receiveSamples(block.data(), config.blockSize)) != 0)
+        {
+            output.insert(output.end(), block.begin(), block.begin() + received * config.channels);
+        }
+    };
+
+    for (int pos = 0; pos < numFrames; pos += config.blockSize)
+    {
+        soundTouch.putSamples(input.data() + pos * config.channels, min(config.blockSize, numFrames - pos));
+        receiveAll();
+    }
+    soundTouch.flush();
+    receiveAll();
+
+    return output;
+}
+
+
+/// Compares 'output' against golden output file 'fileName' and reports the result.
+/// Returns false if the file is missing, has a different length, or the output
+/// differs from it by more than 'params.minSnr' or 'params.maxError' allow.
+static bool compareGolden(const vector<SAMPLETYPE> &output, const string &fileName, const BenchParameters &params)
+{
+    FILE *file = fopen(fileName.c_str(), "rb");
+    if (file == nullptr)
+    {
+        fprintf(stderr, "FAILED: %s : golden output missing, create it with -update\n", fileName.c_str());
+        return false;
+    }
+
+    vector<SAMPLETYPE> golden(output.size() + 1);
+    const size_t goldenSize = fread(golden.data(), sizeof(SAMPLETYPE), golden.size(), file);
+    fclose(file);
+
+    if (goldenSize != output.size())
+    {
+        fprintf(stderr, "FAILED: %s : %u samples, golden output has %u\n", fileName.c_str(),
+                (uint)output.size(), (uint)goldenSize);
+        return false;
+    }
+
+    double signal = 0;
+    double noise = 0;
+    double peak = 0;
+    double maxDiff = 0;
+    for (size_t i = 0; i < output.size(); i ++)
+    {
+        const double diff = (double)output[i] - (double)golden[i];
+        signal += (double)golden[i] * (double)golden[i];
+        noise += diff * diff;
+        peak = max(peak, fabs((double)golden[i]));
+        maxDiff = max(maxDiff, fabs(diff));
+    }
+    const double snr = (noise > 0) ? 10.0 * log10(signal / noise) : INFINITY;
+    const double error = (maxDiff > 0) ? 20.0 * log10(maxDiff / peak) : -INFINITY;
+
+    const bool passed = (snr >= params.minSnr) && (error <= params.maxError);
+    fprintf(stderr, "%s: %s : SNR %.1f dB, max error %.1f dB\n", passed ? "PASSED" : "FAILED",
+            fileName.c_str(), snr, error);
+    return passed;
+}
+
+
+/// Renders the test signals through SoundTouch for each sample rate, channel count
+/// and pitch, and compares the output against golden output files in
+/// 'params.goldenDir', or writes the files with '-update'. The settings of the DAF
+/// processor are checked with one channel only, as the processor runs one
+/// SoundTouch instance per channel. Returns the number of failed comparisons.
+static int checkGolden(const BenchParameters &params)
+{
+    static const char *fixtureNames[] = { "speech", "sine" };
+    static const char *profileNames[] = { "default", "app" };
+    int failures = 0;
+
+    for (int sampleRate : params.sampleRates)
+    {
+        for (int channels : params.channels)
+        {
+            for (double pitch : params.pitches)
+            {
+                for (int profile = PROFILE_DEFAULT; profile <= PROFILE_APP; profile ++)
+                {
+                    if (profile == PROFILE_APP && channels != 1) continue;
+
+                    for (int fixture = FIXTURE_SPEECH; fixture <= FIXTURE_SINE; fixture ++)
+                    {
+                        BenchConfig config;
+                        config.sampleRate = sampleRate;
+                        config.channels = channels;
+                        config.blockSize = params.blockSizes[0];
+                        config.pitch = pitch;
+
+                        const vector<SAMPLETYPE> output =
+                            renderSoundTouch(config, (GoldenFixture)fixture, (GoldenProfile)profile);
+
+                        char name[256];
+                        snprintf(name, sizeof(name), "soundtouch_%s_%s_%d_%dch_%+.1f_%s.raw",
+                                 profileNames[profile], fixtureNames[fixture], sampleRate, channels,
+                                 pitch, SAMPLE_TYPE_NAME);
+                        const string fileName = params.goldenDir + "/" + name;
+
+                        if (params.updateGolden)
+                        {
+                            FILE *file = fopen(fileName.c_str(), "wb");
+                            if (file == nullptr) throw runtime_error("Unable to create file: " + fileName);
+                            fwrite(output.data(), sizeof(SAMPLETYPE), output.size(), file);
+                            fclose(file);
+                            fprintf(stderr, "UPDATED: %s\n", fileName.c_str());
+                        }
+                        else if (!compareGolden(output, fileName, params))
+                        {
+                            failures ++;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    return failures;
+}
+
+
+static void runBenchmarks(BenchReport &report, const BenchParameters &params)
+{
+    bool simd = false;
+#ifdef SIMD_NAME
+    simd = params.simd && (detectCPUextensions() & SIMD_SUPPORT);
+#endif
+
+    for (int sampleRate : params.sampleRates)
+    {
+        for (int channels : params.channels)
+        {
+            for (size_t p = 0; p < params.pitches.size(); p ++)
+            {
+                BenchConfig config;
+                config.sampleRate = sampleRate;
+                config.channels = channels;
+                config.blockSize = params.blockSizes[0];
+                config.pitch = params.pitches[p];
+
+                // the time stretch routines work on sequences whose length depends on
+                // the sample rate and pitch, not on the block size
+                benchStretch<TDStretch>(report, "c++", params, config);
+#ifdef SIMD_NAME
+                if (simd) benchStretch<TDStretchSIMD>(report, SIMD_NAME, params, config);
+#endif
+
+                for (int blockSize : params.blockSizes)
+                {
+                    config.blockSize = blockSize;
+
+                    // pitch independent routines are run only once per block size
+                    if (p == 0)
+                    {
+                        benchFIR<FIRFilter>(report, "c++", params, config);
+#ifdef SIMD_NAME
+                        if (simd) benchFIR<FIRFilterSIMD>(report, SIMD_NAME, params, config);
+#endif
+                        benchFIFO(report, params, config);
+                    }
+
+                    InterpolateLinearInteger linearInteger;
+                    benchTransposer(report, "transposer.linearInteger", "c++", linearInteger, params, config);
+
+                    InterpolateLinearFloat linearFloat;
+                    benchTransposer(report, "transposer.linearFloat", "c++", linearFloat, params, config);
+
+                    InterpolateCubic cubic;
+                    benchTransposer(report, "transposer.cubic", "c++", cubic, params, config);
+
+                    InterpolateShannon shannon;
+                    benchTransposer(report, "transposer.shannon", "c++", shannon, params, config);
+
+                    InterpolatePolyphase polyphase;
+                    benchTransposer(report, "transposer.polyphase", "c++", polyphase, params, config);
+
+#ifdef SOUNDTOUCH_ALLOW_SSE
+                    if (simd)
+                    {
+                        InterpolateLinearSSE linearSSE;
+                        benchTransposer(report, "transposer.linearFloat", "sse", linearSSE, params, config);
+
+                        InterpolateCubicSSE cubicSSE;
+                        benchTransposer(report, "transposer.cubic", "sse", cubicSSE, params, config);
+
+                        InterpolateShannonSSE shannonSSE;
+                        benchTransposer(report, "transposer.shannon", "sse", shannonSSE, params, config);
+                    }
+#endif
+
+                    benchSoundTouch(report, "full", TDStretch::SEEK_FULL, false, params, config);
+                    benchSoundTouch(report, "quick", TDStretch::SEEK_QUICK, false, params, config);
+                    benchSoundTouch(report, "hierarchical", TDStretch::SEEK_HIERARCHICAL, false, params, config);
+                    benchSoundTouch(report, "pitchGuided", TDStretch::SEEK_PITCH_GUIDED, false, params, config);
+                    benchSoundTouch(report, "fused", TDStretch::SEEK_FULL, true, params, config);
+                }
+            }
+        }
+    }
+}
+
+
+template <typename T>
+static vector<T> parseList(const char *text)
+{
+    vector<T> values;
+    while (*text)
+    {
+        char *end;
+        const double value = strtod(text, &end);
+        if (end == text) throw runtime_error(string("Invalid number list: ") + text);
+        values.push_back((T)value);
+        text = (*end == ',') ? end + 1 : end;
+    }
+    if (values.empty()) throw runtime_error("Empty number list");
+    return values;
+}
+
+
+static void parseSwitches(BenchParameters &params, int nParams, char *paramStr[])
+{
+    for (int i = 1; i < nParams; i ++)
+    {
+        const string arg = paramStr[i];
+        const size_t eq = arg.find('=');
+        const string name = arg.substr(0, eq);
+        const char *value = (eq == string::npos) ? "" : paramStr[i] + eq + 1;
+
+        if (name == "-rates") params.sampleRates = parseList<int>(value);
+        else if (name == "-channels") params.channels = parseList<int>(value);
+        else if (name == "-blocks") params.blockSizes = parseList<int>(value);
+        else if (name == "-pitch") params.pitches = parseList<double>(value);
+        else if (name == "-filter") params.filter = value;
+        else if (name == "-time") params.minTimeNs = 1e6 * atof(value);
+        else if (name == "-json") params.jsonFileName = value;
+        else if (name == "-nosimd") params.simd = false;
+        else if (name == "-baseline") params.baselineFileName = value;
+        else if (name == "-budget") params.budgetFileName = value;
+        else if (name == "-tolerance") params.tolerance = atof(value);
+        else if (name == "-golden") params.goldenDir = value;
+        else if (name == "-update") params.updateGolden = true;
+        else if (name == "-snr") params.minSnr = atof(value);
+        else if (name == "-maxerror") params.maxError = atof(value);
+        else
+        {
+            throw runtime_error("Unknown switch: " + arg + "\n" + _helpText);
+        }
+    }
+
+    for (int channels : params.channels)
+    {
+        if (channels < 1 || channels > SOUNDTOUCH_MAX_CHANNELS) throw runtime_error("Invalid channel count");
+    }
+    for (int blockSize : params.blockSizes)
+    {
+        if (blockSize < 1) throw runtime_error("Invalid block size");
+    }
+    for (int sampleRate : params.sampleRates)
+    {
+        if (sampleRate < 8000) throw runtime_error("Invalid sample rate");
+    }
+}
+
+
+int main(int nParams, char *paramStr[])
+{
+    try
+    {
+        BenchParameters params;
+        parseSwitches(params, nParams, paramStr);
+
+        int failures = 0;
+        if (!params.goldenDir.empty())
+        {
+            failures += checkGolden(params);
+        }
+
+        BenchReport report(params.filter);
+        runBenchmarks(report, params);
+
+        if (params.jsonFileName.empty())
+        {
+            report.write(stdout);
+        }
+        else
+        {
+            FILE *file = fopen(params.jsonFileName.c_str(), "w");
+            if (file == nullptr) throw runtime_error("Unable to open file: " + params.jsonFileName);
+            report.write(file);
+            fclose(file);
+        }
+
+        if (!params.baselineFileName.empty())
+        {
+            failures += report.checkBaseline(params.baselineFileName, params.tolerance);
+        }
+
+        if (!params.budgetFileName.empty())
+        {
+            failures += report.checkBudget(params.budgetFileName);
+        }
+
+        if (failures) return 1;
+    }
+    catch (const runtime_error &e)
+    {
+        fprintf(stderr, "%s\n", e.what());
+        return -1;
+    }
+
+    return 0;
+}
@@ -70,6 +70,8 @@ typedef struct
 {
     DWORD dwMagic;
     SoundTouch *pst;
+    int preroll;        ///< silent samples still to output in 'soundtouch_processPlanar',
+                        ///< or -1 if the stream hasn't started yet
 } STHANDLE;
 
 typedef struct
@@ -89,6 +91,7 @@ SOUNDTOUCHDLL_API HANDLE __cdecl soundtouch_createInstance()
     if (tmp)
     {
         tmp->dwMagic = STMAGIC;
+        tmp->preroll = -1;
         tmp->pst = new SoundTouch();
         if (tmp->pst == nullptr)
         {
@@ -331,6 +334,7 @@ SOUNDTOUCHDLL_API void __cdecl soundtouch_clear(HANDLE h)
     if (sth->dwMagic != STMAGIC) return;
 
     sth->pst->clear();
+    sth->preroll = -1;
 }
 
 /// Changes a setting controlling the processing system behaviour. See the
@@ -467,6 +471,199 @@ SOUNDTOUCHDLL_API int __cdecl soundtouch_isEmpty(HANDLE h)
 }
 
 
+/// Adds 'numSamples' sample frames from planar channel buffers 'samples' into
+/// the input of the object. The channels are interleaved in slices through a
+/// stack buffer, so this doesn't allocate memory.
+SOUNDTOUCHDLL_API int __cdecl soundtouch_putSamplesPlanar(HANDLE h,
+        const float * const *samples,   ///< Array of pointers to channel buffers.
+        unsigned int numSamples         ///< Number of samples per channel.
+        )
+{
+    STHANDLE *sth = (STHANDLE*)h;
+    if (sth->dwMagic != STMAGIC) return 0;
+
+    uint numChannels = sth->pst->numChannels();
+
+    try
+    {
+        if (numChannels == 1)
+        {
+            // mono planar is the same as interleaved
+            sth->pst->putSamples(samples[0], numSamples);
+            return 1;
+        }
+
+        uint pos = 0;
+        while (pos < numSamples)
+        {
+            float interleave[8192];    // allocate temporary interleaving buffer from stack
+
+            // how many multichannel samples fit into 'interleave' buffer:
+            uint sliceSamples = 8192 / numChannels;
+            uint n = (numSamples - pos > sliceSamples) ? sliceSamples : numSamples - pos;
+
+            for (uint c = 0; c < numChannels; c ++)
+            {
+                const float *src = samples[c] + pos;
+                for (uint i = 0; i < n; i ++)
+                {
+                    interleave[i * numChannels + c] = src[i];
+                }
+            }
+            sth->pst->putSamples(interleave, n);
+            pos += n;
+        }
+    }
+    catch (const std::exception&)
+    {
+        return 0;
+    }
+    return 1;
+}
+
+
+/// Receives ready samples from the processing pipeline into planar channel
+/// buffers. The samples get deinterleaved directly from the output buffer of
+/// the processor.
+///
+/// \return number of samples received per channel.
+SOUNDTOUCHDLL_API uint __cdecl soundtouch_receiveSamplesPlanar(HANDLE h,
+        float * const *outBuffer,       ///< Array of pointers to channel buffers.
+        unsigned int maxSamples         ///< How many samples to receive at max.
+        )
+{
+    STHANDLE *sth = (STHANDLE*)h;
+    if (sth->dwMagic != STMAGIC) return 0;
+
+    uint numChannels = sth->pst->numChannels();
+    uint available = sth->pst->numSamples();
+    uint n = (maxSamples < available) ? maxSamples : available;
+    // 'ptrBegin' is public in the pipe interface
+    FIFOSamplePipe *pipe = sth->pst;
+    const float *src = pipe->ptrBegin();
+
+    for (uint c = 0; c < numChannels; c ++)
+    {
+        float *dest = outBuffer[c];
+        for (uint i = 0; i < n; i ++)
+        {
+            dest[i] = src[i * numChannels + c];
+        }
+    }
+
+    return sth->pst->receiveSamples(n);
+}
+
+
+/// Returns the number of silent samples that 'soundtouch_processPlanar' outputs
+/// before the processed audio with the current settings.
+SOUNDTOUCHDLL_API int __cdecl soundtouch_getLatency(HANDLE h)
+{
+    STHANDLE *sth = (STHANDLE*)h;
+    if (sth->dwMagic != STMAGIC) return -1;
+
+    return sth->pst->getOutputLatency();
+}
+
+
+// Feeds 'numSamples' samples into the processor and outputs equal amount of
+// samples. SoundTouch outputs audio in bursts, so the output starts with silence
+// of the output latency, after which the processed audio flows without gaps as
+// long as tempo and rate remain 1.0.
+static uint _processPlanar(STHANDLE *sth, const float * const *input, float * const *output, uint numSamples)
+{
+    if (sth->preroll < 0)
+    {
+        // stream starts: latency of the settings at this point
+        sth->preroll = sth->pst->getOutputLatency();
+    }
+
+    if (soundtouch_putSamplesPlanar(sth, input, numSamples) == 0) return 0;
+
+    uint numChannels = sth->pst->numChannels();
+    uint silent = ((uint)sth->preroll < numSamples) ? (uint)sth->preroll : numSamples;
+    uint wanted = numSamples - silent;
+    sth->preroll -= (int)silent;
+
+    float *dest[SOUNDTOUCH_MAX_CHANNELS] = { nullptr };
+    for (uint c = 0; c < numChannels; c ++)
+    {
+        dest[c] = output[c] + silent;
+    }
+    uint received = soundtouch_receiveSamplesPlanar(sth, dest, wanted);
+
+    for (uint c = 0; c < numChannels; c ++)
+    {
+        // if still short of samples (e.g. right after parameter change), put the gap
+        // as silence before the received samples instead of cutting the audio
+        if (received < wanted)
+        {
+            uint missing = wanted - received;
+            memmove(dest[c] + missing, dest[c], sizeof(float) * received);
+            memset(dest[c], 0, sizeof(float) * missing);
+        }
+        memset(output[c], 0, sizeof(float) * silent);
+    }
+
+    return numSamples;
+}
+
+
+/// Processes 'numSamples' samples from planar channel buffers 'input' into the
+/// same amount of samples to planar channel buffers 'output', for pitch shifting
+/// in fixed size blocks at tempo and rate 1.0. The output starts with
+/// 'soundtouch_getLatency' samples of silence, after which the processed audio
+/// flows without gaps. 'input' and 'output' may point to same buffers for
+/// processing in place. Call 'soundtouch_clear' after changing settings to
+/// restart the stream with the new latency.
+///
+/// \return 'numSamples', or zero if failed.
+SOUNDTOUCHDLL_API uint __cdecl soundtouch_processPlanar(HANDLE h,
+        const float * const *input,     ///< Array of pointers to input channel buffers.
+        float * const *output,          ///< Array of pointers to output channel buffers.
+        unsigned int numSamples         ///< Number of samples per channel.
+        )
+{
+    STHANDLE *sth = (STHANDLE*)h;
+    if (sth->dwMagic != STMAGIC) return 0;
+
+    return _processPlanar(sth, input, output, numSamples);
+}
+
+
+/// Processes 'numSamples' samples with each of 'numInstances' instances in one
+/// call, as 'soundtouch_processPlanar'. The channel buffer pointers of all
+/// instances are consecutive in 'inputs' and 'outputs': first the channels of
+/// the first instance, then the channels of the second instance etc. E.g. with
+/// mono instances for each channel of a multichannel buffer, these are the
+/// channel pointer arrays of the buffer.
+///
+/// \return number of instances processed successfully.
+SOUNDTOUCHDLL_API int __cdecl soundtouch_processPlanarBatch(const HANDLE *handles,
+        unsigned int numInstances,      ///< Number of instances in 'handles'.
+        const float * const *inputs,    ///< Input channel buffer pointers of all instances.
+        float * const *outputs,         ///< Output channel buffer pointers of all instances.
+        unsigned int numSamples         ///< Number of samples per channel.
+        )
+{
+    int numProcessed = 0;
+
+    for (uint i = 0; i < numInstances; i ++)
+    {
+        STHANDLE *sth = (STHANDLE*)handles[i];
+        // channel count of an invalid handle is unknown, so stop here
+        if (sth->dwMagic != STMAGIC) break;
+
+        if (_processPlanar(sth, inputs, outputs, numSamples) == numSamples) numProcessed ++;
+
+        uint numChannels = sth->pst->numChannels();
+        inputs += numChannels;
+        outputs += numChannels;
+    }
+    return numProcessed;
+}
+
+
 SOUNDTOUCHDLL_API HANDLE __cdecl bpm_createInstance(int numChannels, int sampleRate)
 {
     BPMHANDLE *tmp = new BPMHANDLE;
@@ -195,6 +195,55 @@ SOUNDTOUCHDLL_API unsigned int __cdecl soundtouch_numSamples(HANDLE h);
 /// Returns nonzero if there aren't any samples available for outputting.
 SOUNDTOUCHDLL_API int __cdecl soundtouch_isEmpty(HANDLE h);
 
+/// Adds 'numSamples' sample frames from planar channel buffers 'samples' into
+/// the input of the object, e.g. from the channels of a JUCE AudioBuffer.
+SOUNDTOUCHDLL_API int __cdecl soundtouch_putSamplesPlanar(HANDLE h,
+        const float * const *samples,   ///< Array of pointers to channel buffers.
+        unsigned int numSamples         ///< Number of samples per channel.
+);
+
+/// Receives ready samples into planar channel buffers.
+///
+/// \return number of samples received per channel.
+SOUNDTOUCHDLL_API unsigned int __cdecl soundtouch_receiveSamplesPlanar(HANDLE h,
+        float * const *outBuffer,       ///< Array of pointers to channel buffers.
+        unsigned int maxSamples         ///< How many samples to receive at max.
+);
+
+/// Returns the number of silent samples that 'soundtouch_processPlanar' outputs
+/// before the processed audio with the current settings.
+SOUNDTOUCHDLL_API int __cdecl soundtouch_getLatency(HANDLE h);
+
+/// Processes 'numSamples' samples from planar channel buffers 'input' into the
+/// same amount of samples to planar channel buffers 'output', for pitch shifting
+/// in fixed size blocks at tempo and rate 1.0. The output starts with
+/// 'soundtouch_getLatency' samples of silence, after which the processed audio
+/// flows without gaps. 'input' and 'output' may point to same buffers for
+/// processing in place. Call 'soundtouch_clear' after changing settings to
+/// restart the stream with the new latency.
+///
+/// \return 'numSamples', or zero if failed.
+SOUNDTOUCHDLL_API unsigned int __cdecl soundtouch_processPlanar(HANDLE h,
+        const float * const *input,     ///< Array of pointers to input channel buffers.
+        float * const *output,          ///< Array of pointers to output channel buffers.
+        unsigned int numSamples         ///< Number of samples per channel.
+);
+
+/// Processes 'numSamples' samples with each of 'numInstances' instances in one
+/// call, as 'soundtouch_processPlanar'. The channel buffer pointers of all
+/// instances are consecutive in 'inputs' and 'outputs': first the channels of
+/// the first instance, then the channels of the second instance etc. E.g. with
+/// a mono instance for each channel of a multichannel buffer, these are just the
+/// channel pointer arrays of the buffer. Stops at the first invalid handle.
+///
+/// \return number of instances processed successfully.
+SOUNDTOUCHDLL_API int __cdecl soundtouch_processPlanarBatch(const HANDLE *handles,
+        unsigned int numInstances,      ///< Number of instances in 'handles'.
+        const float * const *inputs,    ///< Input channel buffer pointers of all instances.
+        float * const *outputs,         ///< Output channel buffer pointers of all instances.
+        unsigned int numSamples         ///< Number of samples per channel.
+);
+
 /// Create a new instance of BPM detector
 SOUNDTOUCHDLL_API HANDLE __cdecl bpm_createInstance(int numChannels, int sampleRate);
 
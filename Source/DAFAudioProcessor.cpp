@@ -1,6 +1,15 @@
 #include "DAFAudioProcessor.h"
+#include "TraceRecorder.h"
+#include <SoundTouch.h>
+#include <chrono>
+#include <utility>
+
+#if JUCE_MAC || JUCE_IOS || JUCE_LINUX || JUCE_ANDROID
+ #include <sys/mman.h>
+#endif
 
 std::atomic<int> DAFAudioProcessor::instanceCount{0};
+std::atomic<int> DAFAudioProcessor::forcedPitchEngineFormat{-1};
 
 DAFAudioProcessor::DAFAudioProcessor()
     : AudioProcessor(
@@ -40,6 +49,10 @@ DAFAudioProcessor::~DAFAudioProcessor()
 {
     --instanceCount;
     saveUserSettings();
+
+    if (lockDelayMemory)
+        lockDelayBuffer(delayBuffer, false);
+    cancelDelayResize();
     DBG("[DAF] Destructor - Instancias activas: " << instanceCount);
 }
 
@@ -47,13 +60,28 @@ void DAFAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
 {
     jassert(sampleRate > 0 && samplesPerBlock > 0);
 
-    const int delayBufferSize = juce::nextPowerOfTwo(static_cast<int>(2.0 * sampleRate));
-    delayBuffer.setSize(2, delayBufferSize);
-    delayBuffer.clear();
+    // Con entrada mono (el caso normal: el dispositivo se abre con 1 entrada) la
+    // línea de delay y SoundTouch son de un solo canal
+    const int numInputChannels = jlimit(1, 2, getTotalNumInputChannels());
+    stereoInputSeen = false;
 
-    // Inicializar buffer de fade
-    fadeBuffer.setSize(2, samplesPerBlock);
-    fadeBuffer.clear();
+    // Línea de delay para el delay máximo permitido. Solo se reserva de nuevo si
+    // cambia el tamaño; si no, basta con limpiar lo que se llegó a escribir
+    const int delayBufferSize = getDelayCapacity(sampleRate, getMaxDelayMs());
+    cancelDelayResize();
+
+    if (delayBuffer.getNumChannels() != numInputChannels || delayBuffer.getNumSamples() != delayBufferSize)
+    {
+        allocateDelayBuffer(delayBuffer, numInputChannels, delayBufferSize);
+        delayDirtySamples = 0;
+    }
+    else
+    {
+        clearDelayBufferChunk(delayBufferSize);
+    }
+
+    // Rampa de fade precalculada para esta frecuencia de muestreo
+    fadeRamp.prepare(static_cast<int>(fadeDurationSeconds * sampleRate), GainRamp::Shape::linear);
 
     writePositions[0].store(0);
     writePositions[1].store(0);
@@ -75,116 +103,786 @@ void DAFAudioProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
     auto coeffs = juce::dsp::IIR::ArrayCoefficients<float>::makeLowPass(sampleRate, 5000.0f);
     wetFilter.state = new juce::dsp::IIR::Coefficients<float>(coeffs);
 
-    for (int ch = 0; ch < 2; ++ch)
+    // Crossfade de entrada y salida del pitch
+    pitchRamp.prepare(static_cast<int>(pitchCrossfadeSeconds * sampleRate), GainRamp::Shape::equalPower);
+    stereoRamp.prepare(static_cast<int>(pitchCrossfadeSeconds * sampleRate), GainRamp::Shape::equalPower);
+    rightPitchEnginePending = false;
+    qualityGovernor.prepare();
+    pitchDryBuffer.setSize(numInputChannels, samplesPerBlock);
+    pitchState = PitchState::bypassed;
+
+    // Los motores de pitch se preparan de nuevo si ya se habían creado o si el
+    // pitch está activo; si no, se crean la primera vez que se pida
+    const bool pitchWanted = std::abs(snapPitchSemitones(getPitchShiftSemitones())) > pitchBypassSemitones;
+    pitchEnginesReady.store(false);
+    pitchEnginesRequested.store(false);
+
+    if (numInputChannels < 2)
+        pitchEngine[1].reset();
+
+    // Un cambio de perfil a medias se descarta: createPitchEngines aplica el actual
+    for (auto& engine : pendingPitchEngine)
+        engine.reset();
+    profileSwapState.store(profileIdle);
+
+    if (pitchEngine[0] != nullptr || pitchWanted)
+        createPitchEngines();
+    else
+        pitchLatencySamples.store(0);
+
+    // Con el pitch ya activo se arranca directamente con SoundTouch, como antes
+    if (pitchWanted && pitchEnginesReady.load())
     {
-        pitchEngine[ch].setSampleRate(static_cast<uint>(sampleRate));
-        pitchEngine[ch].setChannels(1);
-        pitchEngine[ch].setPitchSemiTones(getPitchShiftSemitones());
-        pitchEngine[ch].clear();
+        pitchState = PitchState::active;
+        pitchRamp.setGain(true);
     }
 
-    fadeLengthInSamples = static_cast<int>(fadeDurationSeconds * sampleRate);
+    updateMemoryUsage();
+
+    cancelPendingUpdate();
+    setLatencySamples(pitchLatencySamples.load());
+
+    // Con el audio parado se pueden descartar las órdenes pendientes: el estado
+    // pedido por la UI ya está en processingEnabled
+    AudioCommand pending;
+    while (popCommand(pending)) {}
+
+    runState = processingEnabled.load() ? RunState::fadingIn : RunState::stopped;
+    if (runState == RunState::fadingIn)
+        fadeRamp.rampUp();
     DBG("prepareToPlay completado");
 }
 
+void DAFAudioProcessor::setPitchEngineFormat(soundtouch::SoundTouchEngine::SAMPLEFORMAT format)
+{
+    forcedPitchEngineFormat.store(static_cast<int>(format));
+}
+
+soundtouch::SoundTouchEngine::SAMPLEFORMAT DAFAudioProcessor::getPitchEngineFormat(double sampleRate)
+{
+    const int forced = forcedPitchEngineFormat.load();
+    if (forced >= 0)
+        return static_cast<soundtouch::SoundTouchEngine::SAMPLEFORMAT>(forced);
+
+    // Microbenchmark de float vs int16, una sola vez por proceso (unas decenas de ms)
+    static const auto format = [sampleRate]
+    {
+        const auto fastest = soundtouch::SoundTouchEngine::selectFastestFormat(static_cast<unsigned int>(sampleRate), 1);
+        DBG("[DAF] Formato de SoundTouch: " << (fastest == soundtouch::SoundTouchEngine::INT16_SAMPLES ? "int16" : "float"));
+        return fastest;
+    }();
+
+    return format;
+}
+
+void DAFAudioProcessor::createPitchEngines()
+{
+    // Desde el hilo de mensajes: reserva memoria y diseña filtros
+    const double sampleRate = getSampleRate();
+    if (pitchEnginesReady.load() || sampleRate <= 0.0 || numDelayChannels == 0)
+        return;
+
+    DAF_TRACE_SCOPE("createPitchEngines");
+    const auto pitchEngineFormat = getPitchEngineFormat(sampleRate);
+    const bool speechProfile = isSpeechProfileEnabled();
+
+    for (int ch = 0; ch < numDelayChannels; ++ch)
+    {
+        if (pitchEngine[ch] == nullptr)
+            pitchEngine[ch].reset(soundtouch::SoundTouchEngine::newInstance(pitchEngineFormat));
+
+        preparePitchEngine(*pitchEngine[ch], sampleRate, speechProfile);
+    }
+
+    warmPitchEngines(pitchEngine, QualityGovernor::fullQuality);
+    qualityTierApplied = QualityGovernor::fullQuality;
+    speechProfileApplied = speechProfile;
+
+    // Latencia y silencio inicial de los motores nuevos
+    const int latency = measurePitchLatency(sampleRate, speechProfile);
+    pitchLatencySamples.store(latency);
+
+    for (auto& preroll : pitchPrerollRemaining)
+        preroll = latency;
+
+    pitchEnginesReady.store(true, std::memory_order_release);
+    DBG("[DAF] Motores de pitch creados, latencia " << pitchLatencySamples.load() << " muestras");
+}
+
+void DAFAudioProcessor::preparePitchEngine(soundtouch::SoundTouchEngine& engine, double sampleRate, bool speechProfile)
+{
+    engine.setSampleRate(static_cast<unsigned int>(sampleRate));
+    engine.setChannels(1);
+    engine.setPitchSemiTones(snapPitchSemitones(getPitchShiftSemitones()));
+
+    // Las etapas de SoundTouch escriben directamente en la entrada de la siguiente
+    engine.setSetting(SETTING_FUSED_PIPELINE, 1);
+
+    // Perfil de voz de SoundTouch: ventanas derivadas del rango de F0 de la voz y
+    // de un presupuesto de latencia (~40 ms en vez de ~80-100 ms del perfil de música),
+    // con crossfade de coseno alzado entre secuencias. Cambia los tamaños de los
+    // buffers de TDStretch, así que solo se aplica fuera del hilo de audio
+    engine.setSetting(SETTING_SPEECH_PROFILE, speechProfile ? 1 : 0);
+    engine.setSetting(SETTING_OVERLAP_WINDOW, speechProfile ? 1 : 0);
+
+    // El filtro anti-alias corto se aplica en el centro de la ventana del largo: al
+    // cambiar de nivel de calidad la salida no se desplaza ni cambia la latencia
+    engine.setSetting(SETTING_AA_FILTER_DELAY_LENGTH, 64);
+    engine.clear();
+}
+
+void DAFAudioProcessor::warmPitchEngines(std::unique_ptr<soundtouch::SoundTouchEngine> (&engines)[2], QualityGovernor::Tier finalTier)
+{
+    // Precalcular los filtros anti-alias de SoundTouch para todos los pasos del
+    // parámetro de pitch (no solo los del slider: el host puede automatizar todo el
+    // rango) y todos los niveles de calidad, y crear los interpoladores de cada
+    // nivel, así ni un cambio de pitch ni uno de nivel reservan memoria ni diseñan
+    // filtros en el hilo de audio
+    const auto range = apvts.getParameterRange("pitch");
+
+    for (int tier = QualityGovernor::numTiers - 1; tier >= 0; --tier)
+    {
+        for (auto& engine : engines)
+            if (engine != nullptr)
+                applyQualityTier(*engine, static_cast<QualityGovernor::Tier>(tier));
+
+        for (float semitones = range.start; semitones <= range.end; semitones += pitchUiStepSemitones)
+            engines[0]->preparePitchSemiTones(semitones);
+    }
+
+    for (auto& engine : engines)
+        if (engine != nullptr)
+            applyQualityTier(*engine, finalTier);
+}
+
+void DAFAudioProcessor::applyQualityTier(soundtouch::SoundTouchEngine& engine, QualityGovernor::Tier tier)
+{
+    // Cada nivel añade una rebaja a las del anterior, ver QualityGovernor::Tier
+    engine.setSetting(SETTING_USE_QUICKSEEK, tier >= QualityGovernor::hierarchicalSeek ? 2 : 3);
+    engine.setSetting(SETTING_AA_FILTER_LENGTH, tier >= QualityGovernor::shortAAFilter ? 32 : 64);
+    engine.setSetting(SETTING_TRANSPOSER_ALGORITHM, tier >= QualityGovernor::linearInterpolation ? 0 : 1);
+}
+
+void DAFAudioProcessor::requestPitchEngines()
+{
+    // Desde el hilo de audio (p.ej. el host automatiza el pitch): los crea el de mensajes
+    if (!pitchEnginesRequested.exchange(true))
+        triggerAsyncUpdate();
+}
+
+void DAFAudioProcessor::requestProfileSwap()
+{
+    // Desde el hilo de audio: los motores con el perfil nuevo los crea el de mensajes
+    int expected = profileIdle;
+    if (profileSwapState.compare_exchange_strong(expected, profileRequested))
+        triggerAsyncUpdate();
+}
+
+void DAFAudioProcessor::createProfileEngines()
+{
+    // Desde el hilo de mensajes. El hilo de audio sigue con los motores actuales
+    // y no toca pendingPitchEngine hasta que se publica profileReady
+    DAF_TRACE_SCOPE("createProfileEngines");
+    const double sampleRate = getSampleRate();
+    const bool speechProfile = isSpeechProfileEnabled();
+
+    for (int ch = 0; ch < 2; ++ch)
+    {
+        if (pitchEngine[ch] == nullptr)
+            continue;
+
+        pendingPitchEngine[ch].reset(soundtouch::SoundTouchEngine::newInstance(getPitchEngineFormat(sampleRate)));
+        preparePitchEngine(*pendingPitchEngine[ch], sampleRate, speechProfile);
+    }
+
+    // Como en createPitchEngines, pero acabando en el nivel en que está ahora el
+    // gobernador. Si cambia antes del cambio de motores, processBlock aplica el
+    // nuevo igual que con los actuales, sin reservar nada
+    const auto tier = qualityGovernor.getTier();
+    warmPitchEngines(pendingPitchEngine, tier);
+
+    pendingQualityTier = tier;
+    pendingSpeechProfile = speechProfile;
+    pendingPitchLatency.store(measurePitchLatency(sampleRate, speechProfile));
+    profileSwapState.store(profileReady, std::memory_order_release);
+}
+
+void DAFAudioProcessor::applyProfileSwap()
+{
+    // Los motores nuevos solo entran con el pitch en bypass. Si estaba activo,
+    // processBlock lo saca antes con el crossfade, y luego vuelve a entrar cebando
+    // los nuevos como cualquier otra entrada
+    if (profileSwapState.load(std::memory_order_acquire) != profileReady || pitchState != PitchState::bypassed)
+        return;
+
+    for (int ch = 0; ch < 2; ++ch)
+        std::swap(pitchEngine[ch], pendingPitchEngine[ch]);
+
+    speechProfileApplied = pendingSpeechProfile;
+    qualityTierApplied = pendingQualityTier;
+
+    const int latency = pendingPitchLatency.load();
+    pitchLatencySamples.store(latency);
+
+    for (auto& preroll : pitchPrerollRemaining)
+        preroll = latency;
+
+    // Los motores antiguos quedan en pendingPitchEngine: los libera el hilo de
+    // mensajes, que también publica la nueva latencia al host
+    profileSwapState.store(profileRetired, std::memory_order_release);
+    triggerAsyncUpdate();
+}
+
+int DAFAudioProcessor::measurePitchLatency(double sampleRate, bool speechProfile)
+{
+    // Peor caso de todo el rango del parámetro, así el retardo total no cambia al
+    // mover el pitch. Se mide en un motor aparte con la misma configuración que
+    // los de verdad: cambiarle el pitch altera su estado, y los de verdad pueden
+    // estar sonando
+    std::unique_ptr<soundtouch::SoundTouchEngine> engine(soundtouch::SoundTouchEngine::newInstance(getPitchEngineFormat(sampleRate)));
+    preparePitchEngine(*engine, sampleRate, speechProfile);
+    applyQualityTier(*engine, QualityGovernor::fullQuality);
+
+    const auto range = apvts.getParameterRange("pitch");
+    int latency = 0;
+
+    for (float semitones = range.start; semitones <= range.end; semitones += pitchUiStepSemitones)
+    {
+        engine->setPitchSemiTones(semitones);
+        latency = jmax(latency, engine->getOutputLatency());
+    }
+
+    return latency;
+}
+
+void DAFAudioProcessor::handleAsyncUpdate()
+{
+    if (pitchEnginesRequested.load() && !pitchEnginesReady.load())
+        createPitchEngines();
+
+    // Cambio de perfil de voz pedido desde el hilo de audio: aquí se crean los
+    // motores nuevos y, una vez cambiados, se liberan los antiguos
+    const int profileState = profileSwapState.load(std::memory_order_acquire);
+
+    if (profileState == profileRequested)
+    {
+        createProfileEngines();
+    }
+    else if (profileState == profileRetired)
+    {
+        for (auto& engine : pendingPitchEngine)
+            engine.reset();
+
+        profileSwapState.store(profileIdle, std::memory_order_release);
+    }
+
+    // setLatencySamples notifica al host, mejor fuera del hilo de audio
+    setLatencySamples(pitchLatencySamples.load());
+
+    // Cambio de tamaño de la línea de delay pedido desde el hilo de audio: aquí
+    // se reserva la nueva y, una vez cambiada, se libera la antigua
+    const int state = delayResizeState.load(std::memory_order_acquire);
+
+    if (state == resizeRequested)
+    {
+        const int capacity = juce::nextPowerOfTwo(requestedDelaySamples.load(std::memory_order_relaxed) + 1);
+        allocateDelayBuffer(pendingDelayBuffer, numDelayChannels, capacity);
+        updateMemoryUsage();
+        delayResizeState.store(resizeReady, std::memory_order_release);
+        DBG("[DAF] Línea de delay ampliada a " << capacity << " muestras");
+    }
+    else if (state == resizeRetired)
+    {
+        cancelDelayResize();
+        updateMemoryUsage();
+    }
+}
+
+int DAFAudioProcessor::getDelayCapacity(double sampleRate, float maxDelayMs)
+{
+    // Potencia de dos mayor que el delay máximo en muestras, para que la lectura
+    // más antigua nunca alcance a la escritura
+    return juce::nextPowerOfTwo(static_cast<int>(std::ceil(maxDelayMs / 1000.0 * sampleRate)) + 1);
+}
+
+void DAFAudioProcessor::setMaxDelayMs(float newMaxDelayMs)
+{
+    maxDelayMs.store(newMaxDelayMs);
+}
+
+float DAFAudioProcessor::getMaxDelayMs() const
+{
+    const float rangeEnd = apvts.getParameterRange("delayTime").end;
+    const float limit = maxDelayMs.load();
+    return limit > 0.0f ? jmin(limit, rangeEnd) : rangeEnd;
+}
+
+void DAFAudioProcessor::setDelayMemoryLocked(bool shouldLock)
+{
+    if (lockDelayMemory == shouldLock)
+        return;
+
+    lockDelayMemory = shouldLock;
+
+    // La línea actual se bloquea o libera ahora, salvo que el hilo de audio esté
+    // a punto de cambiarla: entonces la nueva ya se reservó con el ajuste anterior
+    // y la antigua se va a liberar
+    if (delayResizeState.load(std::memory_order_acquire) != resizeReady)
+    {
+        lockDelayBuffer(delayBuffer, shouldLock);
+        updateMemoryUsage();
+    }
+}
+
+void DAFAudioProcessor::allocateDelayBuffer(juce::AudioBuffer<float>& target, int numChannels, int numSamples)
+{
+    lockDelayBuffer(target, false);
+    target.setSize(numChannels, numSamples);
+
+    // Escribir todas las páginas ahora (prefault), para que el hilo de audio no
+    // pague los fallos de página la primera vez que pasa por ellas
+    for (int ch = 0; ch < numChannels; ++ch)
+        juce::FloatVectorOperations::clear(target.getWritePointer(ch), numSamples);
+
+    if (&target == &delayBuffer)
+    {
+        numDelayChannels = numChannels;
+        for (auto& position : writePositions)
+            position.store(0);
+    }
+
+    if (lockDelayMemory)
+        lockDelayBuffer(target, true);
+}
+
+void DAFAudioProcessor::lockDelayBuffer(juce::AudioBuffer<float>& target, bool shouldLock)
+{
+    const size_t bytes = sizeof(float) * static_cast<size_t>(target.getNumSamples());
+
+    for (int ch = 0; ch < target.getNumChannels() && bytes > 0; ++ch)
+    {
+       #if JUCE_MAC || JUCE_IOS || JUCE_LINUX || JUCE_ANDROID
+        const void* data = target.getReadPointer(ch);
+        if ((shouldLock ? mlock(data, bytes) : munlock(data, bytes)) != 0)
+            DBG("[DAF] " << (shouldLock ? "mlock" : "munlock") << " de la línea de delay falló");
+       #else
+        juce::ignoreUnused(shouldLock);
+       #endif
+    }
+}
+
+void DAFAudioProcessor::requestDelayCapacity(int numSamples)
+{
+    // El tamaño va antes que el estado: handleAsyncUpdate también corre por otros
+    // motivos y puede ver resizeRequested en cuanto se publica. Si ya había una
+    // petición en curso, el tamaño nuevo es igual de válido (también supera la
+    // línea actual)
+    requestedDelaySamples.store(numSamples, std::memory_order_relaxed);
+
+    int expected = resizeIdle;
+    if (delayResizeState.compare_exchange_strong(expected, resizeRequested, std::memory_order_release, std::memory_order_relaxed))
+        triggerAsyncUpdate();
+}
+
+void DAFAudioProcessor::applyDelayResize()
+{
+    if (delayResizeState.load(std::memory_order_acquire) != resizeReady)
+        return;
+
+    // Copiar la historia al principio de la nueva línea, de la muestra más antigua
+    // a la más reciente, y seguir escribiendo justo detrás: el delay no salta
+    const int oldSize = delayBuffer.getNumSamples();
+
+    // Una línea que no es mayor que la actual (o con otros canales) no puede
+    // recibir la historia: se devuelve para liberarla y, si aún hace falta, el
+    // bloque la vuelve a pedir
+    if (pendingDelayBuffer.getNumSamples() <= oldSize || pendingDelayBuffer.getNumChannels() < numDelayChannels)
+    {
+        jassertfalse;
+        delayResizeState.store(resizeRetired, std::memory_order_release);
+        triggerAsyncUpdate();
+        return;
+    }
+
+    for (int ch = 0; ch < numDelayChannels; ++ch)
+    {
+        const int writePos = writePositions[ch].load();
+        pendingDelayBuffer.copyFrom(ch, 0, delayBuffer, ch, writePos, oldSize - writePos);
+        pendingDelayBuffer.copyFrom(ch, oldSize - writePos, delayBuffer, ch, 0, writePos);
+        writePositions[ch].store(oldSize);
+    }
+
+    std::swap(delayBuffer, pendingDelayBuffer);
+    delayResizeState.store(resizeRetired, std::memory_order_release);
+    triggerAsyncUpdate();
+}
+
+void DAFAudioProcessor::cancelDelayResize()
+{
+    // Desde el hilo de mensajes: libera la línea pendiente o la ya sustituida
+    lockDelayBuffer(pendingDelayBuffer, false);
+    pendingDelayBuffer.setSize(0, 0);
+    delayResizeState.store(resizeIdle, std::memory_order_release);
+}
+
+void DAFAudioProcessor::updateMemoryUsage()
+{
+    const auto bufferBytes = [] (const juce::AudioBuffer<float>& b)
+    {
+        return sizeof(float) * static_cast<size_t>(b.getNumChannels()) * static_cast<size_t>(b.getNumSamples());
+    };
+
+    const size_t pendingBytes = delayResizeState.load() == resizeIdle ? 0 : bufferBytes(pendingDelayBuffer);
+    delayMemoryBytes.store(bufferBytes(delayBuffer) + pendingBytes);
+    lockedMemoryBytes.store(lockDelayMemory ? bufferBytes(delayBuffer) + pendingBytes : 0);
+    fadeMemoryBytes.store(fadeRamp.getMemoryBytes() + pitchRamp.getMemoryBytes() + stereoRamp.getMemoryBytes() + bufferBytes(pitchDryBuffer));
+}
+
+DAFAudioProcessor::MemoryUsage DAFAudioProcessor::getMemoryUsage() const
+{
+    MemoryUsage usage;
+    usage.delayBytes = delayMemoryBytes.load();
+    usage.fadeBytes = fadeMemoryBytes.load();
+    usage.lockedBytes = lockedMemoryBytes.load();
+    return usage;
+}
+
 void DAFAudioProcessor::releaseResources()
 {
-    fadeBuffer.setSize(0, 0);
 }
 
 void DAFAudioProcessor::processBlock(juce::AudioBuffer<float>& buffer, juce::MidiBuffer&)
 {
+    DAF_TRACE_THREAD_NAME("audio");
+    DAF_TRACE_SCOPE("processBlock");
     juce::ScopedNoDenormals noDenormals;
-    const int numChannels = buffer.getNumChannels();
     const int numSamples = buffer.getNumSamples();
+    const auto blockStart = std::chrono::steady_clock::now();
+
+    applyDelayResize();
+    handleCommands();
 
-    if (!processingEnabled) {
+    if (runState == RunState::stopped) {
         buffer.clear();
         resetLevels();
+        clearDelayBufferChunk(delayClearChunkSamples);
         return;
     }
 
-    // 1. Limpiar buffer de fade y copiar datos de entrada
-    fadeBuffer.makeCopyOf(buffer, true);
+    perfCounters.beginBlock(numSamples, getSampleRate());
+    PerfCounters::ScopedStage totalStage(perfCounters, PerfCounters::total);
+
+    // Con entrada mono, o dos canales iguales, la cadena corre sobre un solo
+    // canal y ensureStereo lo copia a las salidas al final
+    const int numChannels = getNumProcessChannels(buffer);
 
-    // 2. Aplicar fade-in si está activo
-    if (isFadingIn)
     {
-        for (int i = 0; i < numSamples; ++i)
+        PerfCounters::ScopedStage fadeStage(perfCounters, PerfCounters::fade);
+        DAF_TRACE_SCOPE("fade");
+
+        // 1. Aplicar fade-in o fade-out in situ, sin coste fuera de los fades. Si
+        // el fade termina a mitad de bloque, el resto va con la ganancia final
+        if (fadeRamp.isRamping())
         {
-            // Calcular ganancia actual del fade
-            if (fadeCounter < fadeLengthInSamples)
-            {
-                fadeGain = static_cast<float>(fadeCounter) / static_cast<float>(fadeLengthInSamples);
-                fadeCounter++;
-            }
-            else
-            {
-                fadeGain = 1.0f;
-                isFadingIn = false; // Fade completado
-            }
-            
-            // Aplicar fade a todas las muestras
-            for (int ch = 0; ch < numChannels; ++ch)
-            {
-                buffer.getWritePointer(ch)[i] = fadeBuffer.getReadPointer(ch)[i] * fadeGain;
-            }
+            fadeRamp.process(buffer.getArrayOfWritePointers(), numChannels, numSamples);
+            updateRunState();
         }
     }
 
+    // 2. Ganancia de entrada, antes de escribir en la línea de delay: lo que se
+    // retrasa y lo que entra a SoundTouch ya va con ella
+    inputGainSmoother.setTargetValue(juce::Decibels::decibelsToGain(apvts.getRawParameterValue("inputGain")->load()));
+    applyInputGain(buffer, numChannels);
+
     // 3. Obtener parámetros
     float delayTimeMs = apvts.getRawParameterValue("delayTime")->load();
-    float pitchShift = apvts.getRawParameterValue("pitch")->load();
+    float pitchShift = snapPitchSemitones(apvts.getRawParameterValue("pitch")->load());
+    const bool speechProfile = isSpeechProfileEnabled();
 
-    // 4. Procesamiento de delay (si está activo)
-    if (delayTimeMs > 0.0f) {
-        const float delaySamples = (delayTimeMs / 1000.0f) * getSampleRate();
+    const bool enginesReady = pitchEnginesReady.load(std::memory_order_acquire);
+
+    // El perfil de voz cambia de motores: mientras los nuevos están listos para
+    // entrar, el pitch sale a bypass para cambiarlos allí
+    if (enginesReady && speechProfile != speechProfileApplied)
+        requestProfileSwap();
+
+    applyProfileSwap();
+    const bool profileSwapPending = profileSwapState.load(std::memory_order_acquire) == profileReady;
+
+    // El pitch entra y sale con crossfade: mientras dura (y mientras se ceba el
+    // motor) hace falta también la señal seca, que sale de la línea de delay
+    updatePitchState(std::abs(pitchShift) > pitchBypassSemitones && !profileSwapPending);
+    const bool pitchOn = pitchState != PitchState::bypassed;
+    const bool needDry = pitchOn && pitchState != PitchState::active;
+
+    if (needDry && numSamples > pitchDryBuffer.getNumSamples())
+    {
+        jassertfalse; // Bloque mayor que el de prepareToPlay
+        pitchDryBuffer.setSize(numChannels, numSamples, false, false, true);
+    }
+
+    // 4. Procesamiento de delay. Con los motores de pitch creados, el retardo total
+    // es el del usuario o la latencia de pitch si es mayor, con pitch o sin él: la
+    // entrada de SoundTouch se lee de la línea latencia muestras antes que la seca.
+    // La primera vez que se crean, un delay menor que la latencia sube a ella
+    const int pitchLatency = enginesReady ? pitchLatencySamples.load() : 0;
+    int pitchInputStart = 0;
+    const float totalDelaySamples = jmax((delayTimeMs / 1000.0f) * static_cast<float>(getSampleRate()),
+                                         static_cast<float>(pitchLatency));
+
+    if (totalDelaySamples > 0.0f || needDry) {
+        PerfCounters::ScopedStage delayStage(perfCounters, PerfCounters::delay);
+        DAF_TRACE_SCOPE("delay");
+        int drySamples = static_cast<int>(totalDelaySamples);
         const int delayBufferSize = delayBuffer.getNumSamples();
 
+        // Más delay del que cabe (p.ej. un ajuste guardado por encima del límite
+        // de la UI): se recorta mientras el hilo de mensajes amplía la línea
+        if (drySamples >= delayBufferSize)
+        {
+            requestDelayCapacity(drySamples);
+            drySamples = delayBufferSize - 1;
+        }
+
+        const int delaySamples = pitchOn ? jmax(0, drySamples - pitchLatency) : drySamples;
+        pitchInputStart = (writePositions[0].load() - delaySamples + delayBufferSize) % delayBufferSize;
+
         for (int ch = 0; ch < numChannels; ++ch) {
             float* channelData = buffer.getWritePointer(ch);
+            float* dryData = needDry ? pitchDryBuffer.getWritePointer(ch) : nullptr;
             int writePos = writePositions[ch].load();
 
             for (int i = 0; i < numSamples; ++i) {
                 delayBuffer.setSample(ch, writePos, channelData[i]);
-                int readPos = (writePos - static_cast<int>(delaySamples) + delayBufferSize) % delayBufferSize;
+                int readPos = (writePos - delaySamples + delayBufferSize) % delayBufferSize;
                 channelData[i] = delayBuffer.getSample(ch, readPos);
+
+                if (dryData != nullptr)
+                    dryData[i] = delayBuffer.getSample(ch, (writePos - drySamples + delayBufferSize) % delayBufferSize);
+
                 writePos = (writePos + 1) % delayBufferSize;
             }
             writePositions[ch].store(writePos);
         }
+
+        delayDirtySamples = jmin(delayBufferSize, delayDirtySamples + numSamples);
     }
 
-    // 5. Procesamiento de pitch (con manejo especial de SoundTouch)
-    if (std::abs(pitchShift) > 0.1f) {
-        // Buffer temporal para acumular salida procesada
-        juce::AudioBuffer<float> pitchBuffer(numChannels, numSamples);
-        pitchBuffer.clear();
+    // 5. Procesamiento de pitch. SoundTouch entrega audio a ráfagas: la salida de
+    // un motor nuevo empieza con pitchLatencySamples de silencio y a partir de
+    // ahí fluye sin huecos
+    if (pitchOn) {
+        PerfCounters::ScopedStage pitchStage(perfCounters, PerfCounters::pitch);
+        DAF_TRACE_SCOPE("pitch");
+
+        if (rightPitchEnginePending && numChannels > 1)
+            primeRightPitchEngine(pitchInputStart, pitchLatency, numSamples);
 
         for (int ch = 0; ch < numChannels; ++ch) {
             float* channelData = buffer.getWritePointer(ch);
-            pitchEngine[ch].setPitchSemiTones(pitchShift);
+            pitchEngine[ch]->setPitchSemiTones(pitchShift);
             
             // 1. Enviar muestras a SoundTouch
-            pitchEngine[ch].putSamples(channelData, numSamples);
-            
-            // 2. Recibir muestras procesadas
-            int received = pitchEngine[ch].receiveSamples(pitchBuffer.getWritePointer(ch), numSamples);
+            {
+                DAF_TRACE_SCOPE("soundtouch.putSamples");
+                pitchEngine[ch]->putSamples(channelData, static_cast<unsigned int>(numSamples));
+            }
             
-            // 3. Si no hay suficientes muestras, forzar flush
-            if (received < numSamples) {
-                pitchEngine[ch].flush();
-                received += pitchEngine[ch].receiveSamples(pitchBuffer.getWritePointer(ch) + received, numSamples - received);
+            // 2. Silencio inicial pendiente y muestras procesadas
+            const int silent = jmin(pitchPrerollRemaining[ch], numSamples);
+            const int wanted = numSamples - silent;
+            pitchPrerollRemaining[ch] -= silent;
+
+            int received = 0;
+            {
+                DAF_TRACE_SCOPE("soundtouch.receiveSamples");
+                received = static_cast<int>(pitchEngine[ch]->receiveSamples(channelData + silent, static_cast<unsigned int>(wanted)));
+            }
+
+            // 3. Si aun así faltan muestras (p.ej. justo tras un cambio de pitch), el
+            // hueco va en silencio delante de lo recibido en vez de cortar el audio
+            if (received < wanted) {
+                const int missing = wanted - received;
+                std::memmove(channelData + silent + missing, channelData + silent, sizeof(float) * static_cast<size_t>(received));
+                juce::FloatVectorOperations::clear(channelData + silent, missing);
             }
+
+            juce::FloatVectorOperations::clear(channelData, silent);
         }
-        
-        // Reemplazar buffer original con el procesado
-        for (int ch = 0; ch < numChannels; ++ch) {
-            buffer.copyFrom(ch, 0, pitchBuffer, ch, 0, numSamples);
+
+        // Motor derecho recién cebado: el canal derecho sigue con la salida del
+        // izquierdo, que es la que tenía hasta ahora, y pasa a la suya
+        if (numChannels > 1 && stereoRamp.isRamping())
+        {
+            float* right = buffer.getWritePointer(1);
+            const float* left = buffer.getReadPointer(0);
+            stereoRamp.processCrossfade(&right, &left, 1, numSamples);
         }
+
+        finishPitchBlock(buffer, numChannels, numSamples);
+    }
+    else {
+        // Sin pitch, el motor derecho se ceba con el resto al salir del bypass, y
+        // un crossfade a medias ya no hace falta: la salida es la señal seca
+        rightPitchEnginePending = false;
+        if (stereoRamp.isRamping())
+            stereoRamp.setGain(true);
+    }
+
+    // 6. Copiar el canal procesado a las salidas que no se procesaron
+    ensureStereo(buffer, numChannels);
+
+    // 7. Calidad de SoundTouch para los próximos bloques según lo que ha costado este
+    const auto elapsedNs = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - blockStart).count();
+    const auto tier = qualityGovernor.update(static_cast<uint64_t>(elapsedNs), numSamples, getSampleRate(), isNonRealtime());
+
+    if (enginesReady && tier != qualityTierApplied)
+    {
+        for (int ch = 0; ch < numDelayChannels; ++ch)
+            applyQualityTier(*pitchEngine[ch], tier);
+
+        qualityTierApplied = tier;
+    }
+}
+
+void DAFAudioProcessor::primeRightPitchEngine(int inputStart, int pitchLatency, int chunkSamples)
+{
+    DAF_TRACE_SCOPE("primeRightPitchEngine");
+
+    // Las pitchLatency muestras de entrada anteriores a este bloque, que son las
+    // mismas que vio el motor izquierdo (la línea derecha es copia de la
+    // izquierda). Van en trozos del tamaño del bloque, como la entrada normal,
+    // para que los buffers de SoundTouch no crezcan. Con eso el silencio inicial
+    // queda cubierto y la salida del motor sale ya alineada con la del izquierdo
+    const int delayBufferSize = delayBuffer.getNumSamples();
+    const float* history = delayBuffer.getReadPointer(1);
+    int position = (inputStart - pitchLatency + delayBufferSize) % delayBufferSize;
+    int remaining = pitchLatency;
+
+    while (remaining > 0)
+    {
+        const int count = jmin(remaining, chunkSamples, delayBufferSize - position);
+        pitchEngine[1]->putSamples(history + position, static_cast<unsigned int>(count));
+        position = (position + count) % delayBufferSize;
+        remaining -= count;
+    }
+
+    pitchPrerollRemaining[1] = 0;
+    rightPitchEnginePending = false;
+    stereoRamp.setGain(false);
+    stereoRamp.rampUp();
+}
+
+void DAFAudioProcessor::updatePitchState(bool pitchWanted)
+{
+    // Sin motores todavía se sigue en bypass hasta que el hilo de mensajes los cree
+    const bool enginesReady = pitchEnginesReady.load(std::memory_order_acquire);
+    if (pitchWanted && !enginesReady)
+        requestPitchEngines();
+
+    pitchWanted = pitchWanted && enginesReady;
+
+    switch (pitchState)
+    {
+        case PitchState::bypassed:
+            // El motor sigue con lo que tenía al aparcarlo: la salida se descarta
+            // hasta que eso haya salido, en vez de limpiarlo
+            if (pitchWanted)
+            {
+                pitchState = PitchState::priming;
+                pitchPrimingRemaining = pitchLatencySamples.load();
+            }
+            break;
+
+        case PitchState::priming:
+            if (!pitchWanted)
+                pitchState = PitchState::bypassed;
+            break;
+
+        case PitchState::fadingIn:
+        case PitchState::active:
+            if (!pitchWanted)
+            {
+                pitchState = PitchState::fadingOut;
+                pitchRamp.rampDown();
+            }
+            break;
+
+        case PitchState::fadingOut:
+            // Un crossfade a medias se invierte desde la ganancia actual
+            if (pitchWanted)
+            {
+                pitchState = PitchState::fadingIn;
+                pitchRamp.rampUp();
+            }
+            break;
     }
 }
 
+void DAFAudioProcessor::finishPitchBlock(juce::AudioBuffer<float>& buffer, int numChannels, int numSamples)
+{
+    if (pitchState == PitchState::priming)
+    {
+        // Salida de SoundTouch descartada: sale la señal seca
+        for (int ch = 0; ch < numChannels; ++ch)
+            buffer.copyFrom(ch, 0, pitchDryBuffer, ch, 0, numSamples);
+
+        pitchPrimingRemaining -= numSamples;
+        if (pitchPrimingRemaining <= 0)
+        {
+            pitchState = PitchState::fadingIn;
+            pitchRamp.rampUp();
+        }
+    }
+    else if (pitchState == PitchState::fadingIn || pitchState == PitchState::fadingOut)
+    {
+        pitchRamp.processCrossfade(buffer.getArrayOfWritePointers(), pitchDryBuffer.getArrayOfReadPointers(), numChannels, numSamples);
+
+        // Crossfade completado. Al salir, los motores se quedan aparcados tal cual
+        if (!pitchRamp.isRamping())
+            pitchState = pitchState == PitchState::fadingIn ? PitchState::active : PitchState::bypassed;
+    }
+}
+
+int DAFAudioProcessor::getNumProcessChannels(const juce::AudioBuffer<float>& buffer)
+{
+    const int numChannels = jmin(buffer.getNumChannels(), delayBuffer.getNumChannels());
+
+    if (numChannels < 2 || stereoInputSeen)
+        return numChannels;
+
+    // Entrada estéreo con los dos canales iguales (p.ej. el sistema duplica el
+    // micrófono): se procesa como mono hasta que difieran por primera vez
+    const size_t bytes = sizeof(float) * static_cast<size_t>(buffer.getNumSamples());
+    if (std::memcmp(buffer.getReadPointer(0), buffer.getReadPointer(1), bytes) == 0)
+        return 1;
+
+    // El canal derecho arranca con el estado del izquierdo, que es el que se ha
+    // procesado hasta ahora. Solo pasa una vez por prepareToPlay
+    stereoInputSeen = true;
+    delayBuffer.copyFrom(1, 0, delayBuffer, 0, 0, delayBuffer.getNumSamples());
+    writePositions[1].store(writePositions[0].load());
+
+    // El motor derecho no ha visto nada mientras se procesaba en mono. Con el
+    // pitch en marcha, la etapa de pitch lo ceba con la misma entrada que tuvo el
+    // izquierdo y el canal derecho pasa de la salida de este a la suya con un
+    // crossfade; si no, lo ceba la entrada normal desde el bypass
+    if (pitchEnginesReady.load(std::memory_order_acquire) && pitchEngine[1] != nullptr)
+    {
+        pitchEngine[1]->clear();
+        pitchPrerollRemaining[1] = pitchLatencySamples.load();
+        rightPitchEnginePending = true;
+    }
+
+    return 2;
+}
+
+void DAFAudioProcessor::ensureStereo(juce::AudioBuffer<float>& buffer, int numProcessedChannels)
+{
+    for (int ch = numProcessedChannels; ch < buffer.getNumChannels(); ++ch)
+        buffer.copyFrom(ch, 0, buffer, 0, 0, buffer.getNumSamples());
+}
+
 juce::AudioProcessorEditor* DAFAudioProcessor::createEditor()
 {
     return new juce::GenericAudioProcessorEditor(*this);
@@ -195,7 +893,15 @@ const juce::String DAFAudioProcessor::getName() const { return "DAF Processor";
 bool DAFAudioProcessor::acceptsMidi() const { return false; }
 bool DAFAudioProcessor::producesMidi() const { return false; }
 bool DAFAudioProcessor::isMidiEffect() const { return false; }
-double DAFAudioProcessor::getTailLengthSeconds() const { return 2.0; }
+double DAFAudioProcessor::getTailLengthSeconds() const
+{
+    // El retardo total es el delay elegido, o la latencia de pitch si es mayor
+    const double sampleRate = getSampleRate();
+    const double maxDelaySeconds = apvts.getParameterRange("delayTime").end / 1000.0;
+    const double pitchLatencySeconds = sampleRate > 0.0 ? pitchLatencySamples.load() / sampleRate : 0.0;
+
+    return jmax(maxDelaySeconds, pitchLatencySeconds);
+}
 int DAFAudioProcessor::getNumPrograms() { return 1; }
 int DAFAudioProcessor::getCurrentProgram() { return 0; }
 void DAFAudioProcessor::setCurrentProgram(int) {}
@@ -229,28 +935,109 @@ void DAFAudioProcessor::setDelayTimeMs(float newValue)
 
 void DAFAudioProcessor::setProcessingEnabled(bool shouldProcess)
 {
-    if (shouldProcess && !processingEnabled)
+    if (processingEnabled.exchange(shouldProcess) == shouldProcess)
+        return;
+
+    // Si la cola está llena es que el audio no está corriendo: prepareToPlay
+    // arrancará desde processingEnabled
+    if (!pushCommand(shouldProcess ? AudioCommand::start : AudioCommand::stop))
+        DBG("[DAF] Cola de órdenes llena");
+}
+
+bool DAFAudioProcessor::pushCommand(AudioCommand command)
+{
+    const auto scope = commandFifo.write(1);
+    if (scope.blockSize1 + scope.blockSize2 == 0)
+        return false;
+
+    commandBuffer[static_cast<size_t>(scope.startIndex1)] = command;
+    return true;
+}
+
+bool DAFAudioProcessor::popCommand(AudioCommand& command)
+{
+    const auto scope = commandFifo.read(1);
+    if (scope.blockSize1 + scope.blockSize2 == 0)
+        return false;
+
+    command = commandBuffer[static_cast<size_t>(scope.startIndex1)];
+    return true;
+}
+
+void DAFAudioProcessor::handleCommands()
+{
+    AudioCommand command;
+
+    while (popCommand(command))
     {
-        // Resetear buffers y preparar fade-in
-        delayBuffer.clear();
-        for (auto& engine : pitchEngine) {
-            engine.clear();
+        switch (command)
+        {
+            case AudioCommand::start:
+                if (runState == RunState::stopped)
+                {
+                    // Resetear buffers: lo que quede por limpiar del delay se
+                    // limpia ahora, antes de volver a leerlo
+                    clearDelayBufferChunk(delayBuffer.getNumSamples());
+                    fadeRamp.setGain(false);
+
+                    // El pitch vuelve a entrar cebando los motores, sin limpiarlos
+                    pitchState = PitchState::bypassed;
+                    pitchRamp.setGain(false);
+                }
+
+                // Un fade-out a medias se invierte desde la ganancia actual
+                if (runState != RunState::running)
+                {
+                    runState = RunState::fadingIn;
+                    fadeRamp.rampUp();
+                }
+                break;
+
+            case AudioCommand::stop:
+                if (runState != RunState::stopped)
+                {
+                    runState = RunState::fadingOut;
+                    fadeRamp.rampDown();
+                }
+                break;
         }
-        
-        // Configurar parámetros del fade-in
-        isFadingIn = true;
-        fadeGain = 0.0f;
-        fadeCounter = 0;
-        fadeLengthInSamples = static_cast<int>(fadeDurationSeconds * getSampleRate());
     }
-    else if (!shouldProcess && processingEnabled)
+
+    // Un arranque y una parada en el mismo bloque pueden dejar el fade ya terminado
+    updateRunState();
+}
+
+void DAFAudioProcessor::updateRunState()
+{
+    if (fadeRamp.isRamping())
+        return;
+
+    // Fade completado. Al parar, delayBuffer se limpia en los bloques siguientes
+    if (runState == RunState::fadingIn)
+        runState = RunState::running;
+    else if (runState == RunState::fadingOut)
+        runState = RunState::stopped;
+}
+
+void DAFAudioProcessor::clearDelayBufferChunk(int maxSamples)
+{
+    // Solo hay que limpiar lo escrito: las delayDirtySamples muestras anteriores a
+    // la posición de escritura, de la más antigua en adelante
+    int count = jmin(maxSamples, delayDirtySamples);
+    if (count <= 0)
+        return;
+
+    const int size = delayBuffer.getNumSamples();
+    int start = (writePositions[0].load() - delayDirtySamples + size) % size;
+    delayDirtySamples -= count;
+
+    while (count > 0)
     {
-        // Resetear el fade cuando se desactiva
-        isFadingIn = false;
-        fadeGain = 0.0f;
+        const int length = jmin(count, size - start);
+        delayBuffer.clear(start, length);
+        start = 0;
+        count -= length;
     }
-    
-    processingEnabled = shouldProcess;
 }
 
 float DAFAudioProcessor::getCurrentLevel(int channel) const
@@ -287,6 +1074,11 @@ bool DAFAudioProcessor::isBusesLayoutSupported(const BusesLayout& layouts) const
 
 void DAFAudioProcessor::setPitchShiftSemitones(float value)
 {
+    // Primer uso del pitch desde la UI: los motores se crean ya, sin esperar a
+    // que los pida el hilo de audio
+    if (std::abs(value) > pitchBypassSemitones)
+        createPitchEngines();
+
     if (auto* p = apvts.getParameter("pitch"))
         p->setValueNotifyingHost(p->getNormalisableRange().convertTo0to1(value));
 }
@@ -296,62 +1088,48 @@ float DAFAudioProcessor::getPitchShiftSemitones() const
     return *apvts.getRawParameterValue("pitch");
 }
 
-void DAFAudioProcessor::resetLevels() {
-    currentLevels[0].store(0.0f);
-    currentLevels[1].store(0.0f);
+float DAFAudioProcessor::snapPitchSemitones(float semitones)
+{
+    // Los motores solo ven pasos de la rejilla del slider, que son los que tienen
+    // el filtro anti-alias precalculado: un valor automatizado fuera de ella
+    // diseñaría uno nuevo en el hilo de audio
+    return std::round(semitones / pitchUiStepSemitones) * pitchUiStepSemitones;
 }
 
-void DAFAudioProcessor::applyInputGain(juce::AudioBuffer<float>& buffer) {
-    for (int i = 0; i < buffer.getNumSamples(); ++i) {
-        const float gain = inputGainSmoother.getNextValue();
-        for (int ch = 0; ch < buffer.getNumChannels(); ++ch) {
-            buffer.getWritePointer(ch)[i] *= gain;
-        }
-    }
+void DAFAudioProcessor::setSpeechProfileEnabled(bool shouldBeEnabled)
+{
+    if (auto* p = apvts.getParameter("speechProfile"))
+        p->setValueNotifyingHost(shouldBeEnabled ? 1.0f : 0.0f);
 }
 
-void DAFAudioProcessor::updateInputLevels(const juce::AudioBuffer<float>& buffer) {
-    for (int ch = 0; ch < buffer.getNumChannels(); ++ch) {
-        const float* data = buffer.getReadPointer(ch);
-        float sum = 0.0f;
-        for (int i = 0; i < buffer.getNumSamples(); ++i) {
-            sum += data[i] * data[i];
-        }
-        currentLevels[ch].store(std::sqrt(sum / buffer.getNumSamples()));
-    }
+bool DAFAudioProcessor::isSpeechProfileEnabled() const
+{
+    return apvts.getRawParameterValue("speechProfile")->load() >= 0.5f;
 }
 
-void DAFAudioProcessor::updateOutputLevels(const juce::AudioBuffer<float>& buffer) {
-    for (int ch = 0; ch < buffer.getNumChannels(); ++ch) {
-        const float* data = buffer.getReadPointer(ch);
-        float sum = 0.0f;
-        for (int i = 0; i < buffer.getNumSamples(); ++i) {
-            sum += data[i] * data[i];
-        }
-        currentLevels[ch].store(std::sqrt(sum / buffer.getNumSamples()));
-    }
+void DAFAudioProcessor::resetLevels() {
+    currentLevels[0].store(0.0f);
+    currentLevels[1].store(0.0f);
 }
 
-void DAFAudioProcessor::processStereoDelay(juce::AudioBuffer<float>& buffer, float delayTimeMs, float mix) {
-    const float delaySamples = (delayTimeMs / 1000.0f) * getSampleRate();
-    const int delayBufferSize = delayBuffer.getNumSamples();
-
-    juce::AudioBuffer<float> dryBuffer;
-    dryBuffer.makeCopyOf(buffer);
+void DAFAudioProcessor::applyInputGain(juce::AudioBuffer<float>& buffer, int numChannels) {
+    // In situ y solo en los canales procesados: rampa por muestra solo mientras
+    // cambia la ganancia, y una sola multiplicación vectorial (o nada, con
+    // ganancia 1) el resto del tiempo
+    const int numSamples = buffer.getNumSamples();
 
-    for (int channel = 0; channel < buffer.getNumChannels(); ++channel) {
-        float* channelData = buffer.getWritePointer(channel);
-        int writePos = writePositions[channel].load();
+    if (!inputGainSmoother.isSmoothing()) {
+        for (int ch = 0; ch < numChannels; ++ch)
+            buffer.applyGain(ch, 0, numSamples, inputGainSmoother.getTargetValue());
+        return;
+    }
 
-        for (int i = 0; i < buffer.getNumSamples(); ++i) {
-            delayBuffer.setSample(channel, writePos, dryBuffer.getSample(channel, i));
-            int readPos = (writePos - static_cast<int>(delaySamples) + delayBufferSize) % delayBufferSize;
-            float delayedSample = delayBuffer.getSample(channel, readPos);
-            channelData[i] = dryBuffer.getSample(channel, i) * (1.0f - mix) + delayedSample * mix;
-            writePos = (writePos + 1) % delayBufferSize;
-        }
+    float* const* channels = buffer.getArrayOfWritePointers();
 
-        writePositions[channel].store(writePos);
+    for (int i = 0; i < numSamples; ++i) {
+        const float gain = inputGainSmoother.getNextValue();
+        for (int ch = 0; ch < numChannels; ++ch)
+            channels[ch][i] *= gain;
     }
 }
 
@@ -371,11 +1149,15 @@ juce::AudioProcessorValueTreeState::ParameterLayout DAFAudioProcessor::createPar
     params.push_back(std::make_unique<juce::AudioParameterFloat>(
         "pitch", "Pitch", juce::NormalisableRange<float>(-12.0f, 12.0f), 0.0f));
 
+    params.push_back(std::make_unique<juce::AudioParameterBool>(
+        "speechProfile", "Speech Profile", true));
+
     return { params.begin(), params.end() };
 }
 
 void DAFAudioProcessor::loadUserSettings()
 {
+    DAF_TRACE_SCOPE("loadUserSettings");
     juce::PropertiesFile* settings = getSettingsFile(); // Ahora correctamente declarado
     if (settings != nullptr)
     {
@@ -392,6 +1174,7 @@ void DAFAudioProcessor::loadUserSettings()
 
 void DAFAudioProcessor::saveUserSettings()
 {
+    DAF_TRACE_SCOPE("saveUserSettings");
     juce::PropertiesFile* settings = getSettingsFile(); // Ahora correctamente declarado
     if (settings != nullptr)
     {
@@ -3,13 +3,18 @@
 #include <JuceHeader.h>
 #include <array>
 #include <atomic>
-#include <SoundTouch.h>
+#include <memory>
+#include <SoundTouchEngine.h>
+#include "GainRamp.h"
+#include "PerfCounters.h"
+#include "QualityGovernor.h"
 
 using juce::jmax;
 using juce::jmin;
 using juce::jlimit;
 
-class DAFAudioProcessor : public juce::AudioProcessor
+class DAFAudioProcessor : public juce::AudioProcessor,
+                          private juce::AsyncUpdater
 {
 public:
     DAFAudioProcessor();
@@ -45,18 +50,59 @@ public:
     void setDelayTimeMs(float newValue);
     float getPitchShiftSemitones() const;
     void setPitchShiftSemitones(float value);
+    bool isSpeechProfileEnabled() const;
+    void setSpeechProfileEnabled(bool shouldBeEnabled);
 
+    // Rango y paso del slider de pitch en la UI (17 valores). El paso es también
+    // la rejilla a la que se ajusta el pitch de los motores en todo el rango
+    static constexpr float maxPitchUiSemitones = 4.0f;
+    static constexpr float pitchUiStepSemitones = 0.5f;
+
+    // Desde la UI: el hilo de audio aplica el cambio al principio del siguiente
+    // bloque, con fade-in al arrancar y fade-out al parar
     void setProcessingEnabled(bool shouldProcess);
-    bool isProcessing() const { return processingEnabled; }
+    bool isProcessing() const { return processingEnabled.load(); }
     bool isMicActive() const;
     float getCurrentLevel(int channel) const;
 
     bool isBusesLayoutSupported(const BusesLayout& layouts) const override;
     
     static std::atomic<int> instanceCount; // Contador de instancias activas
+
+    // Formato de muestras de SoundTouch (float o int16) de los motores que se creen
+    // a partir de ahora, en vez del más rápido en el dispositivo. Para las pruebas,
+    // cuya salida no puede depender de la máquina
+    static void setPitchEngineFormat(soundtouch::SoundTouchEngine::SAMPLEFORMAT format);
     
     void saveCurrentSettings(); // Nuevo método público
 
+    // Tiempos por etapa de processBlock (fade, delay, pitch y total). Desactivados
+    // por defecto; se activan y consultan desde cualquier hilo
+    PerfCounters& getPerfCounters() { return perfCounters; }
+
+    // Nivel de calidad de SoundTouch que ha elegido el gobernador según la carga
+    QualityGovernor::Tier getQualityTier() const { return qualityGovernor.getTier(); }
+
+    // Delay máximo para el que se reserva la línea de delay (por defecto, el
+    // máximo del parámetro). Se aplica en el próximo prepareToPlay; si luego se
+    // pide más delay, la línea crece sola sin cortes
+    void setMaxDelayMs(float newMaxDelayMs);
+    float getMaxDelayMs() const;
+
+    // Bloquea la línea de delay en RAM (mlock) para que el sistema no la pagine
+    void setDelayMemoryLocked(bool shouldLock);
+
+    // Memoria de audio de esta instancia, desde cualquier hilo
+    struct MemoryUsage
+    {
+        size_t delayBytes = 0;      // Línea de delay, incluida una ampliación en curso
+        size_t fadeBytes = 0;       // Tablas de las rampas y buffer del crossfade de pitch
+        size_t lockedBytes = 0;     // Parte bloqueada en RAM
+        size_t getTotalBytes() const { return delayBytes + fadeBytes; }
+    };
+
+    MemoryUsage getMemoryUsage() const;
+
 private:
     juce::AudioBuffer<float> delayBuffer;
     std::array<std::atomic<int>, 2> writePositions;
@@ -66,33 +112,175 @@ private:
     juce::SmoothedValue<float> dryWetMixSmoother;
     juce::SmoothedValue<float> inputGainSmoother;
 
-    bool processingEnabled = false;
+    std::atomic<bool> processingEnabled { false }; // Estado pedido por la UI
     bool micActive = true;
 
+    // Órdenes de la UI al hilo de audio: cola sin bloqueos de un productor (hilo
+    // de mensajes) y un consumidor (hilo de audio)
+    enum class AudioCommand
+    {
+        start,
+        stop
+    };
+
+    static constexpr int commandQueueSize = 32;
+    juce::AbstractFifo commandFifo { commandQueueSize };
+    std::array<AudioCommand, commandQueueSize> commandBuffer;
+    bool pushCommand(AudioCommand command);
+    bool popCommand(AudioCommand& command);
+    void handleCommands();
+    void updateRunState();
+
+    // Estado del procesamiento, solo lo toca el hilo de audio
+    enum class RunState
+    {
+        stopped,
+        fadingIn,
+        running,
+        fadingOut
+    };
+
+    RunState runState = RunState::stopped;
+
+    // Al parar, delayBuffer se limpia a trozos en los bloques siguientes en vez
+    // de todo de golpe, y solo la parte que se llegó a escribir
+    static constexpr int delayClearChunkSamples = 16384;
+    int delayDirtySamples = 0;
+    void clearDelayBufferChunk(int maxSamples);
+
+    // Tamaño de la línea de delay: potencia de dos para el delay máximo. Si hace
+    // falta más, el hilo de audio lo pide, el de mensajes reserva la nueva línea
+    // en pendingDelayBuffer y el de audio la cambia al principio de un bloque
+    enum DelayResizeState
+    {
+        resizeIdle,
+        resizeRequested,    // Audio -> mensajes: reservar requestedDelaySamples
+        resizeReady,        // Mensajes -> audio: pendingDelayBuffer lista
+        resizeRetired       // Audio -> mensajes: pendingDelayBuffer es la antigua
+    };
+
+    juce::AudioBuffer<float> pendingDelayBuffer;
+    std::atomic<int> delayResizeState { resizeIdle };
+    std::atomic<int> requestedDelaySamples { 0 };
+    std::atomic<float> maxDelayMs { 0.0f };
+    int numDelayChannels = 0;
+    bool lockDelayMemory = false;
+
+    static int getDelayCapacity(double sampleRate, float maxDelayMs);
+    void allocateDelayBuffer(juce::AudioBuffer<float>& target, int numChannels, int numSamples);
+    void lockDelayBuffer(juce::AudioBuffer<float>& target, bool shouldLock);
+    void requestDelayCapacity(int numSamples);
+    void applyDelayResize();
+    void cancelDelayResize();
+
+    std::atomic<size_t> delayMemoryBytes { 0 };
+    std::atomic<size_t> fadeMemoryBytes { 0 };
+    std::atomic<size_t> lockedMemoryBytes { 0 };
+    void updateMemoryUsage();
+
     juce::dsp::ProcessorDuplicator<
         juce::dsp::IIR::Filter<float>,
         juce::dsp::IIR::Coefficients<float>> wetFilter;
 
-    soundtouch::SoundTouch pitchEngine[2]; // SoundTouch por canal
+    // SoundTouch por canal, en el formato de muestras (float o int16) más rápido
+    // para el dispositivo. Se crean en el hilo de mensajes la primera vez que se
+    // pide pitch y luego se quedan aparcados mientras no se usan. El hilo de audio
+    // no los toca hasta que pitchEnginesReady está a true
+    std::unique_ptr<soundtouch::SoundTouchEngine> pitchEngine[2];
+    std::atomic<bool> pitchEnginesReady { false };
+    std::atomic<bool> pitchEnginesRequested { false };
+    static std::atomic<int> forcedPitchEngineFormat;
+    static soundtouch::SoundTouchEngine::SAMPLEFORMAT getPitchEngineFormat(double sampleRate);
+    void createPitchEngines();
+    void requestPitchEngines();
+    static float snapPitchSemitones(float semitones);
+    void preparePitchEngine(soundtouch::SoundTouchEngine& engine, double sampleRate, bool speechProfile);
+
+    // Cambio del perfil de voz sin tocar los motores desde dos hilos: el de audio
+    // lo pide, el de mensajes crea en pendingPitchEngine motores nuevos con el
+    // perfil y el de audio los cambia por los actuales con el pitch en bypass.
+    // Los antiguos se liberan en el hilo de mensajes
+    enum ProfileSwapState
+    {
+        profileIdle,
+        profileRequested,   // Audio -> mensajes: crear motores con el perfil actual
+        profileReady,       // Mensajes -> audio: pendingPitchEngine listos
+        profileRetired      // Audio -> mensajes: pendingPitchEngine son los antiguos
+    };
+
+    std::unique_ptr<soundtouch::SoundTouchEngine> pendingPitchEngine[2];
+    std::atomic<int> profileSwapState { profileIdle };
+    bool pendingSpeechProfile = false;
+    QualityGovernor::Tier pendingQualityTier = QualityGovernor::fullQuality;
+    std::atomic<int> pendingPitchLatency { 0 };
+    bool speechProfileApplied = false;
+    void requestProfileSwap();
+    void createProfileEngines();
+    void applyProfileSwap();
+
+    // Latencia de SoundTouch en el peor caso del rango de pitch: se publica al host,
+    // se descuenta del delay y la salida de un motor nuevo arranca con ese silencio
+    std::atomic<int> pitchLatencySamples{0};
+    int pitchPrerollRemaining[2] = {0, 0};
+    int measurePitchLatency(double sampleRate, bool speechProfile);
+
+    // Entrada y salida del bypass de pitch (|pitch| <= pitchBypassSemitones), solo
+    // en el hilo de audio. Crossfade de potencia constante entre SoundTouch y la
+    // señal seca, leída de la línea de delay con la latencia de pitch de más. Al
+    // entrar, el motor se ceba antes con la salida descartada: así se vacía lo
+    // que quedó dentro de la última vez sin tener que limpiarlo
+    enum class PitchState
+    {
+        bypassed,
+        priming,
+        fadingIn,
+        active,
+        fadingOut
+    };
+
+    static constexpr float pitchBypassSemitones = 0.1f;
+    const float pitchCrossfadeSeconds = 0.03f;
+    PitchState pitchState = PitchState::bypassed;
+    int pitchPrimingRemaining = 0;
+    GainRamp pitchRamp;
+    juce::AudioBuffer<float> pitchDryBuffer;
+    void updatePitchState(bool pitchWanted);
+    void finishPitchBlock(juce::AudioBuffer<float>& buffer, int numChannels, int numSamples);
+
+    // Calidad de SoundTouch según la carga del hilo de audio. Todos los niveles
+    // se preparan al crear los motores, así cambiar de nivel no reserva memoria
+    // ni diseña filtros. qualityTierApplied es como speechProfileApplied
+    QualityGovernor qualityGovernor;
+    QualityGovernor::Tier qualityTierApplied = QualityGovernor::fullQuality;
+    static void applyQualityTier(soundtouch::SoundTouchEngine& engine, QualityGovernor::Tier tier);
+    void warmPitchEngines(std::unique_ptr<soundtouch::SoundTouchEngine> (&engines)[2], QualityGovernor::Tier finalTier);
+    void handleAsyncUpdate() override;
 
     void resetLevels();
-    void updateInputLevels(const juce::AudioBuffer<float>& buffer);
-    void applyInputGain(juce::AudioBuffer<float>& buffer);
-    void processStereoDelay(juce::AudioBuffer<float>& buffer, float delayTimeMs, float mix);
-    void updateOutputLevels(const juce::AudioBuffer<float>& buffer);
-    void ensureStereo(juce::AudioBuffer<float>& buffer);
+    void applyInputGain(juce::AudioBuffer<float>& buffer, int numChannels);
+    void ensureStereo(juce::AudioBuffer<float>& buffer, int numProcessedChannels);
+
+    // Canales que recorren la cadena de delay y pitch: 1 con entrada mono o con
+    // los dos canales iguales
+    bool stereoInputSeen = false;
+    int getNumProcessChannels(const juce::AudioBuffer<float>& buffer);
+
+    // Paso a estéreo con el pitch en marcha: el motor derecho se ceba con la
+    // entrada que ya tuvo el izquierdo y el canal derecho entra con un crossfade
+    // desde la salida del izquierdo
+    bool rightPitchEnginePending = false;
+    GainRamp stereoRamp;
+    void primeRightPitchEngine(int inputStart, int pitchLatency, int chunkSamples);
     
     juce::PropertiesFile* getSettingsFile();
     void loadUserSettings();
     void saveUserSettings();
     
-    // Variables para fade-in
-    bool isFadingIn = false;
-    float fadeGain = 0.0f;
-    const float fadeDurationSeconds = 0.1f; // 100ms de fade-in (aumentado de 50ms)
-    int fadeCounter = 0;
-    int fadeLengthInSamples = 0;
-    juce::AudioBuffer<float> fadeBuffer; // Buffer temporal para fade
+    // Fade-in al arrancar y fade-out al parar, aplicados in situ sobre el buffer
+    const float fadeDurationSeconds = 0.1f; // 100ms de fade (aumentado de 50ms)
+    GainRamp fadeRamp;
+
+    PerfCounters perfCounters;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DAFAudioProcessor)
 };
@@ -20,6 +20,7 @@ private:
 
     void sliderValueChanged(juce::Slider* slider) override;
     void timerCallback() override;
+    void mouseDoubleClick(const juce::MouseEvent& event) override;
     void toggleAudioProcessing();
     void updateMicStatus();
     void updateSliderLabels();
@@ -41,6 +42,12 @@ private:
 
     std::unique_ptr<juce::Label> audioLevelText;
     double currentLevel = 0.0;
+
+    // Overlay oculto con los tiempos por etapa del procesador (doble toque en el título)
+    juce::Label perfOverlay;
+    int perfOverlayTicks = 0;
+    void togglePerfOverlay();
+    void updatePerfOverlay();
     
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DAFAudioProcessorEditor)
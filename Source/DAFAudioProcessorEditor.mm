@@ -1,5 +1,6 @@
 #include "DAFAudioProcessorEditor.h"
 #include "DAFAudioProcessor.h"
+#include "TraceRecorder.h"
 #include "getEducationalText.h"
 #include "Monetization/PurchaseManagerFactory.h"
 #include "UI/PaywallComponent.h"
@@ -53,8 +54,17 @@ DAFAudioProcessorEditor::DAFAudioProcessorEditor(DAFAudioProcessor& p)
     titleLabel.setJustificationType(juce::Justification::centred);
     titleLabel.setFont(juce::Font(juce::FontOptions(20.0f, juce::Font::bold)));
     titleLabel.setColour(juce::Label::textColourId, kTextColour);
+    titleLabel.addMouseListener(this, false);
     addAndMakeVisible(titleLabel);
 
+    // Overlay de rendimiento, oculto hasta un doble toque en el título
+    perfOverlay.setFont(juce::Font(juce::FontOptions(juce::Font::getDefaultMonospacedFontName(), 11.0f, juce::Font::plain)));
+    perfOverlay.setJustificationType(juce::Justification::topLeft);
+    perfOverlay.setColour(juce::Label::backgroundColourId, juce::Colours::black.withAlpha(0.75f));
+    perfOverlay.setColour(juce::Label::textColourId, juce::Colours::white);
+    perfOverlay.setInterceptsMouseClicks(false, false);
+    addChildComponent(perfOverlay);
+
     // delay Labels y sliders
     delayLabel.setText("Retardo", juce::dontSendNotification);
     delayLabel.setFont(juce::Font(juce::FontOptions(18.0f, juce::Font::bold)));
@@ -62,6 +72,7 @@ DAFAudioProcessorEditor::DAFAudioProcessorEditor(DAFAudioProcessor& p)
     addAndMakeVisible(delayLabel);
 
     delaySlider.setRange(0.0, 200.0, 1.0);
+    processor.setMaxDelayMs(static_cast<float>(delaySlider.getMaximum())); // La línea de delay se reserva para este máximo
     delaySlider.setSliderStyle(juce::Slider::LinearHorizontal);
     delaySlider.setTextBoxStyle(juce::Slider::NoTextBox, true, 0, 0);
     delaySlider.setColour(juce::Slider::thumbColourId, kPrimaryColour);
@@ -82,7 +93,9 @@ DAFAudioProcessorEditor::DAFAudioProcessorEditor(DAFAudioProcessor& p)
     pitchLabel.setColour(juce::Label::textColourId, kTextColour);
     addAndMakeVisible(pitchLabel);
 
-    pitchSlider.setRange(-4.0, 4.0, 0.5);
+    pitchSlider.setRange(-DAFAudioProcessor::maxPitchUiSemitones,
+                         DAFAudioProcessor::maxPitchUiSemitones,
+                         DAFAudioProcessor::pitchUiStepSemitones);
     pitchSlider.setSliderStyle(juce::Slider::LinearHorizontal);
     pitchSlider.setTextBoxStyle(juce::Slider::NoTextBox, true, 0, 0);
     pitchSlider.setColour(juce::Slider::thumbColourId, kPrimaryColour);
@@ -265,6 +278,9 @@ DAFAudioProcessorEditor::DAFAudioProcessorEditor(DAFAudioProcessor& p)
 
 DAFAudioProcessorEditor::~DAFAudioProcessorEditor()
 {
+    titleLabel.removeMouseListener(this);
+    processor.getPerfCounters().setEnabled(false);
+    TraceRecorder::getInstance().stop();
     menuButtons.clear(true);
 }
 
@@ -276,6 +292,7 @@ void DAFAudioProcessorEditor::paint(juce::Graphics& g)
 
 void DAFAudioProcessorEditor::resized()
 {
+    DAF_TRACE_SCOPE("resized");
     const int margin = 13;
     const int labelW = 320;
     const int sliderH = 24;
@@ -342,6 +359,8 @@ void DAFAudioProcessorEditor::resized()
     educationalContentLabel.setBounds(16, 120, getWidth() - 40, getHeight() - 120);
     backButton.setBounds(getWidth() / 2 - 60, getHeight() - 50, 120, 30);
 
+    perfOverlay.setBounds(margin, getHeight() - 170, getWidth() - 2 * margin, 100);
+
     // Botones del menú lateral
     if (menuVisible)
     {
@@ -463,6 +482,8 @@ void DAFAudioProcessorEditor::sliderValueChanged(juce::Slider* slider)
 
 void DAFAudioProcessorEditor::timerCallback()
 {
+    DAF_TRACE_THREAD_NAME("message");
+    DAF_TRACE_SCOPE("timerCallback");
     updateSlidersWithAnimation(); // Mantiene la UI actualizada
 
     bool shouldBeProcessing = processor.isProcessing();
@@ -474,6 +495,10 @@ void DAFAudioProcessorEditor::timerCallback()
         micStatusLabel.setColour(juce::Label::textColourId, shouldBeProcessing ? juce::Colours::green : juce::Colours::red);
     }
     
+    // El overlay de rendimiento se refresca a 4 Hz
+    if (perfOverlay.isVisible() && ++perfOverlayTicks % 15 == 0)
+        updatePerfOverlay();
+
     //------------- Paywall Manager
     if (paywall && paywall->isVisible())
     {
@@ -486,6 +511,48 @@ void DAFAudioProcessorEditor::timerCallback()
     //------------- Paywall Manager
 }
 
+void DAFAudioProcessorEditor::mouseDoubleClick(const juce::MouseEvent& event)
+{
+    if (event.originalComponent == &titleLabel)
+        togglePerfOverlay();
+}
+
+void DAFAudioProcessorEditor::togglePerfOverlay()
+{
+    const bool show = !perfOverlay.isVisible();
+    auto& counters = processor.getPerfCounters();
+
+    // Los contadores solo miden mientras el overlay está a la vista
+    counters.requestReset();
+    counters.setEnabled(show);
+
+    // La traza se graba a la vez, y al cerrar el overlay se guarda para abrirla
+    // en Perfetto (ui.perfetto.dev)
+    auto& trace = TraceRecorder::getInstance();
+    if (show)
+    {
+        trace.start();
+    }
+    else if (trace.isRecording())
+    {
+        const auto file = juce::File::getSpecialLocation(juce::File::userDocumentsDirectory).getChildFile("daf_trace.json");
+        file.replaceWithText(juce::String(trace.stopAndExportJson()));
+        DBG("[DAF] Traza guardada en " << file.getFullPathName());
+    }
+
+    perfOverlay.setText({}, juce::dontSendNotification);
+    perfOverlay.setVisible(show);
+    if (show)
+        perfOverlay.toFront(false);
+
+    perfOverlayTicks = 0;
+}
+
+void DAFAudioProcessorEditor::updatePerfOverlay()
+{
+    perfOverlay.setText(juce::String(processor.getPerfCounters().formatReport()), juce::dontSendNotification);
+}
+
 void DAFAudioProcessorEditor::updateSlidersWithAnimation()
 {
     // 1. Obtener valores objetivo como enteros
@@ -56,20 +56,67 @@ static const double _kaiser8[8] =
 };
 
 
+#define PI 3.1415926536
+#define sinc(x) (sin(PI * (x)) / (PI * (x)))
+
+namespace
+{
+    /// Polyphase table of Kaiser-windowed sinc taps, one row of 8 taps
+    /// for each fractional position 0, 1/PHASES, ..., 1.0
+    class ShannonTable
+    {
+    public:
+        enum { PHASES = TransposerBase::PHASES };
+
+        alignas(16) float coeffs[8 * (PHASES + 1)];
+
+        ShannonTable()
+        {
+            for (int p = 0; p <= PHASES; p ++)
+            {
+                const double fract = (double)p / (double)PHASES;
+
+                for (int k = 0; k < 8; k ++)
+                {
+                    const double x = (double)(k - 3) - fract;
+                    // sinc(0) = 1
+                    const double w = (fabs(x) < 1e-6) ? 1.0 : sinc(x);
+                    coeffs[8 * p + k] = (float)(w * _kaiser8[k]);
+                }
+            }
+        }
+    };
+}
+
+
+const float *InterpolateShannon::getCoeffTable()
+{
+    // table gets built once on first use, and is then shared by all instances
+    static const ShannonTable table;
+    return table.coeffs;
+}
+
+
 InterpolateShannon::InterpolateShannon()
 {
-    fract = 0;
+    coeffTable = getCoeffTable();
+    iFract = 0;
+    iRate = fixedRate(1.0);
 }
 
 
 void InterpolateShannon::resetRegisters()
 {
-    fract = 0;
+    iFract = 0;
 }
 
 
-#define PI 3.1415926536
-#define sinc(x) (sin(PI * (x)) / (PI * (x)))
+void InterpolateShannon::setRate(double newRate)
+{
+    TransposerBase::setRate(newRate);
+    iRate = fixedRate(newRate);
+}
+
 
 /// Transpose mono audio. Returns number of produced output samples, and
 /// updates "srcSamples" to amount of consumed source samples
@@ -84,33 +131,28 @@ int InterpolateShannon::transposeMono(SAMPLETYPE *pdest,
     i = 0;
     while (srcCount < srcSampleEnd)
     {
-        double out;
-        assert(fract < 1.0);
+        float out;
+        const float *w = coeffTable + 8 * phaseIndex(iFract);
 
-        out  = psrc[0] * sinc(-3.0 - fract) * _kaiser8[0];
-        out += psrc[1] * sinc(-2.0 - fract) * _kaiser8[1];
-        out += psrc[2] * sinc(-1.0 - fract) * _kaiser8[2];
-        if (fract < 1e-6)
-        {
-            out += psrc[3] * _kaiser8[3];     // sinc(0) = 1
-        }
-        else
-        {
-            out += psrc[3] * sinc(- fract) * _kaiser8[3];
-        }
-        out += psrc[4] * sinc( 1.0 - fract) * _kaiser8[4];
-        out += psrc[5] * sinc( 2.0 - fract) * _kaiser8[5];
-        out += psrc[6] * sinc( 3.0 - fract) * _kaiser8[6];
-        out += psrc[7] * sinc( 4.0 - fract) * _kaiser8[7];
+        assert(iFract <= FRACT_MASK);
+
+        out  = psrc[0] * w[0];
+        out += psrc[1] * w[1];
+        out += psrc[2] * w[2];
+        out += psrc[3] * w[3];
+        out += psrc[4] * w[4];
+        out += psrc[5] * w[5];
+        out += psrc[6] * w[6];
+        out += psrc[7] * w[7];
 
         pdest[i] = (SAMPLETYPE)out;
         i ++;
 
         // update position fraction
-        fract += rate;
+        iFract += iRate;
         // update whole positions
-        int whole = (int)fract;
-        fract -= whole;
+        int whole = (int)(iFract >> FRACT_BITS);
+        iFract &= FRACT_MASK;
         psrc += whole;
         srcCount += whole;
     }
@@ -132,35 +174,29 @@ int InterpolateShannon::transposeStereo(SAMPLETYPE *pdest,
     i = 0;
     while (srcCount < srcSampleEnd)
     {
-        double out0, out1, w;
-        assert(fract < 1.0);
-
-        w = sinc(-3.0 - fract) * _kaiser8[0];
-        out0 = psrc[0] * w; out1 = psrc[1] * w;
-        w = sinc(-2.0 - fract) * _kaiser8[1];
-        out0 += psrc[2] * w; out1 += psrc[3] * w;
-        w = sinc(-1.0 - fract) * _kaiser8[2];
-        out0 += psrc[4] * w; out1 += psrc[5] * w;
-        w = _kaiser8[3] * ((fract < 1e-5) ? 1.0 : sinc(- fract));   // sinc(0) = 1
-        out0 += psrc[6] * w; out1 += psrc[7] * w;
-        w = sinc( 1.0 - fract) * _kaiser8[4];
-        out0 += psrc[8] * w; out1 += psrc[9] * w;
-        w = sinc( 2.0 - fract) * _kaiser8[5];
-        out0 += psrc[10] * w; out1 += psrc[11] * w;
-        w = sinc( 3.0 - fract) * _kaiser8[6];
-        out0 += psrc[12] * w; out1 += psrc[13] * w;
-        w = sinc( 4.0 - fract) * _kaiser8[7];
-        out0 += psrc[14] * w; out1 += psrc[15] * w;
+        float out0, out1;
+        const float *w = coeffTable + 8 * phaseIndex(iFract);
+
+        assert(iFract <= FRACT_MASK);
+
+        out0 = psrc[0] * w[0];  out1 = psrc[1] * w[0];
+        out0 += psrc[2] * w[1]; out1 += psrc[3] * w[1];
+        out0 += psrc[4] * w[2]; out1 += psrc[5] * w[2];
+        out0 += psrc[6] * w[3]; out1 += psrc[7] * w[3];
+        out0 += psrc[8] * w[4]; out1 += psrc[9] * w[4];
+        out0 += psrc[10] * w[5]; out1 += psrc[11] * w[5];
+        out0 += psrc[12] * w[6]; out1 += psrc[13] * w[6];
+        out0 += psrc[14] * w[7]; out1 += psrc[15] * w[7];
 
         pdest[2*i]   = (SAMPLETYPE)out0;
         pdest[2*i+1] = (SAMPLETYPE)out1;
         i ++;
 
         // update position fraction
-        fract += rate;
+        iFract += iRate;
         // update whole positions
-        int whole = (int)fract;
-        fract -= whole;
+        int whole = (int)(iFract >> FRACT_BITS);
+        iFract &= FRACT_MASK;
         psrc += 2*whole;
         srcCount += whole;
     }
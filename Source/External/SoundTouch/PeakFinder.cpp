@@ -275,3 +275,62 @@ double PeakFinder::detectPeak(const float *data, int aminPos, int amaxPos)
 
     return peak;
 }
+
+
+double PeakFinder::detectPeriod(const float *data, int aminPos, int amaxPos,
+                                int minPeriod, int maxPeriod, float minLevel)
+{
+    int i;
+    int peakpos;
+    double center, period;
+
+    this->minPos = aminPos;
+    this->maxPos = amaxPos;
+
+    // find absolute peak
+    peakpos = minPos;
+    for (i = minPos + 1; i < maxPos; i ++)
+    {
+        if (data[i] > data[peakpos]) peakpos = i;
+    }
+    if (data[peakpos] < minLevel) return 0;
+
+    center = getPeakCenter(data, peakpos);
+    if (center == 0) return 0;
+
+    // look for the highest value at the allowed distance to both sides of the
+    // peak, and accept the nearer one of them that is a proper peak as well
+    period = 0;
+    for (int direction = -1; direction <= 1; direction += 2)
+    {
+        int first = peakpos + direction * minPeriod;
+        int last = peakpos + direction * maxPeriod;
+        if (first > last)
+        {
+            int temp = first;
+            first = last;
+            last = temp;
+        }
+        if (first < minPos) first = minPos;
+        if (last > maxPos - 1) last = maxPos - 1;
+        if (first > last) continue;
+
+        int pos = first;
+        for (i = first + 1; i <= last; i ++)
+        {
+            if (data[i] > data[pos]) pos = i;
+        }
+
+        pos = findTop(data, pos);   // seek true local maximum index
+        if ((pos == 0) || (data[pos] < minLevel)) continue;
+
+        double centertmp = getPeakCenter(data, pos);
+        if (centertmp == 0) continue;
+
+        double distance = fabs(centertmp - center);
+        if ((distance < minPeriod) || (distance > maxPeriod)) continue;
+        if ((period == 0) || (distance < period)) period = distance;
+    }
+
+    return period;
+}
@@ -0,0 +1,131 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+/// Sample format independent SoundTouch engine: factory for the float and 16bit
+/// integer sample variants, and a benchmark for choosing the faster one.
+///
+///
+/// Author        : Copyright (c) Olli Parviainen
+/// Author e-mail : oparviai 'at' iki.fi
+/// SoundTouch WWW: http://www.surina.net/soundtouch
+///
+////////////////////////////////////////////////////////////////////////////////
+//
+// License :
+//
+//  SoundTouch audio processing library
+//  Copyright (c) Olli Parviainen
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Lesser General Public
+//  License as published by the Free Software Foundation; either
+//  version 2.1 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this library; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+#include <chrono>
+#include <math.h>
+#include "SoundTouch.h"
+#include "SoundTouchEngineImpl.h"
+
+using namespace soundtouch;
+
+// Benchmark signal duration per round in milliseconds
+#define BENCHMARK_MS            250
+
+// Number of benchmark rounds per format; fastest round counts
+#define BENCHMARK_ROUNDS        3
+
+// Processing block size in samples, as in typical realtime use
+#define BENCHMARK_BLOCK         256
+
+// Pitch shift used in benchmark, in semitones
+#define BENCHMARK_PITCH         3.0
+
+#define PI                      3.1415926536
+
+
+SoundTouchEngine *SoundTouchEngine::newInstance(SAMPLEFORMAT format)
+{
+    if (format == INT16_SAMPLES)
+    {
+        return newInt16Engine();
+    }
+    return new SoundTouchEngineImpl<SoundTouch, SAMPLETYPE>;
+}
+
+
+// Processes given signal with the engine in realtime-sized blocks, and returns
+// the fastest round's processing time in seconds
+static double benchmarkEngine(SoundTouchEngine *engine, const float *signal, float *output,
+                              uint numSamples, uint numChannels)
+{
+    double best = 1e30;
+
+    for (int round = 0; round < BENCHMARK_ROUNDS; round ++)
+    {
+        engine->clear();
+
+        const auto start = std::chrono::steady_clock::now();
+        for (uint pos = 0; pos < numSamples; pos += BENCHMARK_BLOCK)
+        {
+            const uint count = (numSamples - pos < BENCHMARK_BLOCK) ? (numSamples - pos) : BENCHMARK_BLOCK;
+
+            engine->putSamples(signal + pos * numChannels, count);
+            engine->receiveSamples(output, BENCHMARK_BLOCK);
+        }
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        if (elapsed.count() < best) best = elapsed.count();
+    }
+    return best;
+}
+
+
+// Measures which sample format variant processes faster on this device
+SoundTouchEngine::SAMPLEFORMAT SoundTouchEngine::selectFastestFormat(uint sampleRate, uint numChannels)
+{
+    const uint numSamples = sampleRate * BENCHMARK_MS / 1000;
+    float *signal = new float[numSamples * numChannels];
+    float *output = new float[BENCHMARK_BLOCK * numChannels];
+    double elapsed[2];
+
+    // voice-like test signal: harmonics of a 150Hz fundamental
+    for (uint i = 0; i < numSamples; i ++)
+    {
+        double value = 0;
+        for (int h = 1; h <= 10; h ++)
+        {
+            value += sin(2.0 * PI * 150.0 * h * i / sampleRate) / h;
+        }
+        for (uint c = 0; c < numChannels; c ++)
+        {
+            signal[i * numChannels + c] = (float)(0.2 * value);
+        }
+    }
+
+    for (int f = FLOAT_SAMPLES; f <= INT16_SAMPLES; f ++)
+    {
+        SoundTouchEngine *engine = newInstance((SAMPLEFORMAT)f);
+
+        engine->setSampleRate(sampleRate);
+        engine->setChannels(numChannels);
+        engine->setPitchSemiTones(BENCHMARK_PITCH);
+        elapsed[f] = benchmarkEngine(engine, signal, output, numSamples, numChannels);
+        delete engine;
+    }
+
+    delete[] signal;
+    delete[] output;
+
+    return (elapsed[INT16_SAMPLES] < elapsed[FLOAT_SAMPLES]) ? INT16_SAMPLES : FLOAT_SAMPLES;
+}
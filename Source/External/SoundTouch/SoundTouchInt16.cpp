@@ -0,0 +1,75 @@
+////////////////////////////////////////////////////////////////////////////////
+///
+/// 16bit integer sample variant of the SoundTouch library. Compiles the library
+/// sources once more with integer samples into namespace 'soundtouch_int16', so
+/// that this variant can be linked into the same binary with the default float
+/// sample build. Use the variant via SoundTouchEngine interface.
+///
+///
+/// Author        : Copyright (c) Olli Parviainen
+/// Author e-mail : oparviai 'at' iki.fi
+/// SoundTouch WWW: http://www.surina.net/soundtouch
+///
+////////////////////////////////////////////////////////////////////////////////
+//
+// License :
+//
+//  SoundTouch audio processing library
+//  Copyright (c) Olli Parviainen
+//
+//  This library is free software; you can redistribute it and/or
+//  modify it under the terms of the GNU Lesser General Public
+//  License as published by the Free Software Foundation; either
+//  version 2.1 of the License, or (at your option) any later version.
+//
+//  This library is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+//  Lesser General Public License for more details.
+//
+//  You should have received a copy of the GNU Lesser General Public
+//  License along with this library; if not, write to the Free Software
+//  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+//
+////////////////////////////////////////////////////////////////////////////////
+
+
+// The engine template must be declared before renaming the namespace below
+#include "SoundTouchEngineImpl.h"
+
+// Compile the following sources with 16bit integer samples, see STTypes.h
+#define SOUNDTOUCH_INT16_VARIANT    1
+
+// Rename symbols of this variant that would clash with the float build
+#define soundtouch                  soundtouch_int16
+#define soundtouch_ac_test          soundtouch_int16_ac_test
+
+#if !defined(__MMX__) && !defined(_MSC_VER)
+    // Compiler doesn't enable MMX instructions for this file, so build the
+    // variant with plain C routines
+    #define SOUNDTOUCH_DISABLE_X86_OPTIMIZATIONS    1
+#endif
+
+#include "AAFilter.cpp"
+#include "FIFOSampleBuffer.cpp"
+#include "FIRFilter.cpp"
+#include "InterpolateCubic.cpp"
+#include "InterpolateLinear.cpp"
+#include "InterpolatePolyphase.cpp"
+#include "PeakFinder.cpp"
+#undef PI   // defined with different precision in the following file
+#include "InterpolateShannon.cpp"
+#include "RateTransposer.cpp"
+#include "SoundTouch.cpp"
+#include "TDStretch.cpp"
+#ifdef SOUNDTOUCH_ALLOW_MMX
+#include "mmx_optimized.cpp"
+#endif
+
+#undef soundtouch
+
+
+soundtouch::SoundTouchEngine *soundtouch::newInt16Engine()
+{
+    return new soundtouch::SoundTouchEngineImpl<soundtouch_int16::SoundTouch, soundtouch_int16::SAMPLETYPE>;
+}
@@ -7,11 +7,10 @@
 /// Notes : MMX optimized functions reside in a separate, platform-specific
 /// file, e.g. 'mmx_win.cpp' or 'mmx_gcc.cpp'.
 ///
-/// This source file contains OpenMP optimizations that allow speeding up the
-/// corss-correlation algorithm by executing it in several threads / CPU cores
-/// in parallel. See the following article link for more detailed discussion
-/// about SoundTouch OpenMP optimizations:
-/// http://www.softwarecoven.com/parallel-computing-in-embedded-mobile-devices
+/// The full cross-correlation seek can be split over several threads / CPU cores
+/// of a persistent worker pool, see 'WorkerPool', for offline processing. The
+/// pool takes a lock and spin-waits for its threads, so it's not for real-time
+/// audio threads.
 ///
 /// Author        : Copyright (c) Olli Parviainen
 /// Author e-mail : oparviai 'at' iki.fi
@@ -49,11 +48,41 @@
 #include "STTypes.h"
 #include "cpu_detect.h"
 #include "TDStretch.h"
+#include "PeakFinder.h"
+#ifdef SOUNDTOUCH_FLOAT_SAMPLES
+#include "WorkerPool.h"
+#endif
 
 using namespace soundtouch;
 
 #define max(x, y) (((x) > (y)) ? (x) : (y))
 
+// Decimation factor of the first pass of the hierarchical overlap position seek
+#define COARSE_DECIMATION   4
+
+// Pitch guided seek: relative pitch period change allowed per period between two
+// sequences, the plain correlation that voiced sound has to reach, and the number
+// of period multiples around the mid of the seek range to scan
+#define PITCH_TOLERANCE     0.01
+#define VOICED_CORRELATION  0.6
+#define PITCH_CANDIDATES    3
+
+// Work of the full seek in multiply-adds, seek positions x overlap samples, from
+// which on splitting the seek over the worker pool threads pays off. Below this the
+// scan takes less than ~50 us, not much more than waking up the workers
+#define PARALLEL_SEEK_MIN_WORK  500000
+
+#ifdef SOUNDTOUCH_FLOAT_SAMPLES
+// Parallel full seek job: the best match of each part
+struct SeekFullJob
+{
+    soundtouch::TDStretch *pStretch;
+    const float *refPos;
+    double bestCorr[soundtouch::WorkerPool::MAX_PARTS];
+    int bestOffs[soundtouch::WorkerPool::MAX_PARTS];
+};
+#endif
+
 /*****************************************************************************
  *
  * Implementation of the class 'TDStretch'
@@ -63,16 +92,30 @@ using namespace soundtouch;
 
 TDStretch::TDStretch() : FIFOProcessor(&outputBuffer)
 {
-    bQuickSeek = false;
+    seekMode = SEEK_FULL;
+    bParallelSeek = false;
+    bRaisedCosineOverlap = false;
     channels = 2;
 
     pMidBuffer = nullptr;
     pMidBufferUnaligned = nullptr;
+    pOverlapWindow = nullptr;
+    pOverlapWindowUnaligned = nullptr;
+    pCoarseBuffer = nullptr;
+    coarseBufferSize = 0;
+    pitchPeriod = 0;
+    midBufferPos = 0;
+    pOutputTarget = &outputBuffer;
     overlapLength = 0;
 
     bAutoSeqSetting = true;
     bAutoSeekSetting = true;
 
+    bSpeechProfile = false;
+    speechMinF0 = DEFAULT_SPEECH_MIN_F0;
+    speechMaxF0 = DEFAULT_SPEECH_MAX_F0;
+    speechLatencyMs = DEFAULT_SPEECH_LATENCY_MS;
+
     tempo = 1.0f;
     setParameters(44100, DEFAULT_SEQUENCE_MS, DEFAULT_SEEKWINDOW_MS, DEFAULT_OVERLAP_MS);
     setTempo(1.0f);
@@ -85,6 +128,8 @@ TDStretch::TDStretch() : FIFOProcessor(&outputBuffer)
 TDStretch::~TDStretch()
 {
     delete[] pMidBufferUnaligned;
+    delete[] pOverlapWindowUnaligned;
+    delete[] pCoarseBuffer;
 }
 
 
@@ -106,6 +151,7 @@ void TDStretch::setParameters(int aSampleRate, int aSequenceMS,
     {
         if (aSampleRate > 192000) ST_THROW_RT_ERROR("Error: Excessive samplerate");
         this->sampleRate = aSampleRate;
+        pitchPeriod = 0;
     }
 
     if (aOverlapMS > 0) this->overlapMs = aOverlapMS;
@@ -169,25 +215,6 @@ void TDStretch::getParameters(int *pSampleRate, int *pSequenceMs, int *pSeekWind
 }
 
 
-// Overlaps samples in 'midBuffer' with the samples in 'pInput'
-void TDStretch::overlapMono(SAMPLETYPE *pOutput, const SAMPLETYPE *pInput) const
-{
-    int i;
-    SAMPLETYPE m1, m2;
-
-    m1 = (SAMPLETYPE)0;
-    m2 = (SAMPLETYPE)overlapLength;
-
-    for (i = 0; i < overlapLength ; i ++)
-    {
-        pOutput[i] = (pInput[i] * m1 + pMidBuffer[i] * m2 ) / overlapLength;
-        m1 += 1;
-        m2 -= 1;
-    }
-}
-
-
-
 void TDStretch::clearMidBuffer()
 {
     memset(pMidBuffer, 0, channels * sizeof(SAMPLETYPE) * overlapLength);
@@ -199,6 +226,7 @@ void TDStretch::clearInput()
     inputBuffer.clear();
     clearMidBuffer();
     isBeginning = true;
+    pitchPeriod = 0;
     maxnorm = 0;
     maxnormf = 1e8;
     skipFract = 0;
@@ -218,24 +246,161 @@ void TDStretch::clear()
 // to enable
 void TDStretch::enableQuickSeek(bool enable)
 {
-    bQuickSeek = enable;
+    seekMode = enable ? SEEK_QUICK : SEEK_FULL;
 }
 
 
 // Returns nonzero if the quick seeking algorithm is enabled.
 bool TDStretch::isQuickSeekEnabled() const
 {
-    return bQuickSeek;
+    return (seekMode == SEEK_QUICK);
+}
+
+
+// Selects the overlap position seeking algorithm
+void TDStretch::setSeekMode(SEEKMODE mode)
+{
+    seekMode = mode;
+}
+
+
+// Returns the overlap position seeking algorithm
+TDStretch::SEEKMODE TDStretch::getSeekMode() const
+{
+    return seekMode;
+}
+
+
+// Enables/disables the parallel full seek
+void TDStretch::enableParallelSeek(bool enable)
+{
+    bParallelSeek = enable;
+}
+
+
+// Returns nonzero if the parallel full seek is enabled.
+bool TDStretch::isParallelSeekEnabled() const
+{
+    return bParallelSeek;
+}
+
+
+// Selects the raised-cosine or the linear crossfade for overlapping the sequences
+void TDStretch::enableRaisedCosineOverlap(bool enable)
+{
+    if (enable == bRaisedCosineOverlap) return;
+
+    bRaisedCosineOverlap = enable;
+    calcOverlapWindow();
+}
+
+
+// Returns nonzero if the raised-cosine crossfade is enabled.
+bool TDStretch::isRaisedCosineOverlapEnabled() const
+{
+    return bRaisedCosineOverlap;
+}
+
+
+// Enables/disables the speech processing profile
+void TDStretch::enableSpeechProfile(bool enable)
+{
+    if (enable == bSpeechProfile) return;
+
+    bSpeechProfile = enable;
+    if (bSpeechProfile)
+    {
+        applySpeechProfile();
+    }
+    else
+    {
+        // return to the automatic settings
+        setParameters(sampleRate, USE_AUTO_SEQUENCE_LEN, USE_AUTO_SEEKWINDOW_LEN, DEFAULT_OVERLAP_MS);
+    }
+}
+
+
+// Returns nonzero if the speech processing profile is enabled.
+bool TDStretch::isSpeechProfileEnabled() const
+{
+    return bSpeechProfile;
+}
+
+
+// Sets the speech profile parameters. Zero or negative values keep the old value.
+void TDStretch::setSpeechParameters(int minF0, int maxF0, int latencyBudgetMs)
+{
+    if (minF0 <= 0) minF0 = speechMinF0;
+    if (maxF0 <= 0) maxF0 = speechMaxF0;
+    if (maxF0 < minF0) ST_THROW_RT_ERROR("Error: speech profile F0 range minimum exceeds maximum");
+
+    speechMinF0 = minF0;
+    speechMaxF0 = maxF0;
+    if (latencyBudgetMs > 0) speechLatencyMs = latencyBudgetMs;
+
+    if (bSpeechProfile) applySpeechProfile();
+}
+
+
+// Get speech profile parameters, see setSpeechParameters() function.
+void TDStretch::getSpeechParameters(int *pMinF0, int *pMaxF0, int *pLatencyBudgetMs) const
+{
+    if (pMinF0) *pMinF0 = speechMinF0;
+    if (pMaxF0) *pMaxF0 = speechMaxF0;
+    if (pLatencyBudgetMs) *pLatencyBudgetMs = speechLatencyMs;
+}
+
+
+/// Derives processing sequence, seek window and overlap lengths for speech from
+/// the voice's fundamental frequency range and the latency budget
+void TDStretch::applySpeechProfile()
+{
+    // overlap length limits in milliseconds
+    #define SPEECH_OVERLAP_MIN  4.0
+    #define SPEECH_OVERLAP_MAX  10.0
+
+    // longest and shortest pitch periods of the voice, in milliseconds
+    const double periodMax = 1000.0 / speechMinF0;
+    const double periodMin = 1000.0 / speechMaxF0;
+
+    // seek window has to span the longest pitch period, so that a pitch
+    // synchronous joining position can be found for any voice in the range
+    const double seek = ceil(periodMax);
+
+    // crossfade over half of the longest period, yet at least over the shortest
+    // period, to smooth the joints without smearing the pitch pulses
+    double ovl = 0.5 * periodMax;
+    if (ovl < periodMin) ovl = periodMin;
+    if (ovl < SPEECH_OVERLAP_MIN) ovl = SPEECH_OVERLAP_MIN;
+    if (ovl > SPEECH_OVERLAP_MAX) ovl = SPEECH_OVERLAP_MAX;
+
+    // at nominal tempo the input requirement is sequence + seek window, so the
+    // sequence gets what the seek window leaves of the latency budget. The
+    // sequence has to keep at least two longest pitch periods and two overlaps
+    // though, so too tight budget gets exceeded instead of breaking the voice.
+    double seq = speechLatencyMs - seek;
+    if (seq < 2.0 * periodMax) seq = 2.0 * periodMax;
+    if (seq < 2.0 * ovl) seq = 2.0 * ovl;
+
+    setParameters(sampleRate, (int)ceil(seq), (int)seek, (int)(ovl + 0.5));
 }
 
 
 // Seeks for the optimal overlap-mixing position.
 int TDStretch::seekBestOverlapPosition(const SAMPLETYPE *refPos)
 {
-    if (bQuickSeek)
+    if (seekMode == SEEK_QUICK)
     {
         return seekBestOverlapPositionQuick(refPos);
     }
+    else if (seekMode == SEEK_HIERARCHICAL)
+    {
+        return seekBestOverlapPositionHierarchical(refPos);
+    }
+    else if (seekMode == SEEK_PITCH_GUIDED)
+    {
+        return seekBestOverlapPositionPitchGuided(refPos);
+    }
     else
     {
         return seekBestOverlapPositionFull(refPos);
@@ -277,10 +442,8 @@ int TDStretch::seekBestOverlapPositionFull(const SAMPLETYPE *refPos)
 {
     int bestOffs;
     double bestCorr;
-    int i;
     double norm;
 
-    bestCorr = -FLT_MAX;
     bestOffs = 0;
 
     // Scans for the best correlation value by testing each possible position
@@ -288,40 +451,50 @@ int TDStretch::seekBestOverlapPositionFull(const SAMPLETYPE *refPos)
     bestCorr = calcCrossCorr(refPos, pMidBuffer, norm);
     bestCorr = (bestCorr + 0.1) * 0.75;
 
-    #pragma omp parallel for
-    for (i = 1; i < seekLength; i ++)
+#ifdef SOUNDTOUCH_FLOAT_SAMPLES
+    // split large enough scans over the worker pool threads
+    if (bParallelSeek && ((double)seekLength * overlapLength * channels >= PARALLEL_SEEK_MIN_WORK))
     {
-        double corr;
-        // Calculates correlation value for the mixing position corresponding to 'i'
-#if defined(_OPENMP) || defined(ST_SIMD_AVOID_UNALIGNED)
-        // in parallel OpenMP mode, can't use norm accumulator version as parallel executor won't
-        // iterate the loop in sequential order
-        // in SIMD mode, avoid accumulator version to allow avoiding unaligned positions
-        corr = calcCrossCorr(refPos + channels * i, pMidBuffer, norm);
-#else
-        // In non-parallel version call "calcCrossCorrAccumulate" that is otherwise same
-        // as "calcCrossCorr", but saves time by reusing & updating previously stored
-        // "norm" value
-        corr = calcCrossCorrAccumulate(refPos + channels * i, pMidBuffer, norm);
-#endif
-        // heuristic rule to slightly favour values close to mid of the range
-        double tmp = (double)(2 * i - seekLength) / (double)seekLength;
-        corr = ((corr + 0.1) * (1.0 - 0.25 * tmp * tmp));
+        SeekFullJob job;
+        job.pStretch = this;
+        job.refPos = refPos;
+
+        // If the pool is busy with another stream, or has no workers, this thread
+        // scans the same slices one after the other. Each slice restarts its
+        // normalizer, so the rounding and thus the result doesn't depend on which
+        // threads did the scan. It can differ slightly from the rolling scan below
+        // that is used with the parallel seek disabled.
+        WorkerPool &pool = WorkerPool::getInstance();
+        const int numParts = pool.getNumParts();
+        if (!pool.tryRun(seekFullPart, &job))
+        {
+            for (int part = 0; part < numParts; part ++)
+            {
+                seekFullPart(&job, part, numParts);
+            }
+        }
 
-        // Checks for the highest correlation value
-        if (corr > bestCorr)
+        // pick the best of the parts in the order of their slices, so that equal
+        // correlations resolve to the lowest position as in a single scan
+        for (int part = 0; part < numParts; part ++)
         {
-            // For optimal performance, enter critical section only in case that best value found.
-            // in such case repeat 'if' condition as it's possible that parallel execution may have
-            // updated the bestCorr value in the mean time
-            #pragma omp critical
-            if (corr > bestCorr)
+            if (job.bestCorr[part] > bestCorr)
             {
-                bestCorr = corr;
-                bestOffs = i;
+                bestCorr = job.bestCorr[part];
+                bestOffs = job.bestOffs[part];
             }
         }
+        return bestOffs;
     }
+#endif
+
+#ifdef ST_SIMD_AVOID_UNALIGNED
+    // in SIMD mode the correlation routines skip unaligned positions, the first one
+    // possibly without calculating the normalizer for the accumulator to roll along
+    norm = calcNorm(refPos);
+#endif
+
+    seekFullRange(refPos, 1, seekLength, norm, bestCorr, bestOffs);
 
 #ifdef SOUNDTOUCH_INTEGER_SAMPLES
     adaptNormalizer();
@@ -334,6 +507,56 @@ int TDStretch::seekBestOverlapPositionFull(const SAMPLETYPE *refPos)
 }
 
 
+// Scans the positions from 'start' to 'end' - 1 for the full seek. 'norm' is the
+// normalizer of position 'start' - 1, that the accumulator version rolls along
+void TDStretch::seekFullRange(const SAMPLETYPE *refPos, int start, int end, double norm,
+                              double &bestCorr, int &bestOffs)
+{
+    for (int i = start; i < end; i ++)
+    {
+        // Calculates correlation value for the mixing position corresponding to 'i'.
+        // Call "calcCrossCorrAccumulate" that is otherwise same as "calcCrossCorr", but
+        // saves time by reusing & updating previously stored "norm" value
+        double corr = calcCrossCorrAccumulate(refPos + channels * i, pMidBuffer, norm);
+        // heuristic rule to slightly favour values close to mid of the range
+        double tmp = (double)(2 * i - seekLength) / (double)seekLength;
+        corr = ((corr + 0.1) * (1.0 - 0.25 * tmp * tmp));
+
+        // Checks for the highest correlation value
+        if (corr > bestCorr)
+        {
+            bestCorr = corr;
+            bestOffs = i;
+        }
+    }
+}
+
+
+#ifdef SOUNDTOUCH_FLOAT_SAMPLES
+
+// Scans one slice of the seek range in a worker pool thread. Each part starts
+// its normalizer from scratch and stores its best match in its own slot, so the
+// parts don't need to synchronize with each other.
+void TDStretch::seekFullPart(void *context, int part, int numParts)
+{
+    SeekFullJob *job = (SeekFullJob *)context;
+    TDStretch *stretch = job->pStretch;
+    const int start = 1 + (stretch->seekLength - 1) * part / numParts;
+    const int end = 1 + (stretch->seekLength - 1) * (part + 1) / numParts;
+
+    job->bestCorr[part] = -FLT_MAX;
+    job->bestOffs[part] = 0;
+    if (start < end)
+    {
+        const double norm = stretch->calcNorm(job->refPos + stretch->channels * (start - 1));
+        stretch->seekFullRange(job->refPos, start, end, norm, job->bestCorr[part], job->bestOffs[part]);
+    }
+    stretch->clearCrossCorrState();
+}
+
+#endif // SOUNDTOUCH_FLOAT_SAMPLES
+
+
 // Quick seek algorithm for improved runtime-performance: First roughly scans through the
 // correlation area, and then scan surroundings of two best preliminary correlation candidates
 // with improved precision
@@ -454,6 +677,302 @@ int TDStretch::seekBestOverlapPositionQuick(const SAMPLETYPE *refPos)
 }
 
 
+// Sums 'COARSE_DECIMATION' consecutive frames of all channels of 'src' into each of
+// the 'numBlocks' samples of 'dest'
+void TDStretch::decimate(float *dest, const SAMPLETYPE *src, int numBlocks) const
+{
+    const int blockSamples = COARSE_DECIMATION * channels;
+
+    for (int i = 0; i < numBlocks; i ++)
+    {
+        float sum = 0;
+        for (int j = 0; j < blockSamples; j ++)
+        {
+            sum += (float)src[j];
+        }
+        dest[i] = sum;
+        src += blockSamples;
+    }
+}
+
+
+// Hierarchical seek algorithm: First correlates the decimated overlap reference
+// at every position of the decimated seek range, which is cheap as both signal
+// length and position count are divided by the decimation factor and the channels
+// are mixed together. Then scans surroundings of the two best decimated matches
+// with full resolution, like the quick seek does.
+//
+// As the first pass covers all positions instead of every 16th one, it doesn't
+// miss narrow correlation peaks the way the quick seek may, and ends up at the
+// same position as the full seek in most cases.
+int TDStretch::seekBestOverlapPositionHierarchical(const SAMPLETYPE *refPos)
+{
+    const int ovlCoarse = overlapLength / COARSE_DECIMATION;
+    const int numCoarse = (seekLength - 1) / COARSE_DECIMATION + 1;
+
+    float *pMidCoarse = pCoarseBuffer;
+    float *pInputCoarse = pMidCoarse + ovlCoarse;
+    float *pCorrCoarse = pInputCoarse + numCoarse + ovlCoarse;
+    float *pPitchCoarse = pCorrCoarse + numCoarse;
+    assert(ovlCoarse + (numCoarse + ovlCoarse) + 2 * numCoarse <= coarseBufferSize);
+
+    decimate(pMidCoarse, pMidBuffer, ovlCoarse);
+    decimate(pInputCoarse, refPos, numCoarse + ovlCoarse - 1);
+
+    // normalizer of the reference, for the plain correlation that the pitch guided
+    // seek detects the pitch period from
+    double midNorm = 0;
+    for (int k = 0; k < ovlCoarse; k ++)
+    {
+        midNorm += (double)pMidCoarse[k] * pMidCoarse[k];
+    }
+    const float midScale = (float)(1.0 / sqrt((midNorm < 1e-9) ? 1.0 : midNorm));
+
+    // First pass: correlation of the decimated signals at each decimated position.
+    // The normalizer of the seek range window rolls along with the position.
+    double norm = 0;
+    int i, j;
+    for (j = 0; j < ovlCoarse - 1; j ++)
+    {
+        norm += (double)pInputCoarse[j] * pInputCoarse[j];
+    }
+
+    // eight partial sums so that the compiler can vectorize the correlation loop
+    const int ovlCoarse8 = ovlCoarse & -8;
+    int bestCoarse = 0;
+    for (i = 0; i < numCoarse; i ++)
+    {
+        const float *pInput = pInputCoarse + i;
+        float sums[8] = { 0 };
+
+        norm += (double)pInput[ovlCoarse - 1] * pInput[ovlCoarse - 1];
+        for (j = 0; j < ovlCoarse8; j += 8)
+        {
+            for (int k = 0; k < 8; k ++)
+            {
+                sums[k] += pMidCoarse[j + k] * pInput[j + k];
+            }
+        }
+        for (; j < ovlCoarse; j ++)
+        {
+            sums[0] += pMidCoarse[j] * pInput[j];
+        }
+        float corr = ((sums[0] + sums[1]) + (sums[2] + sums[3])) + ((sums[4] + sums[5]) + (sums[6] + sums[7]));
+
+        corr = (float)(corr / sqrt((norm < 1e-9) ? 1.0 : norm));
+        // plain correlation offset to 0..2 range, for the non-negative peak finder input
+        pPitchCoarse[i] = 1.0f + corr * midScale;
+        // heuristic rule to slightly favour values close to mid of the seek range
+        float tmp = (float)(2 * i * COARSE_DECIMATION - seekLength - 1) / (float)seekLength;
+        pCorrCoarse[i] = (corr + 0.1f) * (1.0f - 0.25f * tmp * tmp);
+        if (pCorrCoarse[i] > pCorrCoarse[bestCoarse]) bestCoarse = i;
+
+        norm -= (double)pInput[0] * pInput[0];
+    }
+
+    // 2nd best match that isn't a neighbour of the best one, as the neighbours belong
+    // to the same correlation peak and get scanned with it anyway
+    int bestCoarse2 = -1;
+    for (i = 0; i < numCoarse; i ++)
+    {
+        if ((i >= bestCoarse - 1) && (i <= bestCoarse + 1)) continue;
+        if ((bestCoarse2 < 0) || (pCorrCoarse[i] > pCorrCoarse[bestCoarse2])) bestCoarse2 = i;
+    }
+
+    // Second pass: scan surroundings of the decimated matches with full resolution.
+    // A decimated position stands for 'COARSE_DECIMATION' positions, and the peak may
+    // be in between two of them
+    float bestCorr = -FLT_MAX;
+    int bestOffs = 0;
+    const int candidates[2] = { bestCoarse, bestCoarse2 };
+    for (int c = 0; c < 2; c ++)
+    {
+        if (candidates[c] < 0) break;
+
+        const int center = candidates[c] * COARSE_DECIMATION;
+        const int start = (center - COARSE_DECIMATION + 1 > 0) ? (center - COARSE_DECIMATION + 1) : 0;
+        const int end = _MIN(center + COARSE_DECIMATION, seekLength);
+        for (i = start; i < end; i ++)
+        {
+            double dnorm;
+            // Calculates correlation value for the mixing position corresponding
+            // to 'i'
+            float corr = (float)calcCrossCorr(refPos + channels * i, pMidBuffer, dnorm);
+            // heuristic rule to slightly favour values close to mid of the range
+            float tmp = (float)(2 * i - seekLength - 1) / (float)seekLength;
+            corr = ((corr + 0.1f) * (1.0f - 0.25f * tmp * tmp));
+
+            // Checks for the highest correlation value
+            if (corr > bestCorr)
+            {
+                bestCorr = corr;
+                bestOffs = i;
+            }
+        }
+    }
+
+    // clear cross correlation routine state if necessary (is so e.g. in MMX routines).
+    clearCrossCorrState();
+
+#ifdef SOUNDTOUCH_INTEGER_SAMPLES
+    adaptNormalizer();
+#endif
+
+    return bestOffs;
+}
+
+
+// Pitch guided seek algorithm for voiced speech: Voiced sound is nearly periodic,
+// so the positions that match the overlap reference best are the seamless
+// continuation position of the previous sequence plus multiples of the pitch
+// period. Scans just the surroundings of the positions nearest to the mid of the
+// seek range, widening the scanned area with the distance to allow for the pitch
+// changing meanwhile, and tracks the pitch period from where the best match was
+// found.
+//
+// Unvoiced sound or a lost period falls back to the hierarchical seek, and its
+// decimated correlation over the whole seek range, which peaks at multiples of
+// the pitch period for voiced sound, gives the period to track.
+int TDStretch::seekBestOverlapPositionPitchGuided(const SAMPLETYPE *refPos)
+{
+    const int minPeriod = sampleRate / speechMaxF0;
+    const int maxPeriod = sampleRate / speechMinF0;
+
+    if (pitchPeriod > 0)
+    {
+        // the period multiples match about equally well and the weighting favours
+        // the mid of the range, so it's enough to scan the ones nearest to the mid
+        const int midK = (int)floor((0.5 * seekLength - midBufferPos) / pitchPeriod + 0.5);
+        const int firstK = max(midK - PITCH_CANDIDATES / 2, (int)ceil(-midBufferPos / pitchPeriod - 0.5));
+        const int lastK = _MIN(midK + PITCH_CANDIDATES / 2, (int)floor((seekLength - 1 - midBufferPos) / pitchPeriod + 0.5));
+        float bestCorr = -FLT_MAX;
+        double bestRaw = 0;
+        int bestOffs = -1;
+        int bestK = 0;
+
+        for (int k = firstK; k <= lastK; k ++)
+        {
+            const int center = (int)floor(midBufferPos + k * pitchPeriod + 0.5);
+            const int wind = 2 + (int)(PITCH_TOLERANCE * ((k < 0) ? -k : k) * pitchPeriod);
+            const int start = (center - wind > 0) ? (center - wind) : 0;
+            const int end = _MIN(center + wind + 1, seekLength);
+            float localCorr = -FLT_MAX;
+            double localRaw = 0;
+            int localOffs = -1;
+            int step = 1;
+
+            // scans the area around the candidate and then, if the pitch has changed
+            // more than the area allows for and the best match is at its edge,
+            // follows the correlation uphill past the edge
+            for (int i = start; (i >= 0) && (i < seekLength); i += step)
+            {
+                double norm;
+                // Calculates correlation value for the mixing position corresponding
+                // to 'i'
+                const double raw = calcCrossCorr(refPos + channels * i, pMidBuffer, norm);
+                // heuristic rule to slightly favour values close to mid of the range
+                float tmp = (float)(2 * i - seekLength - 1) / (float)seekLength;
+                float corr = (((float)raw + 0.1f) * (1.0f - 0.25f * tmp * tmp));
+
+                if (corr > localCorr)
+                {
+                    localCorr = corr;
+                    localRaw = raw;
+                    localOffs = i;
+                }
+                else if (i >= end)
+                {
+                    break;
+                }
+
+                if (i == end - 1)
+                {
+                    if (localOffs == start)
+                    {
+                        // climb downwards from the start
+                        if (start == 0) break;
+                        step = -1;
+                        i = start;
+                    }
+                    else if (localOffs != end - 1)
+                    {
+                        break;
+                    }
+                }
+                else if ((step < 0) && (localOffs != i))
+                {
+                    break;
+                }
+            }
+
+            // Checks for the highest correlation value
+            if (localCorr > bestCorr)
+            {
+                bestCorr = localCorr;
+                bestRaw = localRaw;
+                bestOffs = localOffs;
+                bestK = k;
+            }
+        }
+
+        clearCrossCorrState();
+
+        // still voiced if the best match correlates well enough with the reference
+        const double refNorm = calcNorm(pMidBuffer);
+        if ((bestOffs >= 0) && (bestRaw >= VOICED_CORRELATION * sqrt((refNorm < 1e-9) ? 1.0 : refNorm)))
+        {
+            // track the pitch period from the distance of the best match from the
+            // seamless continuation position
+            if (bestK != 0)
+            {
+                const double period = (double)(bestOffs - midBufferPos) / bestK;
+                if ((period >= minPeriod) && (period <= maxPeriod))
+                {
+                    pitchPeriod = 0.5 * (pitchPeriod + period);
+                }
+            }
+
+#ifdef SOUNDTOUCH_INTEGER_SAMPLES
+            adaptNormalizer();
+#endif
+            return bestOffs;
+        }
+
+        pitchPeriod = 0;
+    }
+
+    const int bestOffs = seekBestOverlapPositionHierarchical(refPos);
+
+    // detect the pitch period from the plain decimated correlation
+    const int numCoarse = (seekLength - 1) / COARSE_DECIMATION + 1;
+    const float *pPitchCoarse = pCoarseBuffer + 2 * (overlapLength / COARSE_DECIMATION) + 2 * numCoarse;
+    PeakFinder peakFinder;
+    pitchPeriod = COARSE_DECIMATION * peakFinder.detectPeriod(pPitchCoarse, 0, numCoarse,
+        minPeriod / COARSE_DECIMATION, (maxPeriod + COARSE_DECIMATION - 1) / COARSE_DECIMATION,
+        (float)(1.0 + VOICED_CORRELATION));
+
+    return bestOffs;
+}
+
+
+/// Calculates the normalizer of 'overlapLength' samples at 'pos' the same way
+/// as 'calcCrossCorrAccumulate' rolls the normalizer of the compared samples
+double TDStretch::calcNorm(const SAMPLETYPE *pos) const
+{
+    double norm = 0;
+
+    for (int i = 0; i < channels * overlapLength; i ++)
+    {
+#ifdef SOUNDTOUCH_INTEGER_SAMPLES
+        norm += (pos[i] * pos[i]) >> overlapDividerBitsNorm;
+#else
+        norm += pos[i] * pos[i];
+#endif
+    }
+    return norm;
+}
+
+
 
 
 /// For integer algorithm: adapt normalization factor divider with music so that
@@ -537,6 +1056,35 @@ void TDStretch::calcSeqParameters()
         seekWindowLength = 2 * overlapLength;
     }
     seekLength = (sampleRate * seekWindowMs) / 1000;
+
+    allocCoarseBuffer();
+}
+
+
+/// Reallocates the work buffer of the hierarchical seek if the current sequence
+/// parameters need a larger one. With the automatic seek window setting, the
+/// buffer is sized for the widest automatic seek window, so that tempo changes
+/// don't reallocate it.
+void TDStretch::allocCoarseBuffer()
+{
+    int maxSeekLength = seekLength;
+    if (bAutoSeekSetting)
+    {
+        const int autoSeekLength = (int)(sampleRate * AUTOSEEK_AT_MIN / 1000) + 1;
+        if (autoSeekLength > maxSeekLength) maxSeekLength = autoSeekLength;
+    }
+
+    // decimated reference and seek range, and weighted and plain correlation for
+    // each decimated position
+    const int numCoarse = maxSeekLength / COARSE_DECIMATION + 1;
+    const int size = 2 * (overlapLength / COARSE_DECIMATION) + 3 * numCoarse;
+
+    if (size > coarseBufferSize)
+    {
+        delete[] pCoarseBuffer;
+        pCoarseBuffer = new float[size];
+        coarseBufferSize = size;
+    }
 }
 
 
@@ -645,8 +1193,8 @@ void TDStretch::processSamples()
             // samples in 'midBuffer' using sliding overlapping
             // ... first partially overlap with the end of the previous sequence
             // (that's in 'midBuffer')
-            overlap(outputBuffer.ptrEnd((uint)overlapLength), inputBuffer.ptrBegin(), (uint)offset);
-            outputBuffer.putSamples((uint)overlapLength);
+            overlap(pOutputTarget->ptrEnd((uint)overlapLength), inputBuffer.ptrBegin(), (uint)offset);
+            pOutputTarget->putSamples((uint)overlapLength);
             offset += overlapLength;
         }
         else
@@ -654,20 +1202,7 @@ void TDStretch::processSamples()
             // Adjust processing offset at beginning of track by not perform initial overlapping
             // and compensating that in the 'input buffer skip' calculation
             isBeginning = false;
-            int skip = (int)(tempo * overlapLength + 0.5 * seekLength + 0.5);
-
-            #ifdef ST_SIMD_AVOID_UNALIGNED
-            // in SIMD mode, round the skip amount to value corresponding to aligned memory address
-            if (channels == 1)
-            {
-                skip &= -4;
-            }
-            else if (channels == 2)
-            {
-                skip &= -2;
-            }
-            #endif
-            skipFract -= skip;
+            skipFract -= getInitialSkip();
             if (skipFract <= -nominalSkip)
             {
                 skipFract = -nominalSkip;
@@ -684,7 +1219,7 @@ void TDStretch::processSamples()
 
         // length of sequence
         temp = (seekWindowLength - 2 * overlapLength);
-        outputBuffer.putSamples(inputBuffer.ptrBegin() + channels * offset, (uint)temp);
+        pOutputTarget->putSamples(inputBuffer.ptrBegin() + channels * offset, (uint)temp);
 
         // Copies the end of the current sequence from 'inputBuffer' to
         // 'midBuffer' for being mixed with the beginning of the next
@@ -700,10 +1235,68 @@ void TDStretch::processSamples()
         ovlSkip = (int)skipFract;   // rounded to integer skip
         skipFract -= ovlSkip;       // maintain the fraction part, i.e. real vs. integer skip
         inputBuffer.receiveSamples((uint)ovlSkip);
+
+        // the seek position where the next sequence would continue 'midBuffer' seamlessly
+        midBufferPos = offset + temp - ovlSkip;
     }
 }
 
 
+// Returns the input buffer skip at the beginning of track, that compensates for
+// not performing the initial overlapping
+int TDStretch::getInitialSkip() const
+{
+    int skip = (int)(tempo * overlapLength + 0.5 * seekLength + 0.5);
+
+    #ifdef ST_SIMD_AVOID_UNALIGNED
+    // in SIMD mode, round the skip amount to value corresponding to aligned memory address
+    if (channels == 1)
+    {
+        skip &= -4;
+    }
+    else if (channels == 2)
+    {
+        skip &= -2;
+    }
+    #endif
+    return skip;
+}
+
+
+// Returns exact number of input samples needed before 'numOutput' samples come out.
+// Replays the batch and skip bookkeeping of 'processSamples' from a cleared state.
+int TDStretch::getInputLatency(int numOutput) const
+{
+    int numInput = 0;
+    int numProduced;
+    double fract;
+
+    if (numOutput <= 0) return 0;
+
+    // the first batch outputs the sequence without the initial overlapping
+    fract = -getInitialSkip();
+    if (fract <= -nominalSkip)
+    {
+        fract = -nominalSkip;
+    }
+    numProduced = seekWindowLength - 2 * overlapLength;
+
+    // each further batch needs 'sampleReq' samples again after the skip
+    while (numProduced < numOutput)
+    {
+        int skip;
+
+        fract += nominalSkip;
+        skip = (int)fract;
+        fract -= skip;
+        numInput += skip;
+        numProduced += seekWindowLength - overlapLength;
+    }
+
+    return numInput + sampleReq;
+}
+
+
 // Adds 'numsamples' pcs of samples from the 'samples' memory position into
 // the input of the object.
 void TDStretch::putSamples(const SAMPLETYPE *samples, uint nSamples)
@@ -715,6 +1308,21 @@ void TDStretch::putSamples(const SAMPLETYPE *samples, uint nSamples)
 }
 
 
+// Processes the samples written directly into the input buffer
+void TDStretch::processInput()
+{
+    processSamples();
+}
+
+
+// Sets the buffer where the processed samples get written, nullptr for the own
+// output buffer
+void TDStretch::setOutputTarget(FIFOSampleBuffer *target)
+{
+    pOutputTarget = (target != nullptr) ? target : &outputBuffer;
+}
+
+
 
 /// Set new overlap length parameter & reallocate RefMidBuffer if necessary.
 void TDStretch::acceptNewOverlapLength(int newOverlapLength)
@@ -734,6 +1342,49 @@ void TDStretch::acceptNewOverlapLength(int newOverlapLength)
         pMidBuffer = (SAMPLETYPE *)SOUNDTOUCH_ALIGN_POINTER_16(pMidBufferUnaligned);
 
         clearMidBuffer();
+
+        delete[] pOverlapWindowUnaligned;
+
+        pOverlapWindowUnaligned = new SAMPLETYPE[2 * overlapLength + 16 / sizeof(SAMPLETYPE)];
+        pOverlapWindow = (SAMPLETYPE *)SOUNDTOUCH_ALIGN_POINTER_16(pOverlapWindowUnaligned);
+    }
+
+    // the crossfade weights depend on the exact overlap length
+    calcOverlapWindow();
+}
+
+
+/// Calculates the crossfade weights of the overlap for the current overlap length.
+/// The fade-in and fade-out weights always sum up to one, or to 'overlapLength'
+/// with integer samples, so that the overlap keeps the level of correlated sequences.
+void TDStretch::calcOverlapWindow()
+{
+    if (overlapLength == 0) return;
+
+    SAMPLETYPE *pFadeIn = pOverlapWindow;
+    SAMPLETYPE *pFadeOut = pOverlapWindow + overlapLength;
+    const double fScale = 1.0 / (double)overlapLength;
+    const double pi = 3.14159265358979323846;
+
+    for (int i = 0; i < overlapLength; i ++)
+    {
+#ifdef SOUNDTOUCH_INTEGER_SAMPLES
+        int m1 = i;
+        if (bRaisedCosineOverlap)
+        {
+            m1 = (int)(overlapLength * (0.5 - 0.5 * cos(pi * i * fScale)) + 0.5);
+        }
+        pFadeIn[i] = (short)m1;
+        pFadeOut[i] = (short)(overlapLength - m1);
+#else
+        float f1 = (float)i * (float)fScale;
+        if (bRaisedCosineOverlap)
+        {
+            f1 = (float)(0.5 - 0.5 * cos(pi * i * fScale));
+        }
+        pFadeIn[i] = f1;
+        pFadeOut[i] = 1.0f - f1;
+#endif
     }
 }
 
@@ -791,20 +1442,31 @@ TDStretch * TDStretch::newInstance()
 
 #ifdef SOUNDTOUCH_INTEGER_SAMPLES
 
+// Overlaps samples in 'midBuffer' with the samples in 'pInput'
+void TDStretch::overlapMono(short *pOutput, const short *pInput) const
+{
+    const short *pFadeIn = pOverlapWindow;
+    const short *pFadeOut = pOverlapWindow + overlapLength;
+
+    for (int i = 0; i < overlapLength ; i ++)
+    {
+        pOutput[i] = (pInput[i] * pFadeIn[i] + pMidBuffer[i] * pFadeOut[i]) / overlapLength;
+    }
+}
+
+
 // Overlaps samples in 'midBuffer' with the samples in 'input'. The 'Stereo'
 // version of the routine.
 void TDStretch::overlapStereo(short *poutput, const short *input) const
 {
-    int i;
-    short temp;
-    int cnt2;
+    const short *pFadeIn = pOverlapWindow;
+    const short *pFadeOut = pOverlapWindow + overlapLength;
 
-    for (i = 0; i < overlapLength ; i ++)
+    for (int i = 0; i < overlapLength ; i ++)
     {
-        temp = (short)(overlapLength - i);
-        cnt2 = 2 * i;
-        poutput[cnt2] = (input[cnt2] * i + pMidBuffer[cnt2] * temp )  / overlapLength;
-        poutput[cnt2 + 1] = (input[cnt2 + 1] * i + pMidBuffer[cnt2 + 1] * temp ) / overlapLength;
+        const int cnt2 = 2 * i;
+        poutput[cnt2] = (input[cnt2] * pFadeIn[i] + pMidBuffer[cnt2] * pFadeOut[i]) / overlapLength;
+        poutput[cnt2 + 1] = (input[cnt2 + 1] * pFadeIn[i] + pMidBuffer[cnt2 + 1] * pFadeOut[i]) / overlapLength;
     }
 }
 
@@ -813,15 +1475,15 @@ void TDStretch::overlapStereo(short *poutput, const short *input) const
 // version of the routine.
 void TDStretch::overlapMulti(short *poutput, const short *input) const
 {
-    short m1;
+    const short *pFadeIn = pOverlapWindow;
+    const short *pFadeOut = pOverlapWindow + overlapLength;
     int i = 0;
 
-    for (m1 = 0; m1 < overlapLength; m1 ++)
+    for (int n = 0; n < overlapLength; n ++)
     {
-        short m2 = (short)(overlapLength - m1);
         for (int c = 0; c < channels; c ++)
         {
-            poutput[i] = (input[i] * m1 + pMidBuffer[i] * m2)  / overlapLength;
+            poutput[i] = (input[i] * pFadeIn[n] + pMidBuffer[i] * pFadeOut[n]) / overlapLength;
             i++;
         }
     }
@@ -920,6 +1582,20 @@ double TDStretch::calcCrossCorrAccumulate(const short *mixingPos, const short *c
         lnorm -= (mixingPos[-i] * mixingPos[-i]) >> overlapDividerBitsNorm;
     }
 
+    #ifdef ST_SIMD_AVOID_UNALIGNED
+        // in SIMD mode skip 'mixingPos' positions that aren't aligned to 16-byte boundary,
+        // just rolling the normalizer along
+        if (((ulongptr)mixingPos) & 15)
+        {
+            for (i = 1; i <= channels; i ++)
+            {
+                lnorm += (mixingPos[ilength - i] * mixingPos[ilength - i]) >> overlapDividerBitsNorm;
+            }
+            norm += (double)lnorm;
+            return -1e50;
+        }
+    #endif
+
     corr = 0;
     // Same routine for stereo and mono.
     for (i = 0; i < ilength; i += 2)
@@ -955,55 +1631,108 @@ double TDStretch::calcCrossCorrAccumulate(const short *mixingPos, const short *c
 
 #ifdef SOUNDTOUCH_FLOAT_SAMPLES
 
-// Overlaps samples in 'midBuffer' with the samples in 'pInput'
-void TDStretch::overlapStereo(float *pOutput, const float *pInput) const
+// Channel count specialized routines. The channel count is given as template
+// parameter so that the compiler can unroll the inner loops and vectorize them
+// with constant strides. CHANNELS = 0 selects the generic version that uses the
+// runtime channel count 'numChannels' instead.
+
+// Overlaps samples in 'pMidBuffer' with the samples in 'pInput', using the fade-in
+// and fade-out weights that follow each other in 'pWindow'
+template <int CHANNELS>
+static inline void overlapChannels(float *pOutput, const float *pInput, const float *pMidBuffer,
+                                   const float *pWindow, int overlapLength, int numChannels)
 {
-    int i;
-    float fScale;
-    float f1;
-    float f2;
+    const int nch = CHANNELS ? CHANNELS : numChannels;
+
+    for (int i = 0; i < overlapLength; i ++)
+    {
+        const float f1 = pWindow[i];
+        const float f2 = pWindow[overlapLength + i];
 
-    fScale = 1.0f / (float)overlapLength;
+        for (int c = 0; c < nch; c ++)
+        {
+            pOutput[nch * i + c] = pInput[nch * i + c] * f1 + pMidBuffer[nch * i + c] * f2;
+        }
+    }
+}
 
-    f1 = 0;
-    f2 = 1.0f;
 
-    for (i = 0; i < 2 * (int)overlapLength ; i += 2)
+// Calculates cross-correlation and normalizer sums over 'CHANNELS * overlapLength'
+// samples. Splits the sums to eight partial sums as the compiler isn't allowed to
+// reorder floating point additions for vectorizing the loop by itself.
+template <int CHANNELS>
+static inline float crossCorrChannels(const float *mixingPos, const float *compare,
+                                      int overlapLength, int numChannels, float *pNorm)
+{
+    const int nch = CHANNELS ? CHANNELS : numChannels;
+    // overlap length is divisible by 8
+    const int ilength = (nch * overlapLength) & -8;
+    float corr[8] = { 0 };
+    float norm[8] = { 0 };
+
+    for (int i = 0; i < ilength; i += 8)
     {
-        pOutput[i + 0] = pInput[i + 0] * f1 + pMidBuffer[i + 0] * f2;
-        pOutput[i + 1] = pInput[i + 1] * f1 + pMidBuffer[i + 1] * f2;
+        for (int j = 0; j < 8; j ++)
+        {
+            corr[j] += mixingPos[i + j] * compare[i + j];
+            norm[j] += mixingPos[i + j] * mixingPos[i + j];
+        }
+    }
 
-        f1 += fScale;
-        f2 -= fScale;
+    if (pNorm)
+    {
+        *pNorm = ((norm[0] + norm[1]) + (norm[2] + norm[3])) + ((norm[4] + norm[5]) + (norm[6] + norm[7]));
     }
+    return ((corr[0] + corr[1]) + (corr[2] + corr[3])) + ((corr[4] + corr[5]) + (corr[6] + corr[7]));
 }
 
 
-// Overlaps samples in 'midBuffer' with the samples in 'input'.
-void TDStretch::overlapMulti(float *pOutput, const float *pInput) const
+// Same as 'crossCorrChannels', but updates the previous round's normalizer 'norm'
+// instead of recalculating it
+template <int CHANNELS>
+static inline float crossCorrAccumulateChannels(const float *mixingPos, const float *compare,
+                                                int overlapLength, int numChannels, double &norm)
 {
-    int i;
-    float fScale;
-    float f1;
-    float f2;
+    const int nch = CHANNELS ? CHANNELS : numChannels;
+    const int ilength = (nch * overlapLength) & -8;
+    int c;
 
-    fScale = 1.0f / (float)overlapLength;
+    // cancel first normalizer tap from previous round
+    for (c = 1; c <= nch; c ++)
+    {
+        norm -= mixingPos[-c] * mixingPos[-c];
+    }
 
-    f1 = 0;
-    f2 = 1.0f;
+    const float corr = crossCorrChannels<CHANNELS>(mixingPos, compare, overlapLength, numChannels, nullptr);
 
-    i=0;
-    for (int i2 = 0; i2 < overlapLength; i2 ++)
+    // update normalizer with last samples of this round
+    for (c = 1; c <= nch; c ++)
     {
-        // note: Could optimize this slightly by taking into account that always channels > 2
-        for (int c = 0; c < channels; c ++)
-        {
-            pOutput[i] = pInput[i] * f1 + pMidBuffer[i] * f2;
-            i++;
-        }
-        f1 += fScale;
-        f2 -= fScale;
+        norm += mixingPos[ilength - c] * mixingPos[ilength - c];
     }
+
+    return corr;
+}
+
+
+// Overlaps samples in 'midBuffer' with the samples in 'pInput'
+void TDStretch::overlapMono(float *pOutput, const float *pInput) const
+{
+    overlapChannels<1>(pOutput, pInput, pMidBuffer, pOverlapWindow, overlapLength, 1);
+}
+
+
+// Overlaps samples in 'midBuffer' with the samples in 'pInput'
+void TDStretch::overlapStereo(float *pOutput, const float *pInput) const
+{
+    overlapChannels<2>(pOutput, pInput, pMidBuffer, pOverlapWindow, overlapLength, 2);
+}
+
+
+// Overlaps samples in 'midBuffer' with the samples in 'input'.
+void TDStretch::overlapMulti(float *pOutput, const float *pInput) const
+{
+    overlapChannels<0>(pOutput, pInput, pMidBuffer, pOverlapWindow, overlapLength, channels);
 }
 
 
@@ -1028,22 +1757,25 @@ double TDStretch::calcCrossCorr(const float *mixingPos, const float *compare, do
 {
     float corr;
     float norm;
-    int i;
 
     #ifdef ST_SIMD_AVOID_UNALIGNED
         // in SIMD mode skip 'mixingPos' positions that aren't aligned to 16-byte boundary
         if (((ulongptr)mixingPos) & 15) return -1e50;
     #endif
 
-    // hint compiler autovectorization that loop length is divisible by 8
-    int ilength = (channels * overlapLength) & -8;
-
-    corr = norm = 0;
-    // Same routine for stereo and mono
-    for (i = 0; i < ilength; i ++)
+#ifndef USE_MULTICH_ALWAYS
+    if (channels == 1)
+    {
+        corr = crossCorrChannels<1>(mixingPos, compare, overlapLength, 1, &norm);
+    }
+    else if (channels == 2)
+    {
+        corr = crossCorrChannels<2>(mixingPos, compare, overlapLength, 2, &norm);
+    }
+    else
+#endif // USE_MULTICH_ALWAYS
     {
-        corr += mixingPos[i] * compare[i];
-        norm += mixingPos[i] * mixingPos[i];
+        corr = crossCorrChannels<0>(mixingPos, compare, overlapLength, channels, &norm);
     }
 
     anorm = norm;
@@ -1055,30 +1787,34 @@ double TDStretch::calcCrossCorr(const float *mixingPos, const float *compare, do
 double TDStretch::calcCrossCorrAccumulate(const float *mixingPos, const float *compare, double &norm)
 {
     float corr;
-    int i;
 
-    corr = 0;
+    #ifdef ST_SIMD_AVOID_UNALIGNED
+        // in SIMD mode skip 'mixingPos' positions that aren't aligned to 16-byte boundary,
+        // just rolling the normalizer along
+        if (((ulongptr)mixingPos) & 15)
+        {
+            const float *pEnd = mixingPos + channels * overlapLength;
+            for (int c = 1; c <= channels; c ++)
+            {
+                norm += pEnd[-c] * pEnd[-c] - mixingPos[-c] * mixingPos[-c];
+            }
+            return -1e50;
+        }
+    #endif
 
-    // cancel first normalizer tap from previous round
-    for (i = 1; i <= channels; i ++)
+#ifndef USE_MULTICH_ALWAYS
+    if (channels == 1)
     {
-        norm -= mixingPos[-i] * mixingPos[-i];
+        corr = crossCorrAccumulateChannels<1>(mixingPos, compare, overlapLength, 1, norm);
     }
-
-    // hint compiler autovectorization that loop length is divisible by 8
-    int ilength = (channels * overlapLength) & -8;
-
-    // Same routine for stereo and mono
-    for (i = 0; i < ilength; i ++)
+    else if (channels == 2)
     {
-        corr += mixingPos[i] * compare[i];
+        corr = crossCorrAccumulateChannels<2>(mixingPos, compare, overlapLength, 2, norm);
     }
-
-    // update normalizer with last samples of this round
-    for (int j = 0; j < channels; j ++)
+    else
+#endif // USE_MULTICH_ALWAYS
     {
-        i --;
-        norm += mixingPos[i] * mixingPos[i];
+        corr = crossCorrAccumulateChannels<0>(mixingPos, compare, overlapLength, channels, norm);
     }
 
     return corr / sqrt((norm < 1e-9 ? 1.0 : norm));
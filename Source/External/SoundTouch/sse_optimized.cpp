@@ -132,6 +132,20 @@ double TDStretchSSE::calcCrossCorr(const float *pV1, const float *pV2, double &a
         pVec2 += 4;
     }
 
+    // overlapLength is only divisible by 8, so for mono sound there can be 8
+    // samples left over from the unrolled loop
+    if ((channels * overlapLength) & 8)
+    {
+        __m128 vTemp;
+        vTemp = _MM_LOAD(pVec1);
+        vSum  = _mm_add_ps(vSum,  _mm_mul_ps(vTemp ,pVec2[0]));
+        vNorm = _mm_add_ps(vNorm, _mm_mul_ps(vTemp ,vTemp));
+
+        vTemp = _MM_LOAD(pVec1 + 4);
+        vSum  = _mm_add_ps(vSum, _mm_mul_ps(vTemp, pVec2[1]));
+        vNorm = _mm_add_ps(vNorm, _mm_mul_ps(vTemp ,vTemp));
+    }
+
     // return value = vSum[0] + vSum[1] + vSum[2] + vSum[3]
     float *pvNorm = (float*)&vNorm;
     float norm = (pvNorm[0] + pvNorm[1] + pvNorm[2] + pvNorm[3]);
@@ -176,12 +190,119 @@ double TDStretchSSE::calcCrossCorr(const float *pV1, const float *pV2, double &a
 
 
 
+// Calculates cross correlation of two buffers like calcCrossCorr, but rolls the
+// normalizer along from the previous position instead of summing it up again, so
+// that the vector loop does only half the multiplications
 double TDStretchSSE::calcCrossCorrAccumulate(const float *pV1, const float *pV2, double &norm)
 {
-    // call usual calcCrossCorr function because SSE does not show big benefit of
-    // accumulating "norm" value, and also the "norm" rolling algorithm would get
-    // complicated due to SSE-specific alignment-vs-nonexact correlation rules.
-    return calcCrossCorr(pV1, pV2, norm);
+    int i;
+    const float *pVec1;
+    const __m128 *pVec2;
+    __m128 vSum0, vSum1, vSum2, vSum3;
+
+    // cancel first normalizer tap from previous round and update normalizer with
+    // last samples of this round, also on the skipped unaligned locations
+    pVec1 = pV1 + channels * overlapLength;
+    for (i = 1; i <= channels; i ++)
+    {
+        norm += pVec1[-i] * pVec1[-i] - pV1[-i] * pV1[-i];
+    }
+
+#ifdef ST_SIMD_AVOID_UNALIGNED
+    if (((ulongptr)pV1) & 15) return -1e50;    // skip unaligned locations
+#endif
+
+    // ensure overlapLength is divisible by 8
+    assert((overlapLength % 8) == 0);
+
+    pVec1 = (const float*)pV1;
+    pVec2 = (const __m128*)pV2;
+    vSum0 = vSum1 = vSum2 = vSum3 = _mm_setzero_ps();
+
+    // Four independent sums so that the additions don't wait for each other
+    for (i = 0; i < channels * overlapLength / 16; i ++)
+    {
+        vSum0 = _mm_add_ps(vSum0, _mm_mul_ps(_MM_LOAD(pVec1), pVec2[0]));
+        vSum1 = _mm_add_ps(vSum1, _mm_mul_ps(_MM_LOAD(pVec1 + 4), pVec2[1]));
+        vSum2 = _mm_add_ps(vSum2, _mm_mul_ps(_MM_LOAD(pVec1 + 8), pVec2[2]));
+        vSum3 = _mm_add_ps(vSum3, _mm_mul_ps(_MM_LOAD(pVec1 + 12), pVec2[3]));
+
+        pVec1 += 16;
+        pVec2 += 4;
+    }
+
+    // Same 8-sample tail as in calcCrossCorr, so that the correlation covers the
+    // same samples as the rolled normalizer
+    if ((channels * overlapLength) & 8)
+    {
+        vSum0 = _mm_add_ps(vSum0, _mm_mul_ps(_MM_LOAD(pVec1), pVec2[0]));
+        vSum1 = _mm_add_ps(vSum1, _mm_mul_ps(_MM_LOAD(pVec1 + 4), pVec2[1]));
+    }
+
+    // return value = vSum[0] + vSum[1] + vSum[2] + vSum[3]
+    __m128 vSum = _mm_add_ps(_mm_add_ps(vSum0, vSum1), _mm_add_ps(vSum2, vSum3));
+    float *pvSum = (float*)&vSum;
+    return (double)(pvSum[0] + pvSum[1] + pvSum[2] + pvSum[3]) / sqrt(norm < 1e-9 ? 1.0 : norm);
+}
+
+
+// SSE-optimized version of the function overlapMono
+void TDStretchSSE::overlapMono(float *pOutput, const float *pInput) const
+{
+    // window tables and 'pMidBuffer' are aligned to 16-byte boundary, the input
+    // and output positions need not be
+    const __m128 *pVFadeIn = (const __m128*)pOverlapWindow;
+    const __m128 *pVFadeOut = (const __m128*)(pOverlapWindow + overlapLength);
+    const __m128 *pVMid = (const __m128*)pMidBuffer;
+    int i;
+
+    // ensure overlapLength is divisible by 8
+    assert((overlapLength % 8) == 0);
+
+    for (i = 0; i < overlapLength / 4; i ++)
+    {
+        // out[0..3] = in[0..3] * fadeIn[0..3] + mid[0..3] * fadeOut[0..3]
+        __m128 vTemp = _mm_mul_ps(_mm_loadu_ps(pInput), pVFadeIn[i]);
+        vTemp = _mm_add_ps(vTemp, _mm_mul_ps(pVMid[i], pVFadeOut[i]));
+        _mm_storeu_ps(pOutput, vTemp);
+
+        pInput += 4;
+        pOutput += 4;
+    }
+}
+
+
+// SSE-optimized version of the function overlapStereo
+void TDStretchSSE::overlapStereo(float *pOutput, const float *pInput) const
+{
+    const __m128 *pVFadeIn = (const __m128*)pOverlapWindow;
+    const __m128 *pVFadeOut = (const __m128*)(pOverlapWindow + overlapLength);
+    const __m128 *pVMid = (const __m128*)pMidBuffer;
+    int i;
+
+    assert((overlapLength % 8) == 0);
+
+    for (i = 0; i < overlapLength / 4; i ++)
+    {
+        // duplicate the weights of four stereo samples for the left and right
+        // channels: w0 w0 w1 w1 and w2 w2 w3 w3
+        const __m128 vIn1 = _mm_unpacklo_ps(pVFadeIn[i], pVFadeIn[i]);
+        const __m128 vIn2 = _mm_unpackhi_ps(pVFadeIn[i], pVFadeIn[i]);
+        const __m128 vOut1 = _mm_unpacklo_ps(pVFadeOut[i], pVFadeOut[i]);
+        const __m128 vOut2 = _mm_unpackhi_ps(pVFadeOut[i], pVFadeOut[i]);
+        __m128 vTemp;
+
+        vTemp = _mm_mul_ps(_mm_loadu_ps(pInput), vIn1);
+        vTemp = _mm_add_ps(vTemp, _mm_mul_ps(pVMid[2 * i], vOut1));
+        _mm_storeu_ps(pOutput, vTemp);
+
+        vTemp = _mm_mul_ps(_mm_loadu_ps(pInput + 4), vIn2);
+        vTemp = _mm_add_ps(vTemp, _mm_mul_ps(pVMid[2 * i + 1], vOut2));
+        _mm_storeu_ps(pOutput + 4, vTemp);
+
+        pInput += 8;
+        pOutput += 8;
+    }
 }
 
 
@@ -196,38 +317,31 @@ double TDStretchSSE::calcCrossCorrAccumulate(const float *pV1, const float *pV2,
 FIRFilterSSE::FIRFilterSSE() : FIRFilter()
 {
     filterCoeffsAlign = nullptr;
-    filterCoeffsUnalign = nullptr;
 }
 
 
-FIRFilterSSE::~FIRFilterSSE()
+// (overloaded) Takes filter coefficients into use for SSE routine
+void FIRFilterSSE::useCoefficients(const FIRCoefficients *coeffs)
 {
-    delete[] filterCoeffsUnalign;
-    filterCoeffsAlign = nullptr;
-    filterCoeffsUnalign = nullptr;
+    FIRFilter::useCoefficients(coeffs);
+
+    // The stereo coefficient set already has the coefficients prescaled and
+    // arranged suitably for SSE, and aligned to 16-byte boundary, so use it as such
+    filterCoeffsAlign = coeffs->stereo;
+    assert(((ulongptr)filterCoeffsAlign) % 16 == 0);
 }
 
 
-// (overloaded) Calculates filter coefficients for SSE routine
-void FIRFilterSSE::setCoefficients(const float *coeffs, uint newLength, uint uResultDivFactor)
+// (overloaded) The SSE stereo routine outputs samples in pairs
+uint FIRFilterSSE::getInputLength(uint numOutput, uint numChannels) const
 {
-    FIRFilter::setCoefficients(coeffs, newLength, uResultDivFactor);
-
-    // Scale the filter coefficients so that it won't be necessary to scale the filtering result
-    // also rearrange coefficients suitably for SSE
-    // Ensure that filter coeffs array is aligned to 16-byte boundary
-    delete[] filterCoeffsUnalign;
-    filterCoeffsUnalign = new float[2 * newLength + 4];
-    filterCoeffsAlign = (float *)SOUNDTOUCH_ALIGN_POINTER_16(filterCoeffsUnalign);
-
-    const float scale = ::pow(0.5, (int)resultDivFactor);
-
-    // rearrange the filter coefficients for sse routines
-    for (auto i = 0U; i < newLength; i ++)
+#ifndef USE_MULTICH_ALWAYS
+    if (numChannels == 2)
     {
-        filterCoeffsAlign[2 * i + 0] =
-        filterCoeffsAlign[2 * i + 1] = coeffs[i] * scale;
+        numOutput = (numOutput + 1) & (uint)-2;
     }
+#endif // USE_MULTICH_ALWAYS
+    return FIRFilter::getInputLength(numOutput, numChannels);
 }
 
 
@@ -359,4 +473,345 @@ uint FIRFilterSSE::evaluateFilterStereo(float *dest, const float *source, uint n
     */
 }
 
+
+//////////////////////////////////////////////////////////////////////////////
+//
+// implementation of SSE optimized functions of classes 'InterpolateLinearSSE',
+// 'InterpolateCubicSSE' and 'InterpolateShannonSSE'
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#include "InterpolateLinear.h"
+#include "InterpolateCubic.h"
+#include "InterpolateShannon.h"
+
+/// Read positions of four successive output samples
+struct ST_POSITIONS4
+{
+    int pos[4];         // whole source sample positions
+    uint fract[4];      // fixed-point fractions at these positions
+    int nextPos;        // whole position & fraction for the fifth output
+    uint nextFract;
+};
+
+
+// Calculates read positions for the next four output samples by stepping
+// the fixed-point position 'srcCount + iFract' forward by 'iRate' at a time
+static inline void stepPositions4(ST_POSITIONS4 &p, int srcCount, uint iFract, uint iRate)
+{
+    for (int k = 0; k < 4; k ++)
+    {
+        p.pos[k] = srcCount;
+        p.fract[k] = iFract;
+        iFract += iRate;
+        srcCount += (int)(iFract >> TransposerBase::FRACT_BITS);
+        iFract &= TransposerBase::FRACT_MASK;
+    }
+    p.nextPos = srcCount;
+    p.nextFract = iFract;
+}
+
+
+// Sums the hi- and lo-halves of 'sum1' and 'sum2' together, each of which
+// contain partial sums of one stereo sample, and stores the two resulting
+// stereo samples to 'pDest'
+static inline void storeStereoPair(float *pDest, __m128 sum1, __m128 sum2)
+{
+    _mm_storeu_ps(pDest, _mm_add_ps(
+                _mm_shuffle_ps(sum1, sum2, _MM_SHUFFLE(1,0,3,2)),   // s2_1 s2_0 s1_3 s1_2
+                _mm_shuffle_ps(sum1, sum2, _MM_SHUFFLE(3,2,1,0))    // s2_3 s2_2 s1_1 s1_0
+                ));
+}
+
+
+InterpolateLinearSSE::InterpolateLinearSSE() : InterpolateLinearFloat()
+{
+    iFract = 0;
+    iRate = fixedRate(rate);
+}
+
+
+void InterpolateLinearSSE::resetRegisters()
+{
+    InterpolateLinearFloat::resetRegisters();
+    iFract = 0;
+}
+
+
+void InterpolateLinearSSE::setRate(double newRate)
+{
+    InterpolateLinearFloat::setRate(newRate);
+    iRate = fixedRate(newRate);
+}
+
+
+// read position is in FRACT_BITS fixed-point format, unlike in the base class
+int InterpolateLinearSSE::getSourcePosition(int n) const
+{
+    return TransposerBase::getSourcePosition(n);
+}
+
+
+// SSE-optimized linear interpolation for mono sound
+int InterpolateLinearSSE::transposeMono(float *pdest, const float *psrc, int &srcSamples)
+{
+    const float fScale = 1.0f / (float)(1 << FRACT_BITS);
+    const __m128 vScale = _mm_set1_ps(fScale);
+    int srcSampleEnd = srcSamples - 1;
+    int srcCount = 0;
+    int i = 0;
+    ST_POSITIONS4 p;
+
+    for (;;)
+    {
+        stepPositions4(p, srcCount, iFract, iRate);
+        if (p.pos[3] >= srcSampleEnd) break;
+
+        const __m128 s0 = _mm_setr_ps(psrc[p.pos[0]], psrc[p.pos[1]], psrc[p.pos[2]], psrc[p.pos[3]]);
+        const __m128 s1 = _mm_setr_ps(psrc[p.pos[0] + 1], psrc[p.pos[1] + 1], psrc[p.pos[2] + 1], psrc[p.pos[3] + 1]);
+        const __m128 f = _mm_mul_ps(_mm_setr_ps((float)p.fract[0], (float)p.fract[1],
+                                                (float)p.fract[2], (float)p.fract[3]), vScale);
+
+        // out = s0 + f * (s1 - s0)
+        _mm_storeu_ps(pdest + i, _mm_add_ps(s0, _mm_mul_ps(f, _mm_sub_ps(s1, s0))));
+
+        i += 4;
+        srcCount = p.nextPos;
+        iFract = p.nextFract;
+    }
+
+    // process the last few samples one at a time
+    while (srcCount < srcSampleEnd)
+    {
+        const float f = (float)iFract * fScale;
+        pdest[i] = psrc[srcCount] + f * (psrc[srcCount + 1] - psrc[srcCount]);
+        i ++;
+
+        iFract += iRate;
+        srcCount += (int)(iFract >> FRACT_BITS);
+        iFract &= FRACT_MASK;
+    }
+    srcSamples = srcCount;
+    return i;
+}
+
+
+// SSE-optimized linear interpolation for stereo sound
+int InterpolateLinearSSE::transposeStereo(float *pdest, const float *psrc, int &srcSamples)
+{
+    const float fScale = 1.0f / (float)(1 << FRACT_BITS);
+    int srcSampleEnd = srcSamples - 1;
+    int srcCount = 0;
+    int i = 0;
+    ST_POSITIONS4 p;
+
+    for (;;)
+    {
+        __m128 sum[4];
+
+        stepPositions4(p, srcCount, iFract, iRate);
+        if (p.pos[3] >= srcSampleEnd) break;
+
+        for (int k = 0; k < 4; k ++)
+        {
+            const float f = (float)p.fract[k] * fScale;
+            // l0 r0 l1 r1 * (1-f) (1-f) f f
+            sum[k] = _mm_mul_ps(_mm_loadu_ps(psrc + 2 * p.pos[k]), _mm_setr_ps(1.0f - f, 1.0f - f, f, f));
+        }
+        storeStereoPair(pdest + 2 * i, sum[0], sum[1]);
+        storeStereoPair(pdest + 2 * i + 4, sum[2], sum[3]);
+
+        i += 4;
+        srcCount = p.nextPos;
+        iFract = p.nextFract;
+    }
+
+    // process the last few samples one at a time
+    while (srcCount < srcSampleEnd)
+    {
+        const float f = (float)iFract * fScale;
+        const float *ps = psrc + 2 * srcCount;
+        pdest[2 * i]     = ps[0] + f * (ps[2] - ps[0]);
+        pdest[2 * i + 1] = ps[1] + f * (ps[3] - ps[1]);
+        i ++;
+
+        iFract += iRate;
+        srcCount += (int)(iFract >> FRACT_BITS);
+        iFract &= FRACT_MASK;
+    }
+    srcSamples = srcCount;
+    return i;
+}
+
+
+// SSE-optimized cubic interpolation for mono sound
+int InterpolateCubicSSE::transposeMono(float *pdest, const float *psrc, int &srcSamples)
+{
+    int srcSampleEnd = srcSamples - 4;
+    int srcCount = 0;
+    int i = 0;
+    ST_POSITIONS4 p;
+
+    assert(((ulongptr)coeffTable) % 16 == 0);
+
+    for (;;)
+    {
+        stepPositions4(p, srcCount, iFract, iRate);
+        if (p.pos[3] >= srcSampleEnd) break;
+
+        // each register gets the four weighted taps of one output sample. Notice that
+        // table rows are aligned to 16-byte boundary, source data not necessarily.
+        __m128 v0 = _mm_mul_ps(_mm_loadu_ps(psrc + p.pos[0]), _mm_load_ps(coeffTable + 4 * phaseIndex(p.fract[0])));
+        __m128 v1 = _mm_mul_ps(_mm_loadu_ps(psrc + p.pos[1]), _mm_load_ps(coeffTable + 4 * phaseIndex(p.fract[1])));
+        __m128 v2 = _mm_mul_ps(_mm_loadu_ps(psrc + p.pos[2]), _mm_load_ps(coeffTable + 4 * phaseIndex(p.fract[2])));
+        __m128 v3 = _mm_mul_ps(_mm_loadu_ps(psrc + p.pos[3]), _mm_load_ps(coeffTable + 4 * phaseIndex(p.fract[3])));
+
+        // transpose so that the taps of the four outputs can be summed up vertically
+        _MM_TRANSPOSE4_PS(v0, v1, v2, v3);
+        _mm_storeu_ps(pdest + i, _mm_add_ps(_mm_add_ps(v0, v1), _mm_add_ps(v2, v3)));
+
+        i += 4;
+        srcCount = p.nextPos;
+        iFract = p.nextFract;
+    }
+
+    // process the last few samples with the plain C routine
+    int remaining = srcSamples - srcCount;
+    i += InterpolateCubic::transposeMono(pdest + i, psrc + srcCount, remaining);
+    srcSamples = srcCount + remaining;
+    return i;
+}
+
+
+// SSE-optimized cubic interpolation for stereo sound
+int InterpolateCubicSSE::transposeStereo(float *pdest, const float *psrc, int &srcSamples)
+{
+    int srcSampleEnd = srcSamples - 4;
+    int srcCount = 0;
+    int i = 0;
+    ST_POSITIONS4 p;
+
+    assert(((ulongptr)coeffTable) % 16 == 0);
+
+    for (;;)
+    {
+        __m128 sum[4];
+
+        stepPositions4(p, srcCount, iFract, iRate);
+        if (p.pos[3] >= srcSampleEnd) break;
+
+        for (int k = 0; k < 4; k ++)
+        {
+            const float *ps = psrc + 2 * p.pos[k];
+            const __m128 c = _mm_load_ps(coeffTable + 4 * phaseIndex(p.fract[k]));
+
+            // c0 c0 c1 c1 * l0 r0 l1 r1 + c2 c2 c3 c3 * l2 r2 l3 r3
+            sum[k] = _mm_add_ps(_mm_mul_ps(_mm_unpacklo_ps(c, c), _mm_loadu_ps(ps)),
+                                _mm_mul_ps(_mm_unpackhi_ps(c, c), _mm_loadu_ps(ps + 4)));
+        }
+        storeStereoPair(pdest + 2 * i, sum[0], sum[1]);
+        storeStereoPair(pdest + 2 * i + 4, sum[2], sum[3]);
+
+        i += 4;
+        srcCount = p.nextPos;
+        iFract = p.nextFract;
+    }
+
+    // process the last few samples with the plain C routine
+    int remaining = srcSamples - srcCount;
+    i += InterpolateCubic::transposeStereo(pdest + 2 * i, psrc + 2 * srcCount, remaining);
+    srcSamples = srcCount + remaining;
+    return i;
+}
+
+
+// SSE-optimized Shannon interpolation for mono sound
+int InterpolateShannonSSE::transposeMono(float *pdest, const float *psrc, int &srcSamples)
+{
+    int srcSampleEnd = srcSamples - 8;
+    int srcCount = 0;
+    int i = 0;
+    ST_POSITIONS4 p;
+
+    assert(((ulongptr)coeffTable) % 16 == 0);
+
+    for (;;)
+    {
+        __m128 v[4];
+
+        stepPositions4(p, srcCount, iFract, iRate);
+        if (p.pos[3] >= srcSampleEnd) break;
+
+        for (int k = 0; k < 4; k ++)
+        {
+            const float *ps = psrc + p.pos[k];
+            const float *pw = coeffTable + 8 * phaseIndex(p.fract[k]);
+
+            v[k] = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(ps), _mm_load_ps(pw)),
+                              _mm_mul_ps(_mm_loadu_ps(ps + 4), _mm_load_ps(pw + 4)));
+        }
+
+        // transpose so that the taps of the four outputs can be summed up vertically
+        _MM_TRANSPOSE4_PS(v[0], v[1], v[2], v[3]);
+        _mm_storeu_ps(pdest + i, _mm_add_ps(_mm_add_ps(v[0], v[1]), _mm_add_ps(v[2], v[3])));
+
+        i += 4;
+        srcCount = p.nextPos;
+        iFract = p.nextFract;
+    }
+
+    // process the last few samples with the plain C routine
+    int remaining = srcSamples - srcCount;
+    i += InterpolateShannon::transposeMono(pdest + i, psrc + srcCount, remaining);
+    srcSamples = srcCount + remaining;
+    return i;
+}
+
+
+// SSE-optimized Shannon interpolation for stereo sound
+int InterpolateShannonSSE::transposeStereo(float *pdest, const float *psrc, int &srcSamples)
+{
+    int srcSampleEnd = srcSamples - 8;
+    int srcCount = 0;
+    int i = 0;
+    ST_POSITIONS4 p;
+
+    assert(((ulongptr)coeffTable) % 16 == 0);
+
+    for (;;)
+    {
+        __m128 sum[4];
+
+        stepPositions4(p, srcCount, iFract, iRate);
+        if (p.pos[3] >= srcSampleEnd) break;
+
+        for (int k = 0; k < 4; k ++)
+        {
+            const float *ps = psrc + 2 * p.pos[k];
+            const float *pw = coeffTable + 8 * phaseIndex(p.fract[k]);
+            const __m128 w0 = _mm_load_ps(pw);
+            const __m128 w1 = _mm_load_ps(pw + 4);
+
+            // duplicate each tap for left & right channel, w0 w0 w1 w1 * l0 r0 l1 r1 etc.
+            sum[k] = _mm_add_ps(
+                        _mm_add_ps(_mm_mul_ps(_mm_unpacklo_ps(w0, w0), _mm_loadu_ps(ps)),
+                                   _mm_mul_ps(_mm_unpackhi_ps(w0, w0), _mm_loadu_ps(ps + 4))),
+                        _mm_add_ps(_mm_mul_ps(_mm_unpacklo_ps(w1, w1), _mm_loadu_ps(ps + 8)),
+                                   _mm_mul_ps(_mm_unpackhi_ps(w1, w1), _mm_loadu_ps(ps + 12))));
+        }
+        storeStereoPair(pdest + 2 * i, sum[0], sum[1]);
+        storeStereoPair(pdest + 2 * i + 4, sum[2], sum[3]);
+
+        i += 4;
+        srcCount = p.nextPos;
+        iFract = p.nextFract;
+    }
+
+    // process the last few samples with the plain C routine
+    int remaining = srcSamples - srcCount;
+    i += InterpolateShannon::transposeStereo(pdest + 2 * i, psrc + 2 * srcCount, remaining);
+    srcSamples = srcCount + remaining;
+    return i;
+}
+
 #endif  // SOUNDTOUCH_ALLOW_SSE
@@ -0,0 +1,119 @@
+#include "GainRamp.h"
+#include <cmath>
+
+void GainRamp::prepare(int lengthInSamples, Shape newShape)
+{
+    length = juce::jmax(1, lengthInSamples);
+    position = 0;
+    direction = 0;
+
+    rising.resize(static_cast<size_t>(length) + 1);
+    falling.resize(static_cast<size_t>(length) + 1);
+
+    for (int p = 0; p <= length; ++p)
+    {
+        const double t = static_cast<double>(p) / length;
+        const double gain = newShape == Shape::linear ? t : std::sin(t * juce::MathConstants<double>::halfPi);
+
+        rising[static_cast<size_t>(p)] = static_cast<float>(gain);
+        falling[static_cast<size_t>(length - p)] = static_cast<float>(gain);
+    }
+}
+
+void GainRamp::setGain(bool on)
+{
+    position = on ? length : 0;
+    direction = 0;
+}
+
+void GainRamp::rampUp()
+{
+    direction = position < length ? 1 : 0;
+}
+
+void GainRamp::rampDown()
+{
+    direction = position > 0 ? -1 : 0;
+}
+
+int GainRamp::advance(int numSamples, const float*& gains, const float*& complement)
+{
+    if (direction == 0)
+        return 0;
+
+    const int remaining = direction > 0 ? length - position : position;
+    const int count = juce::jmin(numSamples, remaining);
+
+    // Las ganancias de las muestras del tramo empiezan en la posición siguiente
+    const size_t offset = static_cast<size_t>(direction > 0 ? position : length - position) + 1;
+    gains = (direction > 0 ? rising.data() : falling.data()) + offset;
+    complement = (direction > 0 ? falling.data() : rising.data()) + offset;
+
+    position += direction * count;
+    if (count == remaining)
+        direction = 0;
+
+    return count;
+}
+
+void GainRamp::process(float* const* channels, int numChannels, int numSamples)
+{
+    if (rising.empty())
+        return;
+
+    const float* gains = nullptr;
+    const float* complement = nullptr;
+    const int ramped = advance(numSamples, gains, complement);
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        float* data = channels[ch];
+
+        if (ramped > 0)
+            juce::FloatVectorOperations::multiply(data, gains, ramped);
+
+        // Si la rampa termina a mitad de bloque, el resto va con la ganancia final
+        const int rest = numSamples - ramped;
+        const float gain = getGain();
+
+        if (rest > 0 && gain == 0.0f)
+            juce::FloatVectorOperations::clear(data + ramped, rest);
+        else if (rest > 0 && gain != 1.0f)
+            juce::FloatVectorOperations::multiply(data + ramped, gain, rest);
+    }
+}
+
+void GainRamp::processCrossfade(float* const* dest, const float* const* other, int numChannels, int numSamples)
+{
+    if (rising.empty())
+        return;
+
+    const float* gains = nullptr;
+    const float* complement = nullptr;
+    const int ramped = advance(numSamples, gains, complement);
+
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        float* data = dest[ch];
+        const float* src = other[ch];
+
+        if (ramped > 0)
+        {
+            juce::FloatVectorOperations::multiply(data, gains, ramped);
+            juce::FloatVectorOperations::addWithMultiply(data, src, complement, ramped);
+        }
+
+        const int rest = numSamples - ramped;
+        const float gain = getGain();
+
+        if (rest > 0 && gain == 0.0f)
+        {
+            juce::FloatVectorOperations::copy(data + ramped, src + ramped, rest);
+        }
+        else if (rest > 0 && gain != 1.0f)
+        {
+            juce::FloatVectorOperations::multiply(data + ramped, gain, rest);
+            juce::FloatVectorOperations::addWithMultiply(data + ramped, src + ramped, falling[static_cast<size_t>(position)], rest);
+        }
+    }
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include <vector>
+
+// Rampa de ganancia entre 0 y 1 para fade-in, fade-out y crossfades. Las
+// ganancias se precalculan en prepare() y se aplican in situ con
+// FloatVectorOperations; parada no cuesta nada. Una rampa puede ocupar varios
+// bloques y cambiar de sentido a mitad sin saltos
+class GainRamp
+{
+public:
+    enum class Shape
+    {
+        linear,     // Fades de una sola señal
+        equalPower  // Crossfades entre señales no correladas: sin² + cos² = 1
+    };
+
+    // Fuera del hilo de audio: reserva y precalcula la rampa. Queda parada en
+    // ganancia 0
+    void prepare(int lengthInSamples, Shape newShape);
+
+    // Salta a ganancia 1 o 0 sin rampa
+    void setGain(bool on);
+
+    // Empieza a subir o bajar desde la ganancia actual
+    void rampUp();
+    void rampDown();
+
+    bool isRamping() const { return direction != 0; }
+    bool isSilent() const { return direction == 0 && position == 0; }
+    float getGain() const { return rising.empty() ? 0.0f : rising[static_cast<size_t>(position)]; }
+
+    size_t getMemoryBytes() const { return sizeof(float) * (rising.capacity() + falling.capacity()); }
+
+    // Multiplica las muestras por la ganancia, avanzando la rampa numSamples muestras
+    void process(float* const* channels, int numChannels, int numSamples);
+
+    // dest = dest * g + other * g', donde g' es la ganancia complementaria
+    // (1 - g en lineal, cos en vez de sin en potencia constante). Con g = 1 queda
+    // dest, con g = 0 queda other
+    void processCrossfade(float* const* dest, const float* const* other, int numChannels, int numSamples);
+
+private:
+    // rising[p] es la ganancia en la posición p (0..length) y falling[p] la de
+    // length - p, que también es la complementaria de rising[p]. Así los tramos
+    // de subida y de bajada son contiguos en memoria
+    std::vector<float> rising;
+    std::vector<float> falling;
+
+    int length = 0;
+    int position = 0;
+    int direction = 0;
+
+    // Tramo de rampa del bloque: ganancias, complementarias y número de muestras
+    int advance(int numSamples, const float*& gains, const float*& complement);
+};
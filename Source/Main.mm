@@ -5,6 +5,7 @@
 #import <AVFoundation/AVFoundation.h>
 #include "DAFAudioProcessor.h"
 #include "DAFAudioProcessorEditor.h"
+#include "ProcessorBenchmark.h"
 
 class iOSStandaloneApp : public juce::JUCEApplication
 {
@@ -37,6 +38,10 @@ public:
             juce::Logger::writeToLog(granted ? "Permiso de microfono CONCEDIDO" : "Permiso de microfono DENEGADO");
         }];
 
+        // Con DAF_BENCHMARK definida (esquema de Xcode) se mide el procesador
+        // antes de arrancar el audio
+        ProcessorBenchmark::runIfRequested();
+
         processor = std::make_unique<DAFAudioProcessor>();
         DBG("DBG2: DAFAudioProcessor instanciado");
 
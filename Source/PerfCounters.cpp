@@ -0,0 +1,161 @@
+#include "PerfCounters.h"
+#include <algorithm>
+#include <cstdio>
+
+int PerfHistogram::getBucket(uint32_t ns)
+{
+    if (ns < subBuckets)
+        return static_cast<int>(ns);
+
+    int octave = subBucketBits;
+    while ((ns >> octave) > 1)
+        ++octave;
+
+    // Los subBucketBits bits siguientes al más alto eligen la subdivisión
+    const int sub = static_cast<int>(ns >> (octave - subBucketBits)) & (subBuckets - 1);
+    return (octave - subBucketBits + 1) * subBuckets + sub;
+}
+
+double PerfHistogram::getBucketMidpoint(int bucket)
+{
+    if (bucket < subBuckets)
+        return bucket;
+
+    const int octave = bucket / subBuckets + subBucketBits - 1;
+    const int sub = bucket % subBuckets;
+    const double width = static_cast<double>(1u << (octave - subBucketBits));
+
+    return (subBuckets + sub + 0.5) * width;
+}
+
+void PerfHistogram::record(uint32_t ns)
+{
+    // Un solo escritor: load + store en vez de fetch_add, sin operaciones atómicas
+    // de lectura-modificación-escritura en el hilo de audio
+    auto& bucket = counts[static_cast<size_t>(getBucket(ns))];
+    bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+    if (ns > maxNs.load(std::memory_order_relaxed))
+        maxNs.store(ns, std::memory_order_relaxed);
+}
+
+void PerfHistogram::clear()
+{
+    for (auto& bucket : counts)
+        bucket.store(0, std::memory_order_relaxed);
+
+    count.store(0, std::memory_order_relaxed);
+    maxNs.store(0, std::memory_order_relaxed);
+}
+
+PerfHistogram::Stats PerfHistogram::getStats() const
+{
+    std::array<uint32_t, numBuckets> snapshot;
+    uint64_t total = 0;
+
+    for (size_t i = 0; i < snapshot.size(); ++i)
+    {
+        snapshot[i] = counts[i].load(std::memory_order_relaxed);
+        total += snapshot[i];
+    }
+
+    Stats stats;
+    stats.count = total;
+    stats.maxNs = maxNs.load(std::memory_order_relaxed);
+
+    if (total == 0)
+        return stats;
+
+    // Percentiles por el primer bucket que alcanza la fracción pedida
+    const uint64_t p50Rank = (total * 50 + 99) / 100;
+    const uint64_t p99Rank = (total * 99 + 99) / 100;
+    uint64_t seen = 0;
+
+    for (int i = 0; i < numBuckets; ++i)
+    {
+        const uint64_t before = seen;
+        seen += snapshot[static_cast<size_t>(i)];
+
+        if (before < p50Rank && seen >= p50Rank)
+            stats.p50Ns = getBucketMidpoint(i);
+
+        if (before < p99Rank && seen >= p99Rank)
+        {
+            stats.p99Ns = getBucketMidpoint(i);
+            break;
+        }
+    }
+
+    // El punto medio del último bucket puede pasarse del máximo real
+    stats.p50Ns = std::min(stats.p50Ns, stats.maxNs);
+    stats.p99Ns = std::min(stats.p99Ns, stats.maxNs);
+
+    return stats;
+}
+
+const char* PerfCounters::getStageName(Stage stage)
+{
+    switch (stage)
+    {
+        case fade:      return "fade";
+        case delay:     return "delay";
+        case pitch:     return "pitch";
+        case total:     return "total";
+        case numStages: break;
+    }
+
+    return "";
+}
+
+void PerfCounters::beginBlock(int numSamples, double sampleRate)
+{
+    if (resetRequested.exchange(false, std::memory_order_relaxed))
+        for (auto& histogram : histograms)
+            histogram.clear();
+
+    if (sampleRate > 0.0)
+        deadlineNs.store(static_cast<uint32_t>(numSamples * 1.0e9 / sampleRate), std::memory_order_relaxed);
+}
+
+PerfCounters::StageStats PerfCounters::getStats(Stage stage) const
+{
+    const auto stats = histograms[stage].getStats();
+    const double deadline = static_cast<double>(deadlineNs.load(std::memory_order_relaxed));
+    const double toPercent = deadline > 0.0 ? 100.0 / deadline : 0.0;
+
+    StageStats result;
+    result.count = stats.count;
+    result.p50Us = stats.p50Ns / 1000.0;
+    result.p99Us = stats.p99Ns / 1000.0;
+    result.maxUs = stats.maxNs / 1000.0;
+    result.p50Percent = stats.p50Ns * toPercent;
+    result.p99Percent = stats.p99Ns * toPercent;
+    result.maxPercent = stats.maxNs * toPercent;
+
+    return result;
+}
+
+std::string PerfCounters::formatReport() const
+{
+    std::string report;
+    char line[160];
+
+    std::snprintf(line, sizeof(line), "plazo %.0f us\n", getDeadlineUs());
+    report += line;
+
+    for (int i = 0; i < numStages; ++i)
+    {
+        const auto stage = static_cast<Stage>(i);
+        const auto stats = getStats(stage);
+
+        std::snprintf(line, sizeof(line), "%-5s p50 %6.1f us (%4.1f%%)  p99 %6.1f us (%4.1f%%)  max %6.1f us (%5.1f%%)\n",
+                      getStageName(stage),
+                      stats.p50Us, stats.p50Percent,
+                      stats.p99Us, stats.p99Percent,
+                      stats.maxUs, stats.maxPercent);
+        report += line;
+    }
+
+    return report;
+}
@@ -0,0 +1,132 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+// Contadores de tiempo por etapa de processBlock. Con DAF_PERF_COUNTERS=0 se
+// compilan fuera del todo; compilados pero desactivados cuestan una lectura
+// atómica por etapa
+#ifndef DAF_PERF_COUNTERS
+ #define DAF_PERF_COUNTERS 1
+#endif
+
+// Histograma log-lineal de duraciones en nanosegundos: 8 subdivisiones por
+// octava (error de ~6%) hasta ~4 s. Lo escribe un solo hilo (el de audio) y se
+// puede leer desde cualquier otro sin bloqueos
+class PerfHistogram
+{
+public:
+    static constexpr int subBucketBits = 3;
+    static constexpr int subBuckets = 1 << subBucketBits;
+    static constexpr int maxOctave = 31;
+    static constexpr int numBuckets = (maxOctave - subBucketBits + 2) * subBuckets;
+
+    struct Stats
+    {
+        uint64_t count = 0;
+        double p50Ns = 0.0;
+        double p99Ns = 0.0;
+        double maxNs = 0.0;
+    };
+
+    // Solo desde el hilo que escribe
+    void record(uint32_t ns);
+    void clear();
+
+    Stats getStats() const;
+
+    static int getBucket(uint32_t ns);
+    static double getBucketMidpoint(int bucket);
+
+private:
+    std::array<std::atomic<uint32_t>, numBuckets> counts {};
+    std::atomic<uint64_t> count { 0 };
+    std::atomic<uint32_t> maxNs { 0 };
+};
+
+class PerfCounters
+{
+public:
+    enum Stage
+    {
+        fade = 0,
+        delay,
+        pitch,
+        total,
+        numStages
+    };
+
+    static const char* getStageName(Stage stage);
+
+    // Desde cualquier hilo
+    void setEnabled(bool shouldBeEnabled) { enabled.store(shouldBeEnabled, std::memory_order_relaxed); }
+    bool isEnabled() const { return DAF_PERF_COUNTERS && enabled.load(std::memory_order_relaxed); }
+    void requestReset() { resetRequested.store(true, std::memory_order_relaxed); }
+
+    // Desde el hilo de audio, al principio de cada bloque: el plazo del bloque
+    // es su duración
+    void beginBlock(int numSamples, double sampleRate);
+    void record(Stage stage, uint32_t ns) { histograms[stage].record(ns); }
+
+    struct StageStats
+    {
+        uint64_t count = 0;
+        double p50Us = 0.0;
+        double p99Us = 0.0;
+        double maxUs = 0.0;
+
+        // Porcentaje del plazo del bloque
+        double p50Percent = 0.0;
+        double p99Percent = 0.0;
+        double maxPercent = 0.0;
+    };
+
+    StageStats getStats(Stage stage) const;
+    double getDeadlineUs() const { return deadlineNs.load(std::memory_order_relaxed) / 1000.0; }
+
+    // Una línea por etapa: p50/p99/max en microsegundos y en % del plazo
+    std::string formatReport() const;
+
+    // Mide el tiempo de vida del objeto como una etapa, si los contadores
+    // estaban activos al crearlo
+    class ScopedStage
+    {
+    public:
+       #if DAF_PERF_COUNTERS
+        ScopedStage(PerfCounters& countersToUse, Stage stageToMeasure) noexcept
+            : counters(countersToUse.isEnabled() ? &countersToUse : nullptr), stage(stageToMeasure)
+        {
+            if (counters != nullptr)
+                start = std::chrono::steady_clock::now();
+        }
+
+        ~ScopedStage()
+        {
+            if (counters != nullptr)
+            {
+                const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+                counters->record(stage, static_cast<uint32_t>(elapsed < UINT32_MAX ? elapsed : UINT32_MAX));
+            }
+        }
+
+    private:
+        PerfCounters* counters;
+        Stage stage;
+        std::chrono::steady_clock::time_point start;
+       #else
+        ScopedStage(PerfCounters&, Stage) noexcept {}
+       #endif
+
+        ScopedStage(const ScopedStage&) = delete;
+        ScopedStage& operator=(const ScopedStage&) = delete;
+    };
+
+private:
+    std::array<PerfHistogram, numStages> histograms;
+    std::atomic<bool> enabled { false };
+    std::atomic<bool> resetRequested { false };
+    std::atomic<uint32_t> deadlineNs { 0 };
+};
@@ -0,0 +1,149 @@
+#include "ProcessorBenchmark.h"
+#include "ProcessorHarness.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+namespace
+{
+    struct BenchConfig
+    {
+        double sampleRate;
+        int channels;
+        int blockSize;
+        float pitch;
+    };
+
+    // Mismo formato de registro que soundtouch_bench
+    juce::String formatRecord(const juce::String& name, const char* variant, const BenchConfig& config,
+                              juce::uint64 iterations, double nsPerCall)
+    {
+        char line[512];
+        std::snprintf(line, sizeof(line),
+                      "    {\"name\":\"%s\",\"variant\":\"%s\",\"sampleRate\":%d,\"channels\":%d,"
+                      "\"blockSize\":%d,\"pitch\":%.2f,\"rate\":%.6f,\"iterations\":%llu,"
+                      "\"nsPerCall\":%.1f,\"framesPerCall\":%d,\"nsPerFrame\":%.3f}",
+                      name.toRawUTF8(), variant, static_cast<int>(config.sampleRate), config.channels,
+                      config.blockSize, config.pitch, std::pow(2.0, config.pitch / 12.0),
+                      static_cast<unsigned long long>(iterations),
+                      nsPerCall, config.blockSize, nsPerCall / config.blockSize);
+        return line;
+    }
+
+    void runConfig(const BenchConfig& config, const ProcessorBenchmark::Options& options, juce::StringArray& records)
+    {
+        // Como un render offline: calidad máxima fija, el gobernador no cambia de
+        // nivel a mitad de la medida
+        ProcessorHarness::Settings settings;
+        settings.sampleRate = config.sampleRate;
+        settings.blockSize = config.blockSize;
+        settings.channels = config.channels;
+        settings.delayMs = options.delayMs;
+        settings.pitch = config.pitch;
+
+        ProcessorHarness harness(settings);
+        auto& processor = harness.getProcessor();
+
+        // Un segundo de señal que se recorre en bucle
+        const int signalLength = jmax(config.blockSize, static_cast<int>(config.sampleRate) / config.blockSize * config.blockSize);
+        juce::AudioBuffer<float> signal(config.channels, signalLength);
+        ProcessorHarness::fillFixture(signal, ProcessorHarness::Fixture::speech, config.sampleRate);
+
+        juce::AudioBuffer<float> buffer(config.channels, config.blockSize);
+        juce::MidiBuffer midi;
+        int position = 0;
+
+        auto nextBlock = [&]
+        {
+            for (int ch = 0; ch < config.channels; ++ch)
+                buffer.copyFrom(ch, 0, signal, ch, position, config.blockSize);
+
+            position = (position + config.blockSize) % signalLength;
+        };
+
+        // Calentamiento de medio segundo: incluye el fade-in y llena las cachés
+        const int warmupBlocks = jmax(1, static_cast<int>(0.5 * config.sampleRate / config.blockSize));
+        for (int i = 0; i < warmupBlocks; ++i)
+        {
+            nextBlock();
+            processor.processBlock(buffer, midi);
+        }
+
+        auto& counters = processor.getPerfCounters();
+        counters.setEnabled(true);
+        counters.requestReset();
+
+        const int numBlocks = jmax(1, static_cast<int>(options.secondsPerRun * config.sampleRate / config.blockSize));
+        std::vector<double> times(static_cast<size_t>(numBlocks));
+
+        for (auto& time : times)
+        {
+            nextBlock();
+            const auto start = std::chrono::steady_clock::now();
+            processor.processBlock(buffer, midi);
+            time = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+        }
+
+        counters.setEnabled(false);
+
+        const char* variant = config.pitch == 0.0f ? "delay" : "delayPitch";
+        std::nth_element(times.begin(), times.begin() + numBlocks / 2, times.end());
+        records.add(formatRecord("processor.processBlock", variant, config, static_cast<juce::uint64>(numBlocks), times[static_cast<size_t>(numBlocks / 2)]));
+
+        // Las etapas salen de los contadores del procesador: mediana del histograma,
+        // con el error de sus buckets (~6%)
+        for (auto stage : { PerfCounters::fade, PerfCounters::delay, PerfCounters::pitch })
+        {
+            const auto stats = counters.getStats(stage);
+            if (stats.count > 0)
+                records.add(formatRecord(juce::String("processor.") + PerfCounters::getStageName(stage), variant, config,
+                                         stats.count, stats.p50Us * 1000.0));
+        }
+    }
+}
+
+juce::String ProcessorBenchmark::run(const Options& options)
+{
+    juce::StringArray records;
+
+    for (auto sampleRate : options.sampleRates)
+        for (auto channels : options.channels)
+            for (auto blockSize : options.blockSizes)
+                for (auto pitch : options.pitches)
+                {
+                    const BenchConfig config { sampleRate, jlimit(1, 2, channels), blockSize, pitch };
+                    runConfig(config, options, records);
+                    DBG("[DAF] Benchmark " << sampleRate << " Hz, " << channels << " canales, bloque " << blockSize << ", pitch " << pitch);
+                }
+
+    juce::String json;
+    json << "{\n"
+         << "  \"benchmark\":\"daf_processor\",\n"
+         << "  \"version\":\"" << ProjectInfo::versionString << "\",\n"
+         << "  \"sampleType\":\"float\",\n"
+         << "  \"device\":\"" << juce::SystemStats::getDeviceDescription() << "\",\n"
+         << "  \"cpu\":\"" << juce::SystemStats::getCpuModel() << "\",\n"
+         << "  \"results\":[\n"
+         << records.joinIntoString(",\n") << "\n"
+         << "  ]\n}\n";
+
+    return json;
+}
+
+bool ProcessorBenchmark::runIfRequested()
+{
+    if (juce::SystemStats::getEnvironmentVariable("DAF_BENCHMARK", {}).isEmpty())
+        return false;
+
+    const auto json = run(Options());
+    const auto file = juce::File::getSpecialLocation(juce::File::userDocumentsDirectory).getChildFile("daf_benchmark.json");
+
+    if (file.replaceWithText(json))
+        juce::Logger::writeToLog("Benchmark guardado en " + file.getFullPathName());
+    else
+        juce::Logger::writeToLog("Error guardando el benchmark en " + file.getFullPathName());
+
+    return true;
+}
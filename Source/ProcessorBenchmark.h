@@ -0,0 +1,28 @@
+#pragma once
+
+#include <JuceHeader.h>
+
+// Benchmark de DAFAudioProcessor::processBlock: el bloque completo y cada etapa
+// (fade, delay, pitch) sobre una rejilla de frecuencias de muestreo, tamaños de
+// bloque, canales y pitch. Usa una instancia propia del procesador, sin
+// dispositivo de audio. El JSON tiene el mismo esquema que soundtouch_bench para
+// comparar los resultados entre versiones y dispositivos con los mismos scripts
+class ProcessorBenchmark
+{
+public:
+    struct Options
+    {
+        juce::Array<double> sampleRates { 44100.0, 48000.0 };
+        juce::Array<int> blockSizes { 128, 256, 512 };
+        juce::Array<int> channels { 1, 2 };
+        juce::Array<float> pitches { 0.0f, -3.0f, 3.0f }; // 0 = solo delay
+        float delayMs = 100.0f;
+        double secondsPerRun = 2.0;                        // Audio procesado por medida
+    };
+
+    static juce::String run(const Options& options);
+
+    // Si la variable de entorno DAF_BENCHMARK está definida, ejecuta el benchmark
+    // y escribe daf_benchmark.json en la carpeta de documentos
+    static bool runIfRequested();
+};
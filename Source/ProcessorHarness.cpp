@@ -0,0 +1,93 @@
+#include "ProcessorHarness.h"
+#include <chrono>
+#include <cmath>
+
+void ProcessorHarness::fillFixture(juce::AudioBuffer<float>& signal, Fixture fixture, double sampleRate)
+{
+    uint32_t seed = 12345;
+    double phase = 0.0;
+
+    for (int i = 0; i < signal.getNumSamples(); ++i)
+    {
+        if (fixture == Fixture::sine)
+        {
+            const auto value = static_cast<float>(0.5 * std::sin(juce::MathConstants<double>::twoPi * 220.0 * i / sampleRate));
+
+            for (int ch = 0; ch < signal.getNumChannels(); ++ch)
+                signal.setSample(ch, i, value);
+
+            continue;
+        }
+
+        const double f0 = 120.0 + 40.0 * std::sin(juce::MathConstants<double>::twoPi * 3.0 * i / sampleRate);
+        phase += juce::MathConstants<double>::twoPi * f0 / sampleRate;
+        const double value = 0.4 * std::sin(phase) + 0.2 * std::sin(2.0 * phase) + 0.1 * std::sin(3.0 * phase);
+
+        // Ruido distinto en cada canal: el procesador no lo puede tratar como mono
+        for (int ch = 0; ch < signal.getNumChannels(); ++ch)
+        {
+            seed = seed * 1664525u + 1013904223u;
+            const double noise = 0.02 * (static_cast<double>(seed >> 8) / static_cast<double>(1 << 24) - 0.5);
+            signal.setSample(ch, i, static_cast<float>(value + noise));
+        }
+    }
+}
+
+ProcessorHarness::ProcessorHarness(const Settings& newSettings)
+    : settings(newSettings)
+{
+    // Se restaura en el destructor, antes de que el del procesador lo guarde
+    processor.getStateInformation(savedState);
+
+    processor.setPlayConfigDetails(settings.channels, settings.channels, settings.sampleRate, settings.blockSize);
+    processor.setNonRealtime(true);
+
+    if (auto* gain = processor.apvts.getParameter("inputGain"))
+        gain->setValueNotifyingHost(gain->getNormalisableRange().convertTo0to1(settings.inputGainDb));
+
+    // Con los ajustes ya puestos, prepareToPlay crea los motores de pitch aquí
+    // mismo y el pitch arranca activo, sin esperar al hilo de mensajes
+    processor.setSpeechProfileEnabled(settings.speechProfile);
+    processor.setDelayTimeMs(settings.delayMs);
+    processor.setPitchShiftSemitones(settings.pitch);
+    processor.prepareToPlay(settings.sampleRate, settings.blockSize);
+    processor.setProcessingEnabled(true);
+}
+
+ProcessorHarness::~ProcessorHarness()
+{
+    processor.setProcessingEnabled(false);
+    processor.setStateInformation(savedState.getData(), static_cast<int>(savedState.getSize()));
+}
+
+juce::AudioBuffer<float> ProcessorHarness::render(const juce::AudioBuffer<float>& input, double* processSeconds)
+{
+    const int numChannels = input.getNumChannels();
+    const int totalSamples = input.getNumSamples();
+
+    juce::AudioBuffer<float> output(numChannels, totalSamples);
+    juce::AudioBuffer<float> block(numChannels, settings.blockSize);
+    juce::MidiBuffer midi;
+    std::chrono::steady_clock::duration elapsed {};
+
+    for (int position = 0; position < totalSamples; position += settings.blockSize)
+    {
+        const int numSamples = juce::jmin(settings.blockSize, totalSamples - position);
+        block.setSize(numChannels, numSamples, false, false, true);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+            block.copyFrom(ch, 0, input, ch, position, numSamples);
+
+        const auto start = std::chrono::steady_clock::now();
+        processor.processBlock(block, midi);
+        elapsed += std::chrono::steady_clock::now() - start;
+
+        for (int ch = 0; ch < numChannels; ++ch)
+            output.copyFrom(ch, position, block, ch, 0, numSamples);
+    }
+
+    if (processSeconds != nullptr)
+        *processSeconds += std::chrono::duration<double>(elapsed).count();
+
+    return output;
+}
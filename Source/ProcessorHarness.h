@@ -0,0 +1,51 @@
+#pragma once
+
+#include <JuceHeader.h>
+#include "DAFAudioProcessor.h"
+
+// DAFAudioProcessor fuera de un dispositivo de audio, para ProcessorBenchmark y
+// las pruebas de Tests/: señales de prueba fijas y una instancia preparada como un
+// render offline. Los ajustes del usuario (que el destructor del procesador guarda)
+// quedan como estaban
+class ProcessorHarness
+{
+public:
+    enum class Fixture
+    {
+        speech,     // Tono armónico con f0 variable y algo de ruido distinto en cada canal
+        sine        // Seno de 220 Hz a media escala, igual en todos los canales
+    };
+
+    // Las mismas muestras que generateSignal y generateSine de soundtouch_bench,
+    // que no puede usar JUCE: así las dos pruebas parten de la misma señal
+    static void fillFixture(juce::AudioBuffer<float>& signal, Fixture fixture, double sampleRate);
+
+    struct Settings
+    {
+        double sampleRate = 48000.0;
+        int blockSize = 256;
+        int channels = 1;
+        float delayMs = 100.0f;
+        float pitch = 0.0f;
+        float inputGainDb = 0.0f;
+        bool speechProfile = true;
+    };
+
+    // Calidad máxima fija (sin gobernador) y el procesador ya en marcha, con el
+    // fade-in de arranque por delante
+    explicit ProcessorHarness(const Settings& settings);
+    ~ProcessorHarness();
+
+    DAFAudioProcessor& getProcessor() { return processor; }
+
+    // Procesa 'input' entero en bloques de settings.blockSize y devuelve la salida.
+    // Si processSeconds no es nulo, suma ahí el tiempo pasado en processBlock
+    juce::AudioBuffer<float> render(const juce::AudioBuffer<float>& input, double* processSeconds = nullptr);
+
+private:
+    DAFAudioProcessor processor;
+    juce::MemoryBlock savedState;
+    const Settings settings;
+
+    JUCE_DECLARE_NON_COPYABLE(ProcessorHarness)
+};
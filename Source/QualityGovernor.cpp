@@ -0,0 +1,65 @@
+#include "QualityGovernor.h"
+
+const char* QualityGovernor::getTierName(Tier tier)
+{
+    switch (tier)
+    {
+        case fullQuality:           return "fullQuality";
+        case hierarchicalSeek:      return "hierarchicalSeek";
+        case shortAAFilter:         return "shortAAFilter";
+        case linearInterpolation:   return "linearInterpolation";
+        case numTiers:              break;
+    }
+
+    return "";
+}
+
+void QualityGovernor::prepare()
+{
+    setTier(fullQuality);
+    load.store(0.0, std::memory_order_relaxed);
+}
+
+QualityGovernor::Tier QualityGovernor::update(uint64_t elapsedNs, int numSamples, double sampleRate, bool offline)
+{
+    if (offline)
+    {
+        if (getTier() != fullQuality)
+            setTier(fullQuality);
+
+        return fullQuality;
+    }
+
+    if (numSamples <= 0 || sampleRate <= 0.0)
+        return getTier();
+
+    const double blockSeconds = numSamples / sampleRate;
+    const double blockLoad = elapsedNs * 1.0e-9 / blockSeconds;
+    const double alpha = blockSeconds / (smoothingSeconds + blockSeconds);
+    const double previousLoad = load.load(std::memory_order_relaxed);
+    const double smoothedLoad = previousLoad + alpha * (blockLoad - previousLoad);
+    load.store(smoothedLoad, std::memory_order_relaxed);
+
+    overSeconds = smoothedLoad > degradeLoad ? overSeconds + blockSeconds : 0.0;
+    underSeconds = smoothedLoad < restoreLoad ? underSeconds + blockSeconds : 0.0;
+
+    const int current = getTier();
+
+    // Bajar es urgente (se pierden bloques), subir puede esperar: si la carga
+    // vuelve a subir se bajaría otra vez enseguida
+    if (current < linearInterpolation && (blockLoad > overrunLoad || overSeconds >= degradeHoldSeconds))
+        setTier(current + 1);
+    else if (current > fullQuality && underSeconds >= restoreHoldSeconds)
+        setTier(current - 1);
+
+    return getTier();
+}
+
+void QualityGovernor::setTier(int newTier)
+{
+    tier.store(newTier, std::memory_order_relaxed);
+
+    // Tras un cambio se vuelve a esperar antes del siguiente
+    overSeconds = 0.0;
+    underSeconds = 0.0;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// Ajusta la calidad de SoundTouch a la carga del hilo de audio: compara lo que
+// tarda cada bloque con su plazo y baja o sube un nivel cada vez. Con
+// histéresis (umbrales separados y esperas distintas para bajar y subir) para
+// no oscilar. Renderizando offline siempre va a calidad máxima
+class QualityGovernor
+{
+public:
+    // No sigue la escalera búsqueda completa → rápida: para voz la búsqueda guiada
+    // por el periodo de pitch acierta como la completa con mucho menos trabajo, y la
+    // jerárquica gasta menos que la rápida acertando casi como la completa
+    enum Tier
+    {
+        fullQuality = 0,        // Búsqueda guiada por el pitch, filtro anti-alias de 64 coeficientes, interpolación cúbica
+        hierarchicalSeek,       // Búsqueda jerárquica sobre señal diezmada
+        shortAAFilter,          // Y filtro anti-alias de 32 coeficientes, con el retardo del de 64
+        linearInterpolation,    // Y interpolación lineal
+        numTiers
+    };
+
+    static const char* getTierName(Tier tier);
+
+    // Fuera del hilo de audio: vuelve a calidad máxima
+    void prepare();
+
+    // Desde el hilo de audio al final de cada bloque, con su duración en
+    // nanosegundos. Devuelve el nivel para los bloques siguientes
+    Tier update(uint64_t elapsedNs, int numSamples, double sampleRate, bool offline);
+
+    // Desde cualquier hilo
+    Tier getTier() const { return static_cast<Tier>(tier.load(std::memory_order_relaxed)); }
+    double getLoad() const { return load.load(std::memory_order_relaxed); }
+
+private:
+    // Carga = tiempo del bloque / duración del bloque, suavizada. El resto del
+    // plazo es para el sistema y el resto del callback
+    static constexpr double degradeLoad = 0.6;
+    static constexpr double restoreLoad = 0.3;
+    static constexpr double overrunLoad = 1.0;     // Un solo bloque así baja de nivel ya
+    static constexpr double smoothingSeconds = 0.2;
+    static constexpr double degradeHoldSeconds = 0.25;
+    static constexpr double restoreHoldSeconds = 3.0;
+
+    std::atomic<int> tier { fullQuality };
+    std::atomic<double> load { 0.0 };
+
+    // Tiempo seguido por encima de degradeLoad o por debajo de restoreLoad,
+    // solo en el hilo de audio
+    double overSeconds = 0.0;
+    double underSeconds = 0.0;
+
+    void setTier(int newTier);
+};
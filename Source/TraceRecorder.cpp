@@ -0,0 +1,143 @@
+#include "TraceRecorder.h"
+#include <cstdio>
+
+TraceRecorder& TraceRecorder::getInstance()
+{
+    static TraceRecorder instance;
+    return instance;
+}
+
+void TraceRecorder::start()
+{
+    stop();
+
+    if (!allocated)
+    {
+        for (auto& thread : threads)
+            thread.events.reset(new Event[eventsPerThread]);
+
+        allocated = true;
+    }
+
+    // Los buffers se vacían en su propio hilo al ver la nueva época
+    const auto now = std::chrono::steady_clock::now().time_since_epoch();
+    originNs.store(std::chrono::duration_cast<std::chrono::nanoseconds>(now).count(), std::memory_order_relaxed);
+    epoch.fetch_add(1, std::memory_order_release);
+    recording.store(true, std::memory_order_release);
+}
+
+TraceRecorder::ThreadBuffer* TraceRecorder::getThreadBuffer()
+{
+    // Cada hilo toma un buffer la primera vez que graba y lo conserva. Si ya no
+    // quedan, se lo apunta para no volver a intentarlo
+    constexpr int unassigned = -1;
+    constexpr int noSlot = -2;
+    thread_local int slot = unassigned;
+
+    if (slot == unassigned)
+    {
+        int index = numThreads.load(std::memory_order_relaxed);
+
+        while (index < maxThreads && !numThreads.compare_exchange_weak(index, index + 1, std::memory_order_relaxed))
+        {
+        }
+
+        slot = index < maxThreads ? index : noSlot;
+    }
+
+    return slot >= 0 ? &threads[static_cast<size_t>(slot)] : nullptr;
+}
+
+void TraceRecorder::setCurrentThreadName(const char* name)
+{
+    if (auto* thread = getThreadBuffer())
+        thread->threadName.store(name, std::memory_order_relaxed);
+}
+
+void TraceRecorder::addEvent(const char* name, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end)
+{
+    if (!recording.load(std::memory_order_acquire))
+        return;
+
+    auto* thread = getThreadBuffer();
+    if (thread == nullptr)
+        return;
+
+    // Primer evento de una grabación nueva: el hilo vacía su propio buffer
+    const uint32_t currentEpoch = epoch.load(std::memory_order_acquire);
+    uint64_t index = thread->writeIndex.load(std::memory_order_relaxed);
+
+    if (thread->epoch != currentEpoch)
+    {
+        thread->epoch = currentEpoch;
+        index = 0;
+    }
+
+    auto& event = thread->events[index % eventsPerThread];
+    const int64_t startNs = std::chrono::duration_cast<std::chrono::nanoseconds>(start.time_since_epoch()).count();
+
+    event.name = name;
+    event.startNs = startNs - originNs.load(std::memory_order_relaxed);
+    event.durationNs = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    event.epoch = currentEpoch;
+
+    thread->writeIndex.store(index + 1, std::memory_order_release);
+}
+
+std::string TraceRecorder::stopAndExportJson()
+{
+    stop();
+
+    std::string json = "{\"traceEvents\":[";
+    char line[256];
+    bool first = true;
+
+    auto append = [&json, &first] (const char* text)
+    {
+        if (!first)
+            json += ",\n";
+
+        json += text;
+        first = false;
+    };
+
+    if (allocated)
+    {
+        const int usedThreads = numThreads.load(std::memory_order_relaxed);
+        const uint32_t currentEpoch = epoch.load(std::memory_order_acquire);
+
+        for (int tid = 0; tid < usedThreads && tid < maxThreads; ++tid)
+        {
+            const auto& thread = threads[static_cast<size_t>(tid)];
+
+            if (const char* name = thread.threadName.load(std::memory_order_relaxed))
+            {
+                std::snprintf(line, sizeof(line),
+                              "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                              tid, name);
+                append(line);
+            }
+
+            // Si el buffer dio la vuelta, quedan los últimos eventos. Se descarta
+            // el más antiguo por si un evento en curso al parar lo estaba pisando.
+            // Un hilo que no ha grabado desde start() tiene aún los de la anterior
+            const uint64_t end = thread.writeIndex.load(std::memory_order_acquire);
+            const uint64_t begin = end > static_cast<uint64_t>(eventsPerThread) ? end - eventsPerThread + 1 : 0;
+
+            for (uint64_t i = begin; i < end; ++i)
+            {
+                const auto& event = thread.events[i % eventsPerThread];
+                if (event.epoch != currentEpoch)
+                    continue;
+
+                std::snprintf(line, sizeof(line),
+                              "{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                              event.name, tid, event.startNs / 1000.0, event.durationNs / 1000.0);
+                append(line);
+            }
+        }
+    }
+
+    json += "],\"displayTimeUnit\":\"ms\"}\n";
+    return json;
+}
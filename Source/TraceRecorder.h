@@ -0,0 +1,109 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// Registro de eventos de traza en formato Chrome (chrome://tracing, Perfetto)
+// para correlacionar el hilo de audio con la UI. Con DAF_TRACE=0 las macros se
+// compilan fuera; compiladas pero sin grabar cuestan una lectura atómica
+#ifndef DAF_TRACE
+ #define DAF_TRACE 1
+#endif
+
+class TraceRecorder
+{
+public:
+    static constexpr int maxThreads = 8;
+    static constexpr int eventsPerThread = 8192;
+
+    static TraceRecorder& getInstance();
+
+    // Desde un hilo que no sea de audio: reserva los buffers en la primera
+    // llamada y empieza a grabar desde cero
+    void start();
+    void stop() { recording.store(false, std::memory_order_relaxed); }
+    bool isRecording() const { return DAF_TRACE && recording.load(std::memory_order_relaxed); }
+
+    // Detiene la grabación y devuelve los eventos de todos los hilos como JSON
+    // de Chrome trace
+    std::string stopAndExportJson();
+
+    // Nombre del hilo que llama, para la traza. 'name' debe ser un literal
+    void setCurrentThreadName(const char* name);
+
+    // Evento completo (inicio y duración). 'name' debe ser un literal
+    void addEvent(const char* name, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end);
+
+    class ScopedEvent
+    {
+    public:
+       #if DAF_TRACE
+        explicit ScopedEvent(const char* eventName) noexcept
+            : name(getInstance().isRecording() ? eventName : nullptr)
+        {
+            if (name != nullptr)
+                start = std::chrono::steady_clock::now();
+        }
+
+        ~ScopedEvent()
+        {
+            if (name != nullptr)
+                getInstance().addEvent(name, start, std::chrono::steady_clock::now());
+        }
+
+    private:
+        const char* name;
+        std::chrono::steady_clock::time_point start;
+       #else
+        explicit ScopedEvent(const char*) noexcept {}
+       #endif
+
+        ScopedEvent(const ScopedEvent&) = delete;
+        ScopedEvent& operator=(const ScopedEvent&) = delete;
+    };
+
+private:
+    TraceRecorder() = default;
+
+    struct Event
+    {
+        const char* name;
+        int64_t startNs;
+        int64_t durationNs;
+        uint32_t epoch;     // Grabación a la que pertenece
+    };
+
+    // Un buffer circular por hilo: lo escribe solo su hilo, sin bloqueos. start()
+    // no lo vacía, porque el hilo puede estar escribiendo en ese momento: lo vacía
+    // el propio hilo en su primer evento de la nueva grabación (epoch distinta)
+    struct ThreadBuffer
+    {
+        std::unique_ptr<Event[]> events;
+        std::atomic<uint64_t> writeIndex { 0 };
+        std::atomic<const char*> threadName { nullptr };
+        uint32_t epoch = 0;     // Solo lo toca su hilo
+    };
+
+    ThreadBuffer* getThreadBuffer();
+
+    std::array<ThreadBuffer, maxThreads> threads;
+    std::atomic<int> numThreads { 0 };
+    std::atomic<bool> recording { false };
+    std::atomic<uint32_t> epoch { 0 };      // Se incrementa en cada start()
+    std::atomic<int64_t> originNs { 0 };    // Instante de start() en steady_clock
+    bool allocated = false;
+};
+
+#if DAF_TRACE
+ #define DAF_TRACE_CONCAT_(a, b) a##b
+ #define DAF_TRACE_CONCAT(a, b) DAF_TRACE_CONCAT_(a, b)
+ #define DAF_TRACE_SCOPE(name) TraceRecorder::ScopedEvent DAF_TRACE_CONCAT(traceEvent_, __LINE__)(name)
+ #define DAF_TRACE_THREAD_NAME(name) do { if (TraceRecorder::getInstance().isRecording()) TraceRecorder::getInstance().setCurrentThreadName(name); } while (false)
+#else
+ #define DAF_TRACE_SCOPE(name)
+ #define DAF_TRACE_THREAD_NAME(name)
+#endif
@@ -0,0 +1,330 @@
+#include <JuceHeader.h>
+#include "ProcessorHarness.h"
+#include <cmath>
+#include <cstdio>
+
+// Pruebas de regresión de DAFAudioProcessor: renderiza señales fijas con ajustes
+// representativos de delay y pitch y compara la salida con salidas de referencia
+// guardadas, con tolerancias explícitas, y la carga de CPU con un presupuesto.
+//
+//   daf_processor_tests --data=<dir> [--update-golden]
+//
+// <dir> contiene golden/ (salidas de referencia) y budget.txt. Con --update-golden
+// se reescriben las salidas de referencia en vez de compararlas. Si falta una salida
+// de referencia su comparación se omite; una de otro tamaño es un fallo
+namespace
+{
+    struct TestOptions
+    {
+        juce::File dataDir;
+        bool updateGolden = false;
+    };
+
+    TestOptions options;
+
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 256;
+    constexpr int renderSamples = 48000;
+
+    // Tolerancias frente a la salida de referencia: relación señal/ruido mínima y
+    // diferencia máxima de una muestra respecto al pico de la referencia
+    constexpr double minSnrDb = 60.0;
+    constexpr double maxErrorDb = -40.0;
+
+    using Fixture = ProcessorHarness::Fixture;
+
+    struct RenderConfig
+    {
+        const char* name;
+        Fixture fixture;
+        int channels;
+        float delayMs;
+        float pitch;
+    };
+
+    // Ajustes con salida de referencia: delay mayor y menor que la latencia de pitch,
+    // pitch arriba y abajo, sin pitch, y estéreo con canales distintos e iguales
+    const RenderConfig goldenConfigs[] =
+    {
+        { "speech_1ch_100ms_+3", Fixture::speech, 1, 100.0f,  3.0f },
+        { "speech_1ch_0ms_-3",   Fixture::speech, 1,   0.0f, -3.0f },
+        { "sine_1ch_100ms_+3",   Fixture::sine,   1, 100.0f,  3.0f },
+        { "speech_2ch_100ms_+3", Fixture::speech, 2, 100.0f,  3.0f },
+        { "sine_2ch_50ms_0",     Fixture::sine,   2,  50.0f,  0.0f }
+    };
+
+    struct RenderResult
+    {
+        juce::AudioBuffer<float> input;
+        juce::AudioBuffer<float> output;
+        double cpuPercent = 0.0;    // Tiempo de processBlock por segundo de audio
+    };
+
+    // Procesa 'input' (renderSamples muestras con config.channels canales), o la
+    // señal de config.fixture si no se pasa
+    RenderResult render(const RenderConfig& config, float inputGainDb = 0.0f, const juce::AudioBuffer<float>* input = nullptr)
+    {
+        RenderResult result;
+
+        if (input != nullptr)
+        {
+            result.input.makeCopyOf(*input);
+        }
+        else
+        {
+            result.input.setSize(config.channels, renderSamples);
+            ProcessorHarness::fillFixture(result.input, config.fixture, sampleRate);
+        }
+
+        ProcessorHarness::Settings settings;
+        settings.sampleRate = sampleRate;
+        settings.blockSize = blockSize;
+        settings.channels = config.channels;
+        settings.delayMs = config.delayMs;
+        settings.pitch = config.pitch;
+        settings.inputGainDb = inputGainDb;
+
+        ProcessorHarness harness(settings);
+        double seconds = 0.0;
+        result.output = harness.render(result.input, &seconds);
+        result.cpuPercent = 100.0 * seconds / (renderSamples / sampleRate);
+        return result;
+    }
+
+    struct Difference
+    {
+        double snrDb = 0.0;
+        double maxErrorDb = 0.0;
+    };
+
+    // Diferencia entre 'output' y 'reference' a partir de la muestra 'start'
+    Difference compare(const juce::AudioBuffer<float>& output, const juce::AudioBuffer<float>& reference, int start = 0)
+    {
+        double signal = 0.0, noise = 0.0, peak = 0.0, maxDiff = 0.0;
+
+        for (int ch = 0; ch < reference.getNumChannels(); ++ch)
+            for (int i = start; i < reference.getNumSamples(); ++i)
+            {
+                const double ref = reference.getSample(ch, i);
+                const double diff = output.getSample(ch, i) - ref;
+                signal += ref * ref;
+                noise += diff * diff;
+                peak = juce::jmax(peak, std::abs(ref));
+                maxDiff = juce::jmax(maxDiff, std::abs(diff));
+            }
+
+        Difference result;
+        result.snrDb = noise > 0.0 ? 10.0 * std::log10(signal / noise) : HUGE_VAL;
+        result.maxErrorDb = maxDiff > 0.0 ? 20.0 * std::log10(maxDiff / peak) : -HUGE_VAL;
+        return result;
+    }
+
+    // Salidas de referencia: float de 32 bits en el orden de la máquina, un canal
+    // tras otro
+    juce::File getGoldenFile(const RenderConfig& config)
+    {
+        return options.dataDir.getChildFile("golden").getChildFile(juce::String("processor_") + config.name + ".raw");
+    }
+
+    bool loadGolden(const juce::File& file, juce::AudioBuffer<float>& golden)
+    {
+        juce::MemoryBlock data;
+        const size_t expectedBytes = sizeof(float) * static_cast<size_t>(golden.getNumChannels() * golden.getNumSamples());
+
+        if (!file.loadFileAsData(data) || data.getSize() != expectedBytes)
+            return false;
+
+        const auto* samples = static_cast<const float*>(data.getData());
+        for (int ch = 0; ch < golden.getNumChannels(); ++ch)
+            golden.copyFrom(ch, 0, samples + ch * golden.getNumSamples(), golden.getNumSamples());
+
+        return true;
+    }
+
+    bool saveGolden(const juce::File& file, const juce::AudioBuffer<float>& output)
+    {
+        juce::MemoryBlock data;
+        for (int ch = 0; ch < output.getNumChannels(); ++ch)
+            data.append(output.getReadPointer(ch), sizeof(float) * static_cast<size_t>(output.getNumSamples()));
+
+        return file.getParentDirectory().createDirectory() && file.replaceWithData(data.getData(), data.getSize());
+    }
+
+    // Presupuesto de CPU: líneas "nombre variante porcentaje" con la carga máxima
+    // en porcentaje de un núcleo por segundo de audio; '#' empieza un comentario
+    double getBudget(const juce::String& name, const juce::String& variant)
+    {
+        juce::StringArray lines;
+        lines.addLines(options.dataDir.getChildFile("budget.txt").loadFileAsString());
+
+        for (const auto& line : lines)
+        {
+            const auto tokens = juce::StringArray::fromTokens(line, true);
+            if (!line.startsWith("#") && tokens.size() == 3 && tokens[0] == name && tokens[1] == variant)
+                return tokens[2].getDoubleValue();
+        }
+
+        return -1.0;
+    }
+}
+
+class ProcessorRenderTests : public juce::UnitTest
+{
+public:
+    ProcessorRenderTests() : juce::UnitTest("DAFAudioProcessor", "DSP") {}
+
+    void runTest() override
+    {
+        // Salida independiente de la máquina: sin la medida de float contra int16
+        DAFAudioProcessor::setPitchEngineFormat(soundtouch::SoundTouchEngine::FLOAT_SAMPLES);
+
+        beginTest("Delay sin pitch: la entrada sale retrasada sin cambios");
+        {
+            // Sin pitch la línea de delay solo copia muestras: tras el fade-in de
+            // arranque la salida es la entrada retrasada exactamente
+            const RenderConfig config { "delay", Fixture::speech, 1, 100.0f, 0.0f };
+            const auto result = render(config);
+            const int delaySamples = static_cast<int>(config.delayMs / 1000.0f * static_cast<float>(sampleRate));
+            const int fadeSamples = static_cast<int>(0.1f * static_cast<float>(sampleRate));
+
+            juce::AudioBuffer<float> expected(1, renderSamples);
+            expected.clear();
+            expected.copyFrom(0, delaySamples, result.input, 0, 0, renderSamples - delaySamples);
+
+            const auto difference = compare(result.output, expected, delaySamples + fadeSamples);
+            expect(difference.maxErrorDb <= -120.0, "Diferencia máxima " + juce::String(difference.maxErrorDb, 1) + " dB");
+        }
+
+        beginTest("Ganancia de entrada");
+        {
+            // Sin delay ni pitch la salida es la entrada por la ganancia, tras el fade-in
+            const RenderConfig config { "gain", Fixture::speech, 2, 0.0f, 0.0f };
+            const float gainDb = 6.0f;
+            const auto result = render(config, gainDb);
+            const int fadeSamples = static_cast<int>(0.1f * static_cast<float>(sampleRate));
+
+            juce::AudioBuffer<float> expected;
+            expected.makeCopyOf(result.input);
+            expected.applyGain(juce::Decibels::decibelsToGain(gainDb));
+
+            const auto difference = compare(result.output, expected, fadeSamples);
+            expect(difference.maxErrorDb <= -120.0, "Diferencia máxima " + juce::String(difference.maxErrorDb, 1) + " dB");
+        }
+
+        beginTest("Paso a estéreo con pitch: el canal derecho no se corta");
+        {
+            // Los dos canales iguales (se procesan como mono) y a mitad de render
+            // el derecho pasa a ser otra señal. Su salida no puede quedarse en
+            // silencio mientras se ceba el motor derecho
+            const RenderConfig config { "stereo", Fixture::sine, 2, 100.0f, 3.0f };
+            const int switchSample = renderSamples / 2;
+
+            juce::AudioBuffer<float> input(2, renderSamples);
+            ProcessorHarness::fillFixture(input, Fixture::sine, sampleRate);
+            for (int i = switchSample; i < renderSamples; ++i)
+                input.setSample(1, i, 0.5f * input.getSample(1, i));
+
+            const auto result = render(config, 0.0f, &input);
+
+            // Nivel mínimo en ventanas de 10 ms desde el cambio hasta el final
+            const int window = static_cast<int>(0.01 * sampleRate);
+            float minRms = 1.0f;
+            for (int start = switchSample; start + window <= renderSamples; start += window)
+                minRms = juce::jmin(minRms, result.output.getRMSLevel(1, start, window));
+
+            const float minRmsDb = juce::Decibels::gainToDecibels(minRms);
+            expect(minRmsDb > -20.0f, "Nivel mínimo del canal derecho " + juce::String(minRmsDb, 1) + " dB");
+        }
+
+        beginTest("Salidas de referencia");
+        for (const auto& config : goldenConfigs)
+        {
+            const auto result = render(config);
+            const auto file = getGoldenFile(config);
+
+            if (options.updateGolden)
+            {
+                expect(saveGolden(file, result.output), "No se pudo escribir " + file.getFullPathName());
+                logMessage("Actualizada " + file.getFileName());
+                continue;
+            }
+
+            if (!file.existsAsFile())
+            {
+                logMessage(juce::String(config.name) + ": sin salida de referencia, se omite (--update-golden)");
+                continue;
+            }
+
+            juce::AudioBuffer<float> golden(config.channels, renderSamples);
+            if (!loadGolden(file, golden))
+            {
+                expect(false, "No coincide en tamaño " + file.getFullPathName() + " (--update-golden)");
+                continue;
+            }
+
+            const auto difference = compare(result.output, golden);
+            logMessage(juce::String(config.name) + ": SNR " + juce::String(difference.snrDb, 1)
+                       + " dB, diferencia máxima " + juce::String(difference.maxErrorDb, 1) + " dB");
+            expect(difference.snrDb >= minSnrDb && difference.maxErrorDb <= maxErrorDb,
+                   juce::String(config.name) + " se aparta de la salida de referencia");
+        }
+
+        beginTest("Presupuesto de CPU");
+        {
+            const RenderConfig configs[] =
+            {
+                { "delay",      Fixture::speech, 1, 100.0f, 0.0f },
+                { "delayPitch", Fixture::speech, 1, 100.0f, 3.0f }
+            };
+
+            for (const auto& config : configs)
+            {
+                const double budget = getBudget("processor.processBlock", config.name);
+                expect(budget > 0.0, juce::String("Sin presupuesto para ") + config.name + " en budget.txt");
+
+                // La mejor de tres pasadas, para no fallar por una interrupción del sistema
+                double cpuPercent = HUGE_VAL;
+                for (int run = 0; run < 3; ++run)
+                    cpuPercent = juce::jmin(cpuPercent, render(config).cpuPercent);
+
+                logMessage(juce::String(config.name) + ": " + juce::String(cpuPercent, 2) + " % de CPU, presupuesto "
+                           + juce::String(budget, 2) + " %");
+                expect(cpuPercent <= budget, juce::String(config.name) + " supera el presupuesto de CPU");
+            }
+        }
+    }
+};
+
+int main(int argc, char* argv[])
+{
+    // Hilo de mensajes para los parámetros y el AsyncUpdater del procesador
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    options.dataDir = juce::File::getCurrentWorkingDirectory();
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const juce::String arg(argv[i]);
+
+        if (arg.startsWith("--data="))
+            options.dataDir = juce::File::getCurrentWorkingDirectory().getChildFile(arg.fromFirstOccurrenceOf("=", false, false));
+        else if (arg == "--update-golden")
+            options.updateGolden = true;
+        else
+        {
+            std::fprintf(stderr, "Uso: daf_processor_tests [--data=dir] [--update-golden]\n");
+            return 2;
+        }
+    }
+
+    ProcessorRenderTests tests;
+    juce::UnitTestRunner runner;
+    runner.setAssertOnFailure(false);
+    runner.runTests({ &tests });
+
+    int failures = 0;
+    for (int i = 0; i < runner.getNumResults(); ++i)
+        failures += runner.getResult(i)->failures;
+
+    return failures > 0 ? 1 : 0;
+}